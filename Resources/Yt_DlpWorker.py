@@ -0,0 +1,53 @@
+# A long-lived yt-dlp worker for Orchestra, it needs the yt-dlp python package(pip install yt-dlp).
+# Reads one JSON request per line from stdin: {"command": "flatJSON" | "JSON" | "rawURL", "input": "..."}
+# and writes one response per line to stdout: "ok <result>" or "error <message>".
+# "ready" is written once, when yt-dlp is imported.
+import json
+import sys
+
+# anything printed by yt-dlp itself must not break the protocol
+responses = sys.stdout
+sys.stdout = sys.stderr
+
+import yt_dlp
+
+COMMON_OPTIONS = {"quiet": True, "no_warnings": True, "skip_download": True, "noprogress": True}
+
+# the same as the command line options used by Yt_DlpManager
+downloaders = {
+    "flatJSON": yt_dlp.YoutubeDL({**COMMON_OPTIONS, "extract_flat": "in_playlist"}),
+    "JSON": yt_dlp.YoutubeDL(COMMON_OPTIONS),
+    "rawURL": yt_dlp.YoutubeDL({**COMMON_OPTIONS, "format": "bestaudio"}),
+}
+
+
+def respond(line):
+    responses.write(line.replace("\n", " ") + "\n")
+    responses.flush()
+
+
+def handle(command, input):
+    downloader = downloaders[command]
+    info = downloader.extract_info(input, download=False)
+
+    if command == "rawURL":
+        # a search returns a playlist
+        if "entries" in info:
+            info = next(iter(info["entries"]))
+        return info["url"]
+
+    # ensure_ascii keeps the response on one line in any console encoding
+    return json.dumps(downloader.sanitize_info(info))
+
+
+respond("ready")
+
+for request in sys.stdin:
+    if not request.strip():
+        continue
+
+    try:
+        request = json.loads(request)
+        respond("ok " + handle(request["command"], request["input"]))
+    except Exception as e:
+        respond("error " + str(e))
@@ -0,0 +1,64 @@
+# A stand-in for Resources/Yt_DlpWorker.py, which speaks the same protocol without yt-dlp and network, for Yt_DlpWorkerPoolDriver.
+# Reads one JSON request per line from stdin: {"command": "flatJSON" | "JSON" | "rawURL", "input": "..."}
+# and writes one response per line to stdout: "ok <result>" or "error <message>".
+# "ready" is written once, at the start. The input says what to do:
+#   "sleep <seconds> <text>" - answers with the text after the seconds, like a long extraction
+#   "pid"                    - answers with the id of the process, so a relaunch can be seen
+#   "order <text>"           - answers with how many requests the process has got before this one and the text
+#   "exit"                   - exits without answering, like a crashed worker
+#   "die <seconds>"          - answers with the id of the process and exits after the seconds, like a worker which crashed while idle
+#   "fail <message>"         - answers with an error
+#   anything else            - answers with the input
+import json
+import os
+import sys
+import threading
+import time
+
+COMMANDS = ("flatJSON", "JSON", "rawURL")
+
+handled_count = 0
+
+
+def respond(line):
+    sys.stdout.write(line.replace("\n", " ") + "\n")
+    sys.stdout.flush()
+
+
+def handle(command, input):
+    if command not in COMMANDS:
+        raise KeyError(command)
+
+    words = input.split(" ", 2)
+
+    if words[0] == "sleep":
+        time.sleep(float(words[1]))
+        return words[2] if len(words) > 2 else ""
+    if words[0] == "pid":
+        return str(os.getpid())
+    if words[0] == "order":
+        return str(handled_count) + " " + input[len("order "):]
+    if words[0] == "exit":
+        sys.exit(0)
+    if words[0] == "die":
+        threading.Timer(float(words[1]), os._exit, (0,)).start()
+        return str(os.getpid())
+    if words[0] == "fail":
+        raise RuntimeError(input[len("fail "):])
+
+    return input
+
+
+respond("ready")
+
+for request in sys.stdin:
+    if not request.strip():
+        continue
+
+    try:
+        request = json.loads(request)
+        respond("ok " + handle(request["command"], request["input"]))
+    except Exception as e:
+        respond("error " + str(e))
+
+    handled_count += 1
@@ -0,0 +1,111 @@
+#include "HeadlessVoiceSink.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <utility>
+
+#include "../FFmpeg/OpusPacket.hpp"
+
+namespace Orchestra
+{
+    HeadlessVoiceSink::HeadlessVoiceSink(uint64_t guildID, OnVoiceBufferSent onVoiceBufferSent)
+        : m_GuildID(guildID), m_OnVoiceBufferSent(std::move(onVoiceBufferSent)), m_PlayedUntil(std::chrono::steady_clock::now()), m_LastSentSeconds(0.f), m_Stats{}, m_JitterSecondsSum(0.f),
+        m_Thread([this](std::stop_token stopToken) { Tick(std::move(stopToken)); }) {}
+    HeadlessVoiceSink::~HeadlessVoiceSink()
+    {
+        m_Thread.request_stop();
+
+        if(m_Thread.joinable())
+            m_Thread.join();
+    }
+
+    void HeadlessVoiceSink::SendAudioRaw(uint16_t*, size_t size)
+    {
+        Queue(static_cast<float>(size) / static_cast<float>(CHANNELS_COUNT * sizeof(int16_t) * SAMPLE_RATE));
+    }
+    void HeadlessVoiceSink::SendAudioOpus(uint8_t* packet, size_t size)
+    {
+        Queue(GetOpusPacketSeconds({ packet, size }));
+    }
+    void HeadlessVoiceSink::StopAudio()
+    {
+        std::lock_guard lock{ m_Mutex };
+
+        m_PlayedUntil = std::chrono::steady_clock::now();
+        m_LastSendTime.reset();
+    }
+
+    void HeadlessVoiceSink::Queue(float seconds)
+    {
+        using namespace std::chrono;
+
+        const auto now = steady_clock::now();
+
+        std::lock_guard lock{ m_Mutex };
+
+        if(m_LastSendTime)
+        {
+            if(now > m_PlayedUntil)
+            {
+                m_Stats.underrunsCount++;
+                m_Stats.underrunSeconds += duration<float>(now - m_PlayedUntil).count();
+            }
+
+            const float jitterSeconds = std::abs(duration<float>(now - *m_LastSendTime).count() - m_LastSentSeconds);
+
+            m_JitterSecondsSum += jitterSeconds;
+            m_Stats.maxJitterMilliseconds = std::max(m_Stats.maxJitterMilliseconds, jitterSeconds * 1000.f);
+        }
+
+        m_PlayedUntil = std::max(m_PlayedUntil, now) + duration_cast<steady_clock::duration>(duration<float>(seconds));
+        m_LastSendTime = now;
+        m_LastSentSeconds = seconds;
+
+        m_Stats.sendsCount++;
+        m_Stats.sentSeconds += seconds;
+    }
+    void HeadlessVoiceSink::Tick(std::stop_token stopToken)
+    {
+        auto nextTick = std::chrono::steady_clock::now();
+
+        while(!stopToken.stop_requested())
+        {
+            nextTick += TICK;
+            std::this_thread::sleep_until(nextTick);
+
+            const float remainingSeconds = GetSecondsRemaining();
+
+            if(remainingSeconds > 0.f && m_OnVoiceBufferSent)
+                m_OnVoiceBufferSent(remainingSeconds);
+        }
+    }
+}
+//getters, setters
+namespace Orchestra
+{
+    float HeadlessVoiceSink::GetSecondsRemaining()
+    {
+        std::lock_guard lock{ m_Mutex };
+
+        return std::max(0.f, std::chrono::duration<float>(m_PlayedUntil - std::chrono::steady_clock::now()).count());
+    }
+    uint64_t HeadlessVoiceSink::GetGuildID() const
+    {
+        return m_GuildID;
+    }
+
+    HeadlessVoiceSink::Stats HeadlessVoiceSink::GetStats() const
+    {
+        std::lock_guard lock{ m_Mutex };
+
+        Stats stats = m_Stats;
+
+        //the first send has nothing to be compared with
+        if(stats.sendsCount > 1)
+            stats.jitterMilliseconds = m_JitterSecondsSum / static_cast<float>(stats.sendsCount - 1) * 1000.f;
+
+        return stats;
+    }
+}
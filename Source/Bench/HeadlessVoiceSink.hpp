@@ -0,0 +1,74 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <thread>
+
+#include "../DiscordBot/VoiceSink.hpp"
+
+namespace Orchestra
+{
+    //plays the sent audio into nowhere at the real-time rate, so players can be run without discord. Measures how evenly the audio comes and when it runs out
+    class HeadlessVoiceSink : public VoiceSink
+    {
+    public:
+        //is called every TICK while there is audio to play, like the voice buffer events of discord's voice client
+        using OnVoiceBufferSent = std::function<void(float remainingSeconds)>;
+
+        struct Stats
+        {
+            uint64_t sendsCount;
+            float sentSeconds;
+            //how many times the sent audio has run out before the next one came, the first send and the ones after StopAudio aren't counted
+            uint64_t underrunsCount;
+            float underrunSeconds;
+            //the mean difference between the intervals of the sends and the lengths of the audio sent, like the interarrival jitter of RTP
+            float jitterMilliseconds;
+            float maxJitterMilliseconds;
+        };
+
+    public:
+        //discord's voice client sends a 20ms opus frame every TICK
+        static constexpr std::chrono::milliseconds TICK{ 20 };
+        static constexpr int SAMPLE_RATE = 48000;
+        static constexpr int CHANNELS_COUNT = 2;
+
+    public:
+        HeadlessVoiceSink(uint64_t guildID, OnVoiceBufferSent onVoiceBufferSent = {});
+        ~HeadlessVoiceSink() override;
+
+        void SendAudioRaw(uint16_t* audio, size_t size) override;
+        void SendAudioOpus(uint8_t* packet, size_t size) override;
+        void StopAudio() override;
+
+    public:
+        float GetSecondsRemaining() override;
+        uint64_t GetGuildID() const override;
+
+        Stats GetStats() const;
+
+    private:
+        void Queue(float seconds);
+        void Tick(std::stop_token stopToken);
+
+    private:
+        uint64_t m_GuildID;
+        OnVoiceBufferSent m_OnVoiceBufferSent;
+
+        mutable std::mutex m_Mutex;
+        //when the audio, which has been sent so far, is played out
+        std::chrono::steady_clock::time_point m_PlayedUntil;
+        //the time and the length of the last send, nullopt before the first one and after StopAudio
+        std::optional<std::chrono::steady_clock::time_point> m_LastSendTime;
+        float m_LastSentSeconds;
+        Stats m_Stats;
+        float m_JitterSecondsSum;
+
+        //is the last one, so it is joined before the rest is destroyed
+        std::jthread m_Thread;
+    };
+}
@@ -0,0 +1,351 @@
+#include <array>
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <string_view>
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <vector>
+#include <cstdint>
+#include <numbers>
+
+#include <GuelderConsoleLog.hpp>
+
+#include "../Utils.hpp"
+#include "../FFmpeg/AudioFilterGraph.hpp"
+#include "../FFmpeg/Decoder.hpp"
+#include "../DSP/BiquadEqualizer.hpp"
+#include "../Diagnostics/AllocationsCounter.hpp"
+#include "ProcessStats.hpp"
+
+using namespace GuelderConsoleLog;
+using namespace Orchestra;
+
+namespace
+{
+    constexpr int SAMPLE_RATE = 48000;
+    constexpr int CHANNELS_COUNT = 2;
+    constexpr float BENCHED_SECONDS = 60.f;
+    //the same amount of audio which the player filters at once
+    constexpr size_t CHUNK_SAMPLES = 2880;
+
+    constexpr std::array SPEEDS{ .5f, .75f, 1.f, 1.25f, 1.5f, 2.f, 3.f };
+    constexpr std::array EQUALIZER_BANDS_COUNTS{ 1, 2, 4, 8, 16, 32 };
+    constexpr int SEEKS_COUNT = 20;
+
+    //what the player's filters are set to while a local file is decoded
+    struct DecodingSettings
+    {
+        std::string_view name;
+        float speed;
+        bool preservePitch;
+        bool hasBassBoost;
+        int equalizerBandsCount;
+        bool useNativeEqualizer;
+    };
+
+    constexpr std::array DECODING_SETTINGS
+    {
+        DecodingSettings{ "no filters", 1.f, false, false, 0, false },
+        DecodingSettings{ "bass boost", 1.f, false, true, 0, false },
+        DecodingSettings{ "bass boost, 8 bands firequalizer", 1.f, false, true, 8, false },
+        DecodingSettings{ "bass boost, 8 bands biquads", 1.f, false, true, 8, true },
+        DecodingSettings{ "speed 1.5", 1.5f, false, false, 0, false },
+        DecodingSettings{ "speed 1.5, preserved pitch", 1.5f, true, false, 0, false }
+    };
+    constexpr std::array OUT_SAMPLE_RATES{ Decoder::DEFAULT_SAMPLE_RATE, 44100, 24000 };
+    //a long file is decoded only till this, so every run takes about the same time
+    constexpr float MAX_DECODED_SECONDS = 600.f;
+
+    //a chord with some noise, so the filters have something to work with
+    std::vector<uint8_t> GenerateAudio(float seconds)
+    {
+        const size_t samplesCount = static_cast<size_t>(seconds * SAMPLE_RATE);
+
+        std::vector<uint8_t> audio(samplesCount * CHANNELS_COUNT * sizeof(int16_t));
+        int16_t* samples = reinterpret_cast<int16_t*>(audio.data());
+
+        uint32_t noise = 1;
+
+        for(size_t i = 0; i < samplesCount; i++)
+        {
+            const float time = static_cast<float>(i) / SAMPLE_RATE;
+
+            noise = noise * 1664525u + 1013904223u;
+
+            const float value =
+                .3f * std::sin(2.f * std::numbers::pi_v<float> * 110.f * time) +
+                .2f * std::sin(2.f * std::numbers::pi_v<float> * 440.f * time) +
+                .1f * std::sin(2.f * std::numbers::pi_v<float> * 1760.f * time) +
+                .05f * (static_cast<float>(noise >> 16) / 32768.f - 1.f);
+
+            for(int channel = 0; channel < CHANNELS_COUNT; channel++)
+                samples[i * CHANNELS_COUNT + channel] = static_cast<int16_t>(value * 32767.f);
+        }
+
+        return audio;
+    }
+
+    void BenchSpeed(const std::vector<uint8_t>& audio, float speed, bool preservePitch)
+    {
+        AudioFilterGraph filterGraph{ SAMPLE_RATE, CHANNELS_COUNT, speed, preservePitch };
+        //the player's filters are never neutral in a benchmark, as some bass is almost always there
+        filterGraph.SetBassBoost(5.f, 110.f, .3f);
+
+        constexpr size_t chunkSize = CHUNK_SAMPLES * CHANNELS_COUNT * sizeof(int16_t);
+
+        std::vector<uint8_t> filtered;
+        filtered.reserve(chunkSize * 8);
+
+        size_t filteredSize = 0;
+
+        const std::clock_t begin = std::clock();
+
+        for(size_t offset = 0; offset < audio.size(); offset += chunkSize)
+        {
+            filterGraph.Process({ audio.data() + offset, std::min(chunkSize, audio.size() - offset) }, filtered);
+
+            filteredSize += filtered.size();
+            filtered.clear();
+        }
+
+        const std::clock_t end = std::clock();
+
+        const float cpuSeconds = static_cast<float>(end - begin) / CLOCKS_PER_SEC;
+        const float inSeconds = static_cast<float>(audio.size()) / (CHANNELS_COUNT * sizeof(int16_t) * SAMPLE_RATE);
+        const float outSeconds = static_cast<float>(filteredSize) / (AudioFilterGraph::OUT_CHANNELS_COUNT * sizeof(int16_t) * SAMPLE_RATE);
+
+        GE_LOG(Orchestra, Info, preservePitch ? "atempo" : "resample", ", speed ", speed, ": ", cpuSeconds * 1000.f / inSeconds, "ms of cpu per second of audio, ",
+            cpuSeconds / outSeconds * 100.f, "% of a core per stream, ", outSeconds, "s of output.");
+    }
+
+    //log spaced from 30Hz to 16kHz with alternating gains
+    std::map<float, float> GenerateEqualizerBands(int bandsCount)
+    {
+        std::map<float, float> bands;
+
+        for(int i = 0; i < bandsCount; i++)
+        {
+            const float position = bandsCount > 1 ? static_cast<float>(i) / (bandsCount - 1) : .5f;
+
+            bands.emplace(30.f * std::pow(16000.f / 30.f, position), i % 2 ? -3.f : 3.f);
+        }
+
+        return bands;
+    }
+
+    void LogEqualizerResult(const std::string_view& name, int bandsCount, std::clock_t begin, std::clock_t end, size_t samplesCount)
+    {
+        const float cpuSeconds = static_cast<float>(end - begin) / CLOCKS_PER_SEC;
+
+        GE_LOG(Orchestra, Info, name, ", ", bandsCount, " bands: ", cpuSeconds * 1e9f / samplesCount, "ns per sample of ", CHANNELS_COUNT, " channels.");
+    }
+
+    void BenchNativeEqualizer(const std::vector<uint8_t>& audio, int bandsCount)
+    {
+        BiquadEqualizer equalizer{ SAMPLE_RATE, CHANNELS_COUNT };
+        equalizer.SetEqualizer(GenerateEqualizerBands(bandsCount));
+
+        //is processed in place
+        std::vector<uint8_t> samples = audio;
+
+        constexpr size_t chunkSamplesCount = CHUNK_SAMPLES * CHANNELS_COUNT;
+        const size_t samplesCount = samples.size() / sizeof(int16_t);
+        int16_t* data = reinterpret_cast<int16_t*>(samples.data());
+
+        const std::clock_t begin = std::clock();
+
+        for(size_t offset = 0; offset < samplesCount; offset += chunkSamplesCount)
+            equalizer.Process({ data + offset, std::min(chunkSamplesCount, samplesCount - offset) });
+
+        const std::clock_t end = std::clock();
+
+        LogEqualizerResult("biquads", bandsCount, begin, end, samplesCount / CHANNELS_COUNT);
+    }
+    void BenchFirequalizer(const std::vector<uint8_t>& audio, int bandsCount)
+    {
+        AudioFilterGraph filterGraph{ SAMPLE_RATE, CHANNELS_COUNT };
+        filterGraph.SetEqualizer(GenerateEqualizerBands(bandsCount));
+
+        constexpr size_t chunkSize = CHUNK_SAMPLES * CHANNELS_COUNT * sizeof(int16_t);
+
+        std::vector<uint8_t> filtered;
+        filtered.reserve(chunkSize * 8);
+
+        const std::clock_t begin = std::clock();
+
+        for(size_t offset = 0; offset < audio.size(); offset += chunkSize)
+        {
+            filterGraph.Process({ audio.data() + offset, std::min(chunkSize, audio.size() - offset) }, filtered);
+            filtered.clear();
+        }
+
+        const std::clock_t end = std::clock();
+
+        //includes the rest of the graph, which does almost nothing with speed 1
+        LogEqualizerResult("firequalizer", bandsCount, begin, end, audio.size() / (CHANNELS_COUNT * sizeof(int16_t)));
+    }
+
+    //decodes and filters the file the same way the player does, only without sending and waiting
+    void BenchDecoding(const std::string_view& path, int outSampleRate, const DecodingSettings& settings)
+    {
+        using namespace std::chrono;
+
+        Decoder decoder{ path, outSampleRate };
+
+        AudioFilterGraph filterGraph{ decoder.GetOutSampleRate(), decoder.GetChannelsCount(), settings.speed, settings.preservePitch, settings.useNativeEqualizer };
+
+        if(settings.hasBassBoost)
+            filterGraph.SetBassBoost(5.f, 110.f, .3f);
+        if(settings.equalizerBandsCount)
+            filterGraph.SetEqualizer(GenerateEqualizerBands(settings.equalizerBandsCount));
+
+        const float bytesPerSecond = static_cast<float>(decoder.GetChannelsCount() * decoder.GetBytesPerSample() * decoder.GetOutSampleRate());
+
+        std::vector<uint8_t> frame(decoder.GetMaxOutBufferSize());
+        std::vector<uint8_t> filtered;
+        filtered.reserve(frame.size() * 8);
+
+        size_t framesCount = 0;
+        float decodedSeconds = 0.f;
+        nanoseconds decoding{ 0 };
+        nanoseconds filtering{ 0 };
+
+        const uint64_t allocationsBefore = AllocationsCounter::GetTotalAllocations();
+        const std::clock_t begin = std::clock();
+
+        while(decodedSeconds < MAX_DECODED_SECONDS && decoder.AreThereFramesToProcess())
+        {
+            const auto decodingBeginning = steady_clock::now();
+
+            const size_t decodedSize = decoder.DecodeAudioFrame(frame);
+
+            const auto filteringBeginning = steady_clock::now();
+
+            filterGraph.Process({ frame.data(), decodedSize }, filtered);
+            filtered.clear();
+
+            const auto filteringEnd = steady_clock::now();
+
+            decoding += filteringBeginning - decodingBeginning;
+            filtering += filteringEnd - filteringBeginning;
+
+            framesCount++;
+            decodedSeconds += static_cast<float>(decodedSize) / bytesPerSecond;
+        }
+
+        const std::clock_t end = std::clock();
+        const uint64_t allocations = AllocationsCounter::GetTotalAllocations() - allocationsBefore;
+
+        O_ASSERT(framesCount && decodedSeconds > 0.f, "Failed to decode any audio from ", path, '.');
+
+        const float cpuSeconds = static_cast<float>(end - begin) / CLOCKS_PER_SEC;
+
+        GE_LOG(Orchestra, Info, outSampleRate, "Hz, ", settings.name, ": real-time factor ", cpuSeconds / decodedSeconds,
+            ", ", static_cast<float>(decoding.count()) / framesCount, "ns per frame of decoding, ", static_cast<float>(filtering.count()) / framesCount, "ns per frame of filtering, ",
+            static_cast<float>(allocations) / framesCount, " allocations per frame(", allocations, " in total), peak rss ", ProcessStats::GetPeakResidentSetSize(), "MB, ",
+            framesCount, " frames of ", decodedSeconds, "s.");
+    }
+    void BenchDecoding(const std::string_view& path)
+    {
+        {
+            const Decoder decoder{ path };
+
+            GE_LOG(Orchestra, Info, "Decoding ", path, ": ", decoder.GetInitialSampleRate(), "Hz, ", decoder.GetChannelsCount(), " channels, ", decoder.GetTotalDurationSeconds(), "s, at most ", MAX_DECODED_SECONDS, "s of it is decoded.");
+        }
+
+        for(const int outSampleRate : OUT_SAMPLE_RATES)
+            for(const DecodingSettings& settings : DECODING_SETTINGS)
+                BenchDecoding(path, outSampleRate, settings);
+    }
+
+    //every seek is done by a just opened decoder, like the first skip of a track which is played again, and includes reading the first packet after it
+    float MeasureSeekMilliseconds(const std::string_view& path, const std::filesystem::path& seekIndexPath)
+    {
+        using namespace std::chrono;
+
+        nanoseconds total{ 0 };
+        uint32_t random = 1;
+
+        for(int i = 0; i < SEEKS_COUNT; i++)
+        {
+            Decoder decoder{ path };
+
+            if(!seekIndexPath.empty())
+                decoder.SetSeekIndexPath(seekIndexPath);
+
+            random = random * 1664525u + 1013904223u;
+            const float seconds = static_cast<float>(random >> 8) / static_cast<float>(1u << 24) * decoder.GetTotalDurationSeconds() * .95f;
+
+            const auto begin = steady_clock::now();
+
+            decoder.SkipToSeconds(seconds);
+            decoder.ReadAudioPacket();
+
+            total += steady_clock::now() - begin;
+        }
+
+        return duration<float, std::milli>(total).count() / SEEKS_COUNT;
+    }
+    void BenchSeeking(const std::string_view& path)
+    {
+        std::filesystem::path seekIndexPath{ path };
+        seekIndexPath += ".bench.index";
+
+        const float withoutIndexMilliseconds = MeasureSeekMilliseconds(path, {});
+
+        //what the first playback does
+        Decoder decoder{ path };
+        decoder.SetSeekIndexPath(seekIndexPath);
+
+        while(decoder.ReadAudioPacket());
+
+        if(!decoder.SaveSeekIndex())
+        {
+            GE_LOG(Orchestra, Info, "seeking in ", path, ": ", withoutIndexMilliseconds, "ms per seek, the file has a complete index of its own, so there is nothing to save.");
+            return;
+        }
+
+        const float withIndexMilliseconds = MeasureSeekMilliseconds(path, seekIndexPath);
+
+        std::error_code error;
+        std::filesystem::remove(seekIndexPath, error);
+
+        GE_LOG(Orchestra, Info, "seeking in ", path, ": ", withoutIndexMilliseconds, "ms per seek without a seek index, ", withIndexMilliseconds, "ms with it.");
+    }
+}
+
+//the arguments are optional paths to local audio files(e.g. mp3, m4a, webm, flac or ones from the audio cache) to measure decoding and seeking in
+int main(int argc, char** argv)
+{
+    try
+    {
+        const std::vector<uint8_t> audio = GenerateAudio(BENCHED_SECONDS);
+
+        GE_LOG(Orchestra, Info, "Filtering ", BENCHED_SECONDS, "s of ", SAMPLE_RATE, "Hz stereo audio in chunks of ", CHUNK_SAMPLES, " samples.");
+
+        for(const bool preservePitch : { false, true })
+            for(const float speed : SPEEDS)
+                BenchSpeed(audio, speed, preservePitch);
+
+        for(const int bandsCount : EQUALIZER_BANDS_COUNTS)
+        {
+            BenchNativeEqualizer(audio, bandsCount);
+            BenchFirequalizer(audio, bandsCount);
+        }
+
+        for(int i = 1; i < argc; i++)
+        {
+            BenchDecoding(argv[i]);
+            BenchSeeking(argv[i]);
+        }
+    }
+    catch(const OrchestraException& oe)
+    {
+        LogError("Caught an OrchestraException: ", oe.GetFullMessage());
+        return 1;
+    }
+
+    return 0;
+}
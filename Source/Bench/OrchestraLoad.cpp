@@ -0,0 +1,155 @@
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+#include <GuelderConsoleLog.hpp>
+
+#include "../Utils.hpp"
+#include "../DiscordBot/Player.hpp"
+#include "HeadlessVoiceSink.hpp"
+#include "ProcessStats.hpp"
+
+using namespace GuelderConsoleLog;
+using namespace Orchestra;
+
+namespace
+{
+    //the defaults of Main.cfg
+    constexpr uint32_t SENT_PACKETS_SIZE = 11520;
+    constexpr uint32_t DECODE_AHEAD_BUFFER_SIZE = 2000000;
+    //how often the stopping streams are stopped again, as a stream can be between its tracks
+    constexpr std::chrono::milliseconds STOP_INTERVAL{ 50 };
+
+    //a guild which plays its file over and over
+    struct Stream
+    {
+        Player player;
+        HeadlessVoiceSink voiceSink;
+        std::atomic_bool isRunning = true;
+        std::thread thread;
+
+        explicit Stream(uint64_t guildID)
+            : player(SENT_PACKETS_SIZE, DECODE_AHEAD_BUFFER_SIZE),
+            voiceSink(guildID, [this](float remainingSeconds) { player.OnVoiceBufferSent(remainingSeconds); })
+        {
+            //otherwise opus files would be sent as they are, which costs almost nothing
+            player.SetBassBoost(5.f, 110.f, .3f);
+        }
+    };
+
+    void Play(Stream& stream, const std::string& path, const std::atomic_bool& isStopped)
+    {
+        try
+        {
+            while(!isStopped)
+            {
+                //has been cancelled by Stop
+                if(!stream.player.SetDecoder(path))
+                    break;
+
+                stream.player.DecodeAndSendAudio(stream.voiceSink);
+
+                //the gap between the tracks isn't an underrun
+                stream.voiceSink.StopAudio();
+            }
+        }
+        catch(const OrchestraException& e)
+        {
+            GE_LOG(Orchestra, Warning, "Stream ", stream.voiceSink.GetGuildID(), " has failed: ", e.GetFullMessage());
+        }
+
+        stream.isRunning = false;
+    }
+}
+
+//the arguments are a count of streams, seconds to run them for and paths to local audio files, which are given to the streams in turn
+int main(int argc, char** argv)
+{
+    using namespace std::chrono;
+
+    try
+    {
+        O_ASSERT(argc > 3, "Usage: OrchestraLoad <streams count> <seconds> <audio files>...");
+
+        const size_t streamsCount = std::stoul(argv[1]);
+        const float seconds = std::stof(argv[2]);
+        const int filesCount = argc - 3;
+
+        O_ASSERT(streamsCount > 0 && seconds > 0.f, "The streams count and the seconds must be positive.");
+
+        GE_LOG(Orchestra, Info, "Playing ", filesCount, " files in ", streamsCount, " streams for ", seconds, "s.");
+
+        std::vector<std::unique_ptr<Stream>> streams;
+        streams.reserve(streamsCount);
+
+        std::atomic_bool isStopped = false;
+
+        const float cpuSecondsBefore = ProcessStats::GetCPUSeconds();
+        const auto begin = steady_clock::now();
+
+        for(size_t i = 0; i < streamsCount; i++)
+        {
+            Stream& stream = *streams.emplace_back(std::make_unique<Stream>(i + 1));
+            stream.thread = std::thread{ Play, std::ref(stream), std::string{ argv[3 + i % filesCount] }, std::cref(isStopped) };
+        }
+
+        std::this_thread::sleep_for(duration<float>(seconds));
+
+        isStopped = true;
+
+        while(std::ranges::any_of(streams, [](const std::unique_ptr<Stream>& stream) { return stream->isRunning.load(); }))
+        {
+            for(const auto& stream : streams)
+                stream->player.Stop();
+
+            std::this_thread::sleep_for(STOP_INTERVAL);
+        }
+
+        for(const auto& stream : streams)
+            stream->thread.join();
+
+        const float wallSeconds = duration<float>(steady_clock::now() - begin).count();
+        const float cpuSeconds = ProcessStats::GetCPUSeconds() - cpuSecondsBefore;
+
+        uint64_t totalUnderrunsCount = 0;
+        float totalUnderrunSeconds = 0.f;
+        float jitterMillisecondsSum = 0.f;
+        float maxJitterMilliseconds = 0.f;
+
+        for(const auto& stream : streams)
+        {
+            const HeadlessVoiceSink::Stats stats = stream->voiceSink.GetStats();
+
+            GE_LOG(Orchestra, Info, "stream ", stream->voiceSink.GetGuildID(), ": ", stats.sentSeconds, "s of audio in ", stats.sendsCount, " sends, ",
+                stats.underrunsCount, " underruns(", stats.underrunSeconds * 1000.f, "ms of silence), jitter ", stats.jitterMilliseconds, "ms, max ", stats.maxJitterMilliseconds, "ms.");
+
+            totalUnderrunsCount += stats.underrunsCount;
+            totalUnderrunSeconds += stats.underrunSeconds;
+            jitterMillisecondsSum += stats.jitterMilliseconds;
+            maxJitterMilliseconds = std::max(maxJitterMilliseconds, stats.maxJitterMilliseconds);
+        }
+
+        GE_LOG(Orchestra, Info, streamsCount, " streams: ", cpuSeconds / wallSeconds / static_cast<float>(streamsCount) * 100.f, "% of a core per stream, ",
+            cpuSeconds / wallSeconds * 100.f, "% of a core in total, ", totalUnderrunsCount, " underruns(", totalUnderrunSeconds * 1000.f, "ms of silence), mean jitter ",
+            jitterMillisecondsSum / static_cast<float>(streamsCount), "ms, max ", maxJitterMilliseconds, "ms, peak rss ", ProcessStats::GetPeakResidentSetSize(), "MB.");
+    }
+    catch(const OrchestraException& oe)
+    {
+        LogError("Caught an OrchestraException: ", oe.GetFullMessage());
+        return 1;
+    }
+    catch(const std::exception& e)
+    {
+        LogError(e.what());
+        return 1;
+    }
+
+    return 0;
+}
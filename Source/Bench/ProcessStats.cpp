@@ -0,0 +1,73 @@
+#include "ProcessStats.hpp"
+
+#include <cstdint>
+
+#ifdef WIN32
+#define NOMINMAX
+#include <Windows.h>
+#include <Psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+//private
+namespace Orchestra
+{
+    namespace
+    {
+#ifdef WIN32
+        //FILETIME is in 100ns units
+        float FileTimeToSeconds(const FILETIME& fileTime)
+        {
+            const uint64_t value = static_cast<uint64_t>(fileTime.dwHighDateTime) << 32 | fileTime.dwLowDateTime;
+
+            return static_cast<float>(static_cast<double>(value) / 1e7);
+        }
+#else
+        float TimeValueToSeconds(const timeval& timeValue)
+        {
+            return static_cast<float>(static_cast<double>(timeValue.tv_sec) + static_cast<double>(timeValue.tv_usec) / 1e6);
+        }
+#endif
+    }
+}
+namespace Orchestra
+{
+    float ProcessStats::GetCPUSeconds()
+    {
+#ifdef WIN32
+        FILETIME creationTime, exitTime, kernelTime, userTime;
+
+        if(!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime))
+            return 0.f;
+
+        return FileTimeToSeconds(kernelTime) + FileTimeToSeconds(userTime);
+#else
+        rusage usage{};
+
+        if(getrusage(RUSAGE_SELF, &usage) != 0)
+            return 0.f;
+
+        return TimeValueToSeconds(usage.ru_utime) + TimeValueToSeconds(usage.ru_stime);
+#endif
+    }
+    float ProcessStats::GetPeakResidentSetSize()
+    {
+#ifdef WIN32
+        PROCESS_MEMORY_COUNTERS counters{};
+
+        if(!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+            return 0.f;
+
+        return static_cast<float>(counters.PeakWorkingSetSize) / (1024.f * 1024.f);
+#else
+        rusage usage{};
+
+        if(getrusage(RUSAGE_SELF, &usage) != 0)
+            return 0.f;
+
+        //kilobytes on linux
+        return static_cast<float>(usage.ru_maxrss) / 1024.f;
+#endif
+    }
+}
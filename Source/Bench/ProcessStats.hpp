@@ -0,0 +1,22 @@
+#pragma once
+
+namespace Orchestra
+{
+    //the resources which the whole process has used so far
+    class ProcessStats
+    {
+    public:
+        ProcessStats() = delete;
+        ProcessStats(const ProcessStats&) = delete;
+        ProcessStats(ProcessStats&&) = delete;
+        ProcessStats& operator=(const ProcessStats&) = delete;
+        ProcessStats& operator=(ProcessStats&&) = delete;
+        ~ProcessStats() = delete;
+
+    public:
+        //user and kernel time of all threads, 0 if it can't be got
+        static float GetCPUSeconds();
+        //megabytes, 0 if it can't be got
+        static float GetPeakResidentSetSize();
+    };
+}
@@ -0,0 +1,254 @@
+#include <array>
+#include <chrono>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <algorithm>
+#include <vector>
+#include <cstdint>
+
+#include <GuelderConsoleLog.hpp>
+
+#include "../Utils.hpp"
+#include "../DiscordBot/Yt_DlpManager.hpp"
+#include "../DiscordBot/TracksQueue.hpp"
+
+using namespace GuelderConsoleLog;
+using namespace Orchestra;
+
+namespace
+{
+    constexpr std::array TRACKS_COUNTS{ 100, 1000, 5000, 20000 };
+    //every operation is repeated this many times at random positions of a full queue
+    constexpr size_t OPERATIONS_COUNT = 20000;
+
+    //how TracksQueue has stored its tracks before: every insertion, deletion and transfer shifts the tracks after it, a track is found by its unique index with find_if
+    class VectorQueue
+    {
+    public:
+        void Insert(size_t index, TrackInfo trackInfo)
+        {
+            m_Tracks.insert(m_Tracks.begin() + index, std::move(trackInfo));
+        }
+        void Delete(size_t index)
+        {
+            m_Tracks.erase(m_Tracks.begin() + index);
+        }
+        void Transfer(size_t from, size_t to)
+        {
+            Orchestra::Transfer(m_Tracks, from, to);
+        }
+
+        size_t GetUniqueIndex(size_t index) const
+        {
+            return m_Tracks[index].uniqueIndex;
+        }
+        std::optional<size_t> Find(size_t uniqueIndex) const
+        {
+            const auto found = std::ranges::find_if(m_Tracks, [uniqueIndex](const TrackInfo& info) { return info.uniqueIndex == uniqueIndex; });
+
+            if(found == m_Tracks.end())
+                return std::nullopt;
+
+            return found - m_Tracks.begin();
+        }
+        size_t GetSize() const
+        {
+            return m_Tracks.size();
+        }
+
+    private:
+        std::vector<TrackInfo> m_Tracks;
+    };
+    //TracksQueue itself, the unique indices of its tracks come from its own counter, so they are shifted to the ones of the bench
+    class RealQueue
+    {
+    public:
+        void Insert(size_t index, TrackInfo trackInfo)
+        {
+            m_TracksQueue.FetchRaw(std::move(trackInfo.URL), trackInfo.speed, trackInfo.repeat, index);
+
+            if(!m_FirstUniqueIndex)
+                m_FirstUniqueIndex = m_TracksQueue.GetTrackInfo(index).uniqueIndex - trackInfo.uniqueIndex;
+        }
+        void Delete(size_t index)
+        {
+            m_TracksQueue.DeleteTrack(index);
+        }
+        void Transfer(size_t from, size_t to)
+        {
+            m_TracksQueue.TransferTrack(from, to);
+        }
+
+        size_t GetUniqueIndex(size_t index) const
+        {
+            return m_TracksQueue.GetTrackInfo(index).uniqueIndex - m_FirstUniqueIndex.value_or(0);
+        }
+        std::optional<size_t> Find(size_t uniqueIndex) const
+        {
+            return m_TracksQueue.FindTrackIndex(m_FirstUniqueIndex.value_or(0) + uniqueIndex);
+        }
+        size_t GetSize() const
+        {
+            return m_TracksQueue.GetTracksSize();
+        }
+
+    private:
+        TracksQueue m_TracksQueue;
+        std::optional<size_t> m_FirstUniqueIndex;
+    };
+
+    //about as long as the ones from youtube, so the strings aren't in the small buffer
+    TrackInfo MakeTrackInfo(size_t uniqueIndex)
+    {
+        return
+        {
+            .URL = Logger::Format("https://www.youtube.com/watch?v=", uniqueIndex, "aBcDeFgHiJk"),
+            .title = Logger::Format("Some Artist - Some Rather Long Track Title #", uniqueIndex),
+            .duration = 180.f,
+            .uniqueIndex = uniqueIndex,
+            .repeat = 1,
+            .speed = 1.f
+        };
+    }
+
+    float GetNanosecondsPerOperation(std::chrono::steady_clock::time_point begin, size_t operationsCount)
+    {
+        return std::chrono::duration<float, std::nano>(std::chrono::steady_clock::now() - begin).count() / static_cast<float>(operationsCount);
+    }
+
+    //the same seed for both queues, so they do the same operations and get the same checksum
+    template<typename Queue>
+    void BenchQueue(const std::string_view& name, size_t tracksCount)
+    {
+        using namespace std::chrono;
+
+        std::mt19937 randomEngine{ static_cast<uint32_t>(tracksCount) };
+        Queue queue;
+
+        //made beforehand, so only the queue is measured
+        std::vector<TrackInfo> trackInfos;
+        trackInfos.reserve(tracksCount + OPERATIONS_COUNT);
+
+        for(size_t i = 0; i < tracksCount + OPERATIONS_COUNT; i++)
+            trackInfos.push_back(MakeTrackInfo(i));
+
+        size_t nextUniqueIndex = 0;
+
+        //filling at random positions, like inserting tracks with "insert"
+        auto begin = steady_clock::now();
+
+        for(size_t i = 0; i < tracksCount; i++)
+            queue.Insert(randomEngine() % (queue.GetSize() + 1), std::move(trackInfos[nextUniqueIndex++]));
+
+        const float insertNanoseconds = GetNanosecondsPerOperation(begin, tracksCount);
+
+        //the sum is checked, so the reads aren't thrown away
+        size_t checksum = 0;
+
+        begin = steady_clock::now();
+
+        for(size_t i = 0; i < OPERATIONS_COUNT; i++)
+            checksum += queue.GetUniqueIndex(randomEngine() % queue.GetSize());
+
+        const float getNanoseconds = GetNanosecondsPerOperation(begin, OPERATIONS_COUNT);
+
+        begin = steady_clock::now();
+
+        for(size_t i = 0; i < OPERATIONS_COUNT; i++)
+            checksum += queue.Find(randomEngine() % nextUniqueIndex).value_or(0);
+
+        const float findNanoseconds = GetNanosecondsPerOperation(begin, OPERATIONS_COUNT);
+
+        begin = steady_clock::now();
+
+        for(size_t i = 0; i < OPERATIONS_COUNT; i++)
+            queue.Transfer(randomEngine() % queue.GetSize(), randomEngine() % queue.GetSize());
+
+        const float transferNanoseconds = GetNanosecondsPerOperation(begin, OPERATIONS_COUNT);
+
+        //a deletion and an insertion, so the size stays the same
+        begin = steady_clock::now();
+
+        for(size_t i = 0; i < OPERATIONS_COUNT; i++)
+        {
+            queue.Delete(randomEngine() % queue.GetSize());
+            queue.Insert(randomEngine() % (queue.GetSize() + 1), std::move(trackInfos[nextUniqueIndex++]));
+        }
+
+        const float replaceNanoseconds = GetNanosecondsPerOperation(begin, OPERATIONS_COUNT);
+
+        //till it is empty, like "clear" does it track by track
+        begin = steady_clock::now();
+
+        while(queue.GetSize() > 0)
+            queue.Delete(randomEngine() % queue.GetSize());
+
+        const float deleteNanoseconds = GetNanosecondsPerOperation(begin, tracksCount);
+
+        GE_LOG(Orchestra, Info, name, ", ", tracksCount, " tracks: insert ", insertNanoseconds, "ns, get ", getNanoseconds, "ns, find by unique index ", findNanoseconds,
+            "ns, transfer ", transferNanoseconds, "ns, delete and insert ", replaceNanoseconds, "ns, delete ", deleteNanoseconds, "ns(checksum ", checksum, ").");
+    }
+
+    //a change publishes a new snapshot, GetSnapshot(like "queue" or "current" do) only loads it
+    void BenchSnapshot(size_t tracksCount)
+    {
+        using namespace std::chrono;
+
+        std::mt19937 randomEngine{ static_cast<uint32_t>(tracksCount) };
+        TracksQueue tracksQueue;
+
+        for(size_t i = 0; i < tracksCount; i++)
+            tracksQueue.FetchRaw(MakeTrackInfo(i).URL);
+
+        //made beforehand, so only the queue is measured
+        std::vector<std::string> rawURLs;
+        rawURLs.reserve(OPERATIONS_COUNT);
+
+        for(size_t i = 0; i < OPERATIONS_COUNT; i++)
+            rawURLs.push_back(MakeTrackInfo(tracksCount + i).URL);
+
+        auto begin = steady_clock::now();
+
+        for(size_t i = 0; i < OPERATIONS_COUNT; i++)
+            tracksQueue.SetTrackRawURL(randomEngine() % tracksCount, std::move(rawURLs[i]));
+
+        const float changeNanoseconds = GetNanosecondsPerOperation(begin, OPERATIONS_COUNT);
+
+        size_t checksum = 0;
+
+        begin = steady_clock::now();
+
+        for(size_t i = 0; i < OPERATIONS_COUNT; i++)
+            checksum += tracksQueue.GetSnapshot()->GetTracksSize();
+
+        const float snapshotNanoseconds = GetNanosecondsPerOperation(begin, OPERATIONS_COUNT);
+
+        GE_LOG(Orchestra, Info, "TracksQueue, ", tracksCount, " tracks: change and publishing of its snapshot ", changeNanoseconds, "ns, snapshot ", snapshotNanoseconds,
+            "ns(checksum ", checksum, ").");
+    }
+}
+
+//compares the old storage of TracksQueue(std::vector) with TracksQueue itself(ImplicitTreap with a hash map of the unique indices) on the operations the commands do, then measures its snapshots
+int main()
+{
+    try
+    {
+        for(const size_t tracksCount : TRACKS_COUNTS)
+        {
+            BenchQueue<VectorQueue>("vector", tracksCount);
+            BenchQueue<RealQueue>("TracksQueue", tracksCount);
+        }
+
+        for(const size_t tracksCount : TRACKS_COUNTS)
+            BenchSnapshot(tracksCount);
+    }
+    catch(const OrchestraException& oe)
+    {
+        LogError("Caught an OrchestraException: ", oe.GetFullMessage());
+        return 1;
+    }
+
+    return 0;
+}
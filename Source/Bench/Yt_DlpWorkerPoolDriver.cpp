@@ -0,0 +1,302 @@
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <GuelderConsoleLog.hpp>
+
+#include "../Utils.hpp"
+#include "../DiscordBot/Yt_DlpWorkerPool.hpp"
+
+using namespace GuelderConsoleLog;
+using namespace Orchestra;
+
+namespace
+{
+    //how long a request sleeps in the worker when it has to be busy, it is much longer than a check should take
+    constexpr float BUSY_SECONDS = 30.f;
+    //a cancelled request must throw well before BUSY_SECONDS
+    constexpr std::chrono::seconds MAX_CANCELLATION_DURATION{ 5 };
+    constexpr std::chrono::milliseconds POLL_INTERVAL{ 10 };
+
+    void WaitForQueuedRequestsCount(size_t count)
+    {
+        while(Yt_DlpWorkerPool::GetQueuedRequestsCount() != count)
+            std::this_thread::sleep_for(POLL_INTERVAL);
+    }
+
+    //one worker is busy, the requests which wait for it must be served in the order they came in.
+    //the worker tells the order in which it has got them, as the threads can return in any order
+    void CheckQueueingOrder()
+    {
+        constexpr size_t QUEUED_REQUESTS_COUNT = 4;
+
+        std::mutex mutex;
+        std::vector<std::string> responses;
+
+        auto request = [&mutex, &responses](std::string input)
+            {
+                std::string response;
+
+                try
+                {
+                    response = Yt_DlpWorkerPool::RequestRawURL(input);
+                }
+                catch(const OrchestraException& e)
+                {
+                    response = e.GetFullMessage();
+                }
+
+                std::lock_guard lock{ mutex };
+                responses.push_back(std::move(response));
+            };
+
+        std::vector<std::jthread> threads;
+
+        threads.emplace_back(request, "sleep 1 busy");
+
+        //till the busy one has taken the worker
+        std::this_thread::sleep_for(POLL_INTERVAL * 20);
+
+        for(size_t i = 0; i < QUEUED_REQUESTS_COUNT; i++)
+        {
+            threads.emplace_back(request, Logger::Format("order queued ", i));
+            WaitForQueuedRequestsCount(i + 1);
+        }
+
+        threads.clear();
+
+        O_ASSERT(responses.size() == QUEUED_REQUESTS_COUNT + 1, "Some of the requests have been lost.");
+
+        //"<how many requests the worker has got before> queued <i>"
+        std::erase(responses, "busy");
+        std::ranges::sort(responses, {}, [](const std::string& response) { return std::stoul(response); });
+
+        for(size_t i = 0; i < QUEUED_REQUESTS_COUNT; i++)
+            O_ASSERT(responses[i].ends_with(Logger::Format(" queued ", i)), "The queued requests are served out of order: ", responses[i], " instead of queued ", i, '.');
+
+        GE_LOG(Orchestra, Info, "Queueing order: ok.");
+    }
+    //background requests wait while there are interactive ones, even if they have come before them
+    void CheckPriority()
+    {
+        std::mutex mutex;
+        std::vector<std::string> responses;
+
+        auto request = [&mutex, &responses](std::string input, Yt_DlpWorkerPool::Priority priority)
+            {
+                std::string response;
+
+                try
+                {
+                    response = Yt_DlpWorkerPool::RequestRawURL(input, {}, priority);
+                }
+                catch(const OrchestraException& e)
+                {
+                    response = e.GetFullMessage();
+                }
+
+                std::lock_guard lock{ mutex };
+                responses.push_back(std::move(response));
+            };
+
+        std::vector<std::jthread> threads;
+
+        threads.emplace_back(request, "sleep 1 busy", Yt_DlpWorkerPool::Priority::Interactive);
+
+        //till the busy one has taken the worker
+        std::this_thread::sleep_for(POLL_INTERVAL * 20);
+
+        threads.emplace_back(request, "order background 0", Yt_DlpWorkerPool::Priority::Background);
+        WaitForQueuedRequestsCount(1);
+        threads.emplace_back(request, "order background 1", Yt_DlpWorkerPool::Priority::Background);
+        WaitForQueuedRequestsCount(2);
+        threads.emplace_back(request, "order interactive", Yt_DlpWorkerPool::Priority::Interactive);
+        WaitForQueuedRequestsCount(3);
+
+        threads.clear();
+
+        O_ASSERT(responses.size() == 4, "Some of the requests have been lost.");
+
+        std::erase(responses, "busy");
+        std::ranges::sort(responses, {}, [](const std::string& response) { return std::stoul(response); });
+
+        O_ASSERT(responses[0].ends_with(" interactive") && responses[1].ends_with(" background 0") && responses[2].ends_with(" background 1"),
+            "The requests are served in a wrong order: ", responses[0], ", ", responses[1], ", ", responses[2], '.');
+
+        GE_LOG(Orchestra, Info, "Priority: ok.");
+    }
+    //the cancelled worker must be killed, not waited for, and the next request must get a new one
+    void CheckCancellation()
+    {
+        using namespace std::chrono;
+
+        const std::string pidBefore = Yt_DlpWorkerPool::RequestRawURL("pid");
+
+        std::stop_source stopSource;
+        bool wasCancelled = false;
+        steady_clock::time_point end;
+
+        std::jthread thread{ [&]
+            {
+                try
+                {
+                    Yt_DlpWorkerPool::RequestRawURL(Logger::Format("sleep ", BUSY_SECONDS, " late"), stopSource.get_token());
+                }
+                catch(const OrchestraException&)
+                {
+                    wasCancelled = true;
+                }
+
+                end = steady_clock::now();
+            } };
+
+        std::this_thread::sleep_for(POLL_INTERVAL * 20);
+
+        const auto begin = steady_clock::now();
+
+        stopSource.request_stop();
+        thread.join();
+
+        O_ASSERT(wasCancelled, "The cancelled request has not thrown.");
+        O_ASSERT(end - begin < MAX_CANCELLATION_DURATION, "The cancelled request took ", duration<float>(end - begin).count(), "s, the worker hasn't been killed.");
+
+        const std::string pidAfter = Yt_DlpWorkerPool::RequestRawURL("pid");
+
+        O_ASSERT(pidAfter != pidBefore, "The cancelled worker ", pidBefore, " hasn't been relaunched.");
+
+        GE_LOG(Orchestra, Info, "Cancellation: ok, took ", duration<float>(end - begin).count(), "s, the worker ", pidBefore, " has been replaced by ", pidAfter, '.');
+    }
+    //a request which is cancelled while waiting for a free worker must throw at once and must not hold up the ones behind it
+    void CheckCancellationWhileWaiting()
+    {
+        using namespace std::chrono;
+
+        std::stop_source stopSource;
+        bool wasCancelled = false;
+        steady_clock::time_point end;
+        std::string nextResponse;
+
+        std::jthread busyThread{ [] { Yt_DlpWorkerPool::RequestRawURL("sleep 1 busy"); } };
+
+        //till the busy one has taken the worker
+        std::this_thread::sleep_for(POLL_INTERVAL * 20);
+
+        std::jthread cancelledThread{ [&]
+            {
+                try
+                {
+                    Yt_DlpWorkerPool::RequestRawURL("cancelled", stopSource.get_token());
+                }
+                catch(const OrchestraException&)
+                {
+                    wasCancelled = true;
+                }
+
+                end = steady_clock::now();
+            } };
+        WaitForQueuedRequestsCount(1);
+
+        std::jthread nextThread{ [&nextResponse] { nextResponse = Yt_DlpWorkerPool::RequestRawURL("next"); } };
+        WaitForQueuedRequestsCount(2);
+
+        const auto begin = steady_clock::now();
+
+        stopSource.request_stop();
+        cancelledThread.join();
+
+        O_ASSERT(wasCancelled, "The request cancelled while waiting has not thrown.");
+        O_ASSERT(end - begin < MAX_CANCELLATION_DURATION, "The request cancelled while waiting took ", duration<float>(end - begin).count(), "s.");
+
+        busyThread.join();
+        nextThread.join();
+
+        O_ASSERT(nextResponse == "next", "The request behind the cancelled one has got ", nextResponse, '.');
+        O_ASSERT(Yt_DlpWorkerPool::GetQueuedRequestsCount() == 0, "The cancelled request is still queued.");
+
+        GE_LOG(Orchestra, Info, "Cancellation while waiting: ok, took ", duration<float>(end - begin).count(), "s.");
+    }
+    //a worker which exits by itself is relaunched by the next request
+    void CheckRelaunch()
+    {
+        const std::string pidBefore = Yt_DlpWorkerPool::RequestRawURL("pid");
+
+        bool hasThrown = false;
+
+        try
+        {
+            Yt_DlpWorkerPool::RequestRawURL("exit");
+        }
+        catch(const OrchestraException&)
+        {
+            hasThrown = true;
+        }
+
+        O_ASSERT(hasThrown, "The request to the exited worker has not thrown.");
+
+        const std::string pidAfter = Yt_DlpWorkerPool::RequestRawURL("pid");
+
+        O_ASSERT(pidAfter != pidBefore, "The exited worker ", pidBefore, " hasn't been relaunched.");
+
+        hasThrown = false;
+
+        try
+        {
+            Yt_DlpWorkerPool::RequestRawURL("fail on purpose");
+        }
+        catch(const OrchestraException&)
+        {
+            hasThrown = true;
+        }
+
+        O_ASSERT(hasThrown, "An error response has not thrown.");
+        O_ASSERT(Yt_DlpWorkerPool::RequestRawURL("pid") == pidAfter, "The worker has been relaunched after an error response.");
+
+        GE_LOG(Orchestra, Info, "Relaunch: ok, the worker ", pidBefore, " has been replaced by ", pidAfter, '.');
+    }
+    //a worker which exits while idle must not fail the next request, it is retried by a relaunched worker
+    void CheckIdleWorkerDeath()
+    {
+        const std::string pidBefore = Yt_DlpWorkerPool::RequestRawURL("die 0.1");
+
+        std::this_thread::sleep_for(POLL_INTERVAL * 50);
+
+        const std::string pidAfter = Yt_DlpWorkerPool::RequestRawURL("pid");
+
+        O_ASSERT(pidAfter != pidBefore, "The worker ", pidBefore, " which has exited while idle hasn't been relaunched.");
+
+        GE_LOG(Orchestra, Info, "Idle worker death: ok, the worker ", pidBefore, " has been replaced by ", pidAfter, '.');
+    }
+}
+
+//checks Yt_DlpWorkerPool with FakeYt_DlpWorker.py, so neither yt-dlp nor network is needed
+int main(int argc, char** argv)
+{
+    try
+    {
+        O_ASSERT(argc == 2, "Usage: Yt_DlpWorkerPoolDriver \"<command which launches FakeYt_DlpWorker.py>\"");
+
+        //one worker, so the requests have to wait for each other
+        Yt_DlpWorkerPool::Launch(argv[1], 1);
+
+        O_ASSERT(Yt_DlpWorkerPool::IsRunning(), "The fake worker hasn't become ready.");
+
+        CheckQueueingOrder();
+        CheckPriority();
+        CheckCancellation();
+        CheckCancellationWhileWaiting();
+        CheckRelaunch();
+        CheckIdleWorkerDeath();
+    }
+    catch(const OrchestraException& oe)
+    {
+        LogError("Caught an OrchestraException: ", oe.GetFullMessage());
+        return 1;
+    }
+
+    return 0;
+}
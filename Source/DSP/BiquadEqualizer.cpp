@@ -0,0 +1,251 @@
+#define NOMINMAX
+#include "BiquadEqualizer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numbers>
+
+#include "../Utils.hpp"
+
+namespace Orchestra
+{
+    BiquadEqualizer::BiquadEqualizer(int sampleRate, int channelsCount)
+        : m_SampleRate(sampleRate), m_ChannelsCount(channelsCount), m_BassBoostDecibels(0.f), m_BassBoostFrequency(0.f), m_BassBoostBandwidth(0.f)
+    {
+        Reset(sampleRate, channelsCount);
+    }
+
+    void BiquadEqualizer::Process(std::span<int16_t> samples)
+    {
+        if(IsFlat() || samples.empty())
+            return;
+
+        const size_t channelsCount = static_cast<size_t>(m_ChannelsCount);
+        const size_t framesCount = samples.size() / channelsCount;
+        const size_t samplesCount = framesCount * channelsCount;
+
+        //grows only, so the steady state doesn't allocate
+        if(m_Buffer.size() < samplesCount)
+            m_Buffer.resize(samplesCount);
+
+        float* buffer = m_Buffer.data();
+
+        for(size_t i = 0; i < samplesCount; i++)
+            buffer[i] = static_cast<float>(samples[i]);
+
+        //every biquad runs over the whole block, so its coefficients and states stay in registers
+        for(size_t biquad = 0; biquad < m_B0.size(); biquad++)
+        {
+            switch(channelsCount)
+            {
+            case 1:
+                ProcessBiquad<1>(biquad, buffer, samplesCount);
+                break;
+            case 2:
+                ProcessBiquad<2>(biquad, buffer, samplesCount);
+                break;
+            default:
+                ProcessBiquad<0>(biquad, buffer, samplesCount);
+                break;
+            }
+        }
+
+        for(size_t i = 0; i < samplesCount; i++)
+            samples[i] = static_cast<int16_t>(std::clamp(std::nearbyint(buffer[i]), -32768.f, 32767.f));
+
+        //the states of a silent input decay into denormals, which are extremely slow
+        constexpr float denormalThreshold = 1e-15f;
+
+        for(float& z : m_Z1)
+            if(std::abs(z) < denormalThreshold)
+                z = 0.f;
+        for(float& z : m_Z2)
+            if(std::abs(z) < denormalThreshold)
+                z = 0.f;
+    }
+
+    template<size_t ChannelsCount>
+    void BiquadEqualizer::ProcessBiquad(size_t biquad, float* buffer, size_t samplesCount)
+    {
+        const float b0 = m_B0[biquad];
+        const float b1 = m_B1[biquad];
+        const float b2 = m_B2[biquad];
+        const float a1 = m_A1[biquad];
+        const float a2 = m_A2[biquad];
+
+        const size_t channelsCount = ChannelsCount ? ChannelsCount : static_cast<size_t>(m_ChannelsCount);
+
+        float* z1 = m_Z1.data() + biquad * channelsCount;
+        float* z2 = m_Z2.data() + biquad * channelsCount;
+
+        if constexpr(ChannelsCount)
+        {
+            //the states are copied to locals, otherwise the compiler has to assume that they alias the buffer and keeps reloading them
+            std::array<float, ChannelsCount> localZ1;
+            std::array<float, ChannelsCount> localZ2;
+
+            std::copy_n(z1, ChannelsCount, localZ1.begin());
+            std::copy_n(z2, ChannelsCount, localZ2.begin());
+
+            for(size_t frame = 0; frame < samplesCount; frame += ChannelsCount)
+            {
+                float* in = buffer + frame;
+
+                //the channels are independent of each other, so they are the lanes of one vector
+                for(size_t channel = 0; channel < ChannelsCount; channel++)
+                {
+                    const float x = in[channel];
+                    const float y = b0 * x + localZ1[channel];
+
+                    localZ1[channel] = b1 * x - a1 * y + localZ2[channel];
+                    localZ2[channel] = b2 * x - a2 * y;
+
+                    in[channel] = y;
+                }
+            }
+
+            std::copy_n(localZ1.begin(), ChannelsCount, z1);
+            std::copy_n(localZ2.begin(), ChannelsCount, z2);
+        }
+        else
+        {
+            for(size_t frame = 0; frame < samplesCount; frame += channelsCount)
+            {
+                float* in = buffer + frame;
+
+                for(size_t channel = 0; channel < channelsCount; channel++)
+                {
+                    const float x = in[channel];
+                    const float y = b0 * x + z1[channel];
+
+                    z1[channel] = b1 * x - a1 * y + z2[channel];
+                    z2[channel] = b2 * x - a2 * y;
+
+                    in[channel] = y;
+                }
+            }
+        }
+    }
+
+    void BiquadEqualizer::Reset(int sampleRate, int channelsCount)
+    {
+        O_ASSERT(sampleRate > 0 && channelsCount > 0, "Invalid format for the equalizer: ", sampleRate, "Hz, ", channelsCount, " channels");
+
+        m_SampleRate = sampleRate;
+        m_ChannelsCount = channelsCount;
+
+        UpdateCoefficients();
+        ClearState();
+    }
+    void BiquadEqualizer::ClearState() noexcept
+    {
+        std::ranges::fill(m_Z1, 0.f);
+        std::ranges::fill(m_Z2, 0.f);
+    }
+
+    void BiquadEqualizer::UpdateCoefficients()
+    {
+        m_B0.clear();
+        m_B1.clear();
+        m_B2.clear();
+        m_A1.clear();
+        m_A2.clear();
+
+        if(m_BassBoostDecibels != 0.f)
+            AddLowShelf(m_BassBoostDecibels,
+                m_BassBoostFrequency > 0.f ? m_BassBoostFrequency : DEFAULT_BASS_BOOST_FREQUENCY,
+                m_BassBoostBandwidth > 0.f ? m_BassBoostBandwidth : DEFAULT_BASS_BOOST_Q);
+
+        for(const auto& [frequency, decibelsBoost] : m_EqualizerFrequencies)
+            if(decibelsBoost != 0.f)
+                AddPeaking(decibelsBoost, frequency, EQUALIZER_BAND_Q);
+
+        //the states are kept when only the gains change, so a change isn't heard as a click
+        if(m_Z1.size() != m_B0.size() * m_ChannelsCount)
+        {
+            m_Z1.assign(m_B0.size() * m_ChannelsCount, 0.f);
+            m_Z2.assign(m_B0.size() * m_ChannelsCount, 0.f);
+        }
+    }
+
+    //the formulas are from the Audio EQ Cookbook by Robert Bristow-Johnson
+    void BiquadEqualizer::AddLowShelf(float decibelsBoost, float frequency, float q)
+    {
+        const double nyquist = m_SampleRate / 2.;
+
+        if(frequency <= 0.f || frequency >= nyquist)
+            return;
+
+        const double a = std::pow(10., decibelsBoost / 40.);
+        const double w0 = 2. * std::numbers::pi * frequency / m_SampleRate;
+        const double cosW0 = std::cos(w0);
+        const double alpha = std::sin(w0) / (2. * q);
+        const double twoSqrtAAlpha = 2. * std::sqrt(a) * alpha;
+
+        AddBiquad(
+            a * ((a + 1.) - (a - 1.) * cosW0 + twoSqrtAAlpha),
+            2. * a * ((a - 1.) - (a + 1.) * cosW0),
+            a * ((a + 1.) - (a - 1.) * cosW0 - twoSqrtAAlpha),
+            (a + 1.) + (a - 1.) * cosW0 + twoSqrtAAlpha,
+            -2. * ((a - 1.) + (a + 1.) * cosW0),
+            (a + 1.) + (a - 1.) * cosW0 - twoSqrtAAlpha);
+    }
+    void BiquadEqualizer::AddPeaking(float decibelsBoost, float frequency, float q)
+    {
+        const double nyquist = m_SampleRate / 2.;
+
+        if(frequency <= 0.f || frequency >= nyquist)
+            return;
+
+        const double a = std::pow(10., decibelsBoost / 40.);
+        const double w0 = 2. * std::numbers::pi * frequency / m_SampleRate;
+        const double cosW0 = std::cos(w0);
+        const double alpha = std::sin(w0) / (2. * q);
+
+        AddBiquad(1. + alpha * a, -2. * cosW0, 1. - alpha * a, 1. + alpha / a, -2. * cosW0, 1. - alpha / a);
+    }
+    void BiquadEqualizer::AddBiquad(double b0, double b1, double b2, double a0, double a1, double a2)
+    {
+        m_B0.push_back(static_cast<float>(b0 / a0));
+        m_B1.push_back(static_cast<float>(b1 / a0));
+        m_B2.push_back(static_cast<float>(b2 / a0));
+        m_A1.push_back(static_cast<float>(a1 / a0));
+        m_A2.push_back(static_cast<float>(a2 / a0));
+    }
+}
+//getters, setters
+namespace Orchestra
+{
+    void BiquadEqualizer::SetBassBoost(float decibelsBoost, float frequencyToAdjust, float bandwidth)
+    {
+        m_BassBoostDecibels = decibelsBoost;
+        m_BassBoostFrequency = frequencyToAdjust;
+        m_BassBoostBandwidth = bandwidth;
+
+        UpdateCoefficients();
+    }
+    void BiquadEqualizer::SetEqualizer(const std::map<float, float>& frequencies)
+    {
+        m_EqualizerFrequencies = frequencies;
+
+        UpdateCoefficients();
+    }
+
+    int BiquadEqualizer::GetSampleRate() const noexcept
+    {
+        return m_SampleRate;
+    }
+    int BiquadEqualizer::GetChannelsCount() const noexcept
+    {
+        return m_ChannelsCount;
+    }
+    size_t BiquadEqualizer::GetBiquadsCount() const noexcept
+    {
+        return m_B0.size();
+    }
+    bool BiquadEqualizer::IsFlat() const noexcept
+    {
+        return m_B0.empty();
+    }
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <map>
+#include <span>
+#include <vector>
+#include <cstdint>
+
+namespace Orchestra
+{
+    //bass shelf and an N-band parametric equalizer made of cascaded biquads, which are processed in place on packed S16 PCM.
+    //the coefficients and the states are kept as separate arrays(SoA), the states of one biquad are contiguous over the channels, so the inner loop can be vectorized
+    class BiquadEqualizer
+    {
+    public:
+        //is used when the bass boost bandwidth is 0
+        static constexpr float DEFAULT_BASS_BOOST_Q = .707f;
+        static constexpr float DEFAULT_BASS_BOOST_FREQUENCY = 100.f;
+        //about an octave wide, so the neighbouring bands of a typical equalizer overlap a bit like the gain entries of firequalizer do
+        static constexpr float EQUALIZER_BAND_Q = 1.41f;
+
+    public:
+        BiquadEqualizer(int sampleRate = 48000, int channelsCount = 2);
+
+        //processes interleaved samples in place, does nothing when IsFlat
+        void Process(std::span<int16_t> samples);
+
+        //recalculates the coefficients for the new format, the states are zeroed
+        void Reset(int sampleRate, int channelsCount);
+        //zeroes the states only, so the tail of the previous audio isn't heard
+        void ClearState() noexcept;
+
+    public:
+        //bandwidth is the Q of the shelf
+        void SetBassBoost(float decibelsBoost = 0.f, float frequencyToAdjust = 0.f, float bandwidth = 0.f);
+        //first - frequency, second - decibels boost
+        void SetEqualizer(const std::map<float, float>& frequencies);
+
+        int GetSampleRate() const noexcept;
+        int GetChannelsCount() const noexcept;
+        size_t GetBiquadsCount() const noexcept;
+        //whether there are no biquads to apply
+        bool IsFlat() const noexcept;
+
+    private:
+        //runs one biquad over the whole interleaved buffer, ChannelsCount 0 means m_ChannelsCount, which isn't known at compile time
+        template<size_t ChannelsCount>
+        void ProcessBiquad(size_t biquad, float* buffer, size_t samplesCount);
+
+        void UpdateCoefficients();
+        void AddLowShelf(float decibelsBoost, float frequency, float q);
+        void AddPeaking(float decibelsBoost, float frequency, float q);
+        void AddBiquad(double b0, double b1, double b2, double a0, double a1, double a2);
+
+    private:
+        int m_SampleRate;
+        int m_ChannelsCount;
+
+        float m_BassBoostDecibels;
+        float m_BassBoostFrequency;
+        float m_BassBoostBandwidth;
+        std::map<float, float> m_EqualizerFrequencies;
+
+        //normalized by a0
+        std::vector<float> m_B0;
+        std::vector<float> m_B1;
+        std::vector<float> m_B2;
+        std::vector<float> m_A1;
+        std::vector<float> m_A2;
+
+        //transposed direct form II, [biquad * m_ChannelsCount + channel]
+        std::vector<float> m_Z1;
+        std::vector<float> m_Z2;
+
+        //the samples are converted to float once per Process, is reused
+        std::vector<float> m_Buffer;
+    };
+}
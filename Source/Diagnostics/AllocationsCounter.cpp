@@ -0,0 +1,65 @@
+#include "AllocationsCounter.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace Orchestra
+{
+    namespace
+    {
+        thread_local uint64_t s_ThreadAllocations = 0;
+        std::atomic_uint64_t s_TotalAllocations = 0;
+    }
+
+    uint64_t AllocationsCounter::GetThreadAllocations() noexcept
+    {
+        return s_ThreadAllocations;
+    }
+    uint64_t AllocationsCounter::GetTotalAllocations() noexcept
+    {
+        return s_TotalAllocations.load(std::memory_order_relaxed);
+    }
+
+    void AllocationsCounter::CountAllocation() noexcept
+    {
+        ++s_ThreadAllocations;
+        s_TotalAllocations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+#ifdef ORCHESTRA_COUNT_ALLOCATIONS
+//global replacements, the nothrow versions are forwarded to these ones by the standard library. over-aligned allocations are not counted
+void* operator new(size_t size)
+{
+    Orchestra::AllocationsCounter::CountAllocation();
+
+    if(size == 0)
+        size = 1;
+
+    if(void* ptr = std::malloc(size))
+        return ptr;
+
+    throw std::bad_alloc{};
+}
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+void operator delete[](void* ptr) noexcept
+{
+    std::free(ptr);
+}
+void operator delete(void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+void operator delete[](void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+#endif
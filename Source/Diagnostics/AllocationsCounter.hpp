@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Orchestra
+{
+    //counts every call of the global operator new, it is used to make sure that the hot paths(e.g. decoding) do not allocate.
+    //operator new is only replaced if ORCHESTRA_COUNT_ALLOCATIONS is defined(the CMake option of the same name and the benches), otherwise nothing is counted.
+    //NOTE: allocations made by FFmpeg itself(av_malloc, e.g. by av_frame_alloc or av_samples_alloc) are never counted, FFmpeg has no allocator hooks
+    class AllocationsCounter
+    {
+    public:
+#ifdef ORCHESTRA_COUNT_ALLOCATIONS
+        static constexpr bool IS_ENABLED = true;
+#else
+        static constexpr bool IS_ENABLED = false;
+#endif
+
+    public:
+        AllocationsCounter() = delete;
+        AllocationsCounter(const AllocationsCounter&) = delete;
+        AllocationsCounter(AllocationsCounter&&) = delete;
+        AllocationsCounter& operator=(const AllocationsCounter&) = delete;
+        AllocationsCounter& operator=(AllocationsCounter&&) = delete;
+        ~AllocationsCounter() = delete;
+
+    public:
+        //allocations made by the calling thread
+        static uint64_t GetThreadAllocations() noexcept;
+        //allocations made by all threads
+        static uint64_t GetTotalAllocations() noexcept;
+
+        static void CountAllocation() noexcept;
+    };
+}
@@ -0,0 +1,326 @@
+#include "Metrics.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <ranges>
+
+#include <GuelderConsoleLog.hpp>
+
+#include "../Utils.hpp"
+
+//private
+namespace Orchestra
+{
+    namespace
+    {
+        enum class MetricType : uint8_t
+        {
+            Counter,
+            Gauge,
+            Histogram
+        };
+
+        struct MetricsFamily
+        {
+            MetricType type;
+            std::string help;
+            std::vector<double> bounds;
+
+            //the key is the formatted labels, e.g. guild="123". Only the map of the family's type is used
+            std::map<std::string, std::unique_ptr<Metrics::Counter>> counters;
+            std::map<std::string, std::unique_ptr<Metrics::Gauge>> gauges;
+            std::map<std::string, std::unique_ptr<Metrics::Histogram>> histograms;
+        };
+
+        //sorted by names, so a scrape is always in the same order
+        std::map<std::string, MetricsFamily, std::less<>> s_Families;
+        std::mutex s_Mutex;
+
+        std::map<size_t, Metrics::Collector> s_Collectors;
+        size_t s_NextCollectorID = 0;
+        std::mutex s_CollectorsMutex;
+
+        std::atomic_size_t s_NextShardIndex = 0;
+
+        size_t GetThreadShardIndex() noexcept
+        {
+            thread_local const size_t shardIndex = s_NextShardIndex.fetch_add(1, std::memory_order_relaxed) % Metrics::Counter::SHARDS_COUNT;
+
+            return shardIndex;
+        }
+
+        std::string_view MetricTypeToString(MetricType type)
+        {
+            switch(type)
+            {
+            case MetricType::Counter:
+                return "counter";
+            case MetricType::Gauge:
+                return "gauge";
+            case MetricType::Histogram:
+                return "histogram";
+            }
+
+            return "untyped";
+        }
+
+        std::string FormatLabels(const Metrics::Labels& labels)
+        {
+            std::string result;
+
+            for(const auto& [name, value] : labels)
+            {
+                if(!result.empty())
+                    result.push_back(',');
+
+                result += name;
+                result += "=\"";
+
+                for(const char c : value)
+                {
+                    if(c == '\\' || c == '"')
+                        result.push_back('\\');
+
+                    if(c == '\n')
+                        result += "\\n";
+                    else
+                        result.push_back(c);
+                }
+
+                result.push_back('"');
+            }
+
+            return result;
+        }
+        void FormatSample(std::string& out, const std::string_view& name, const std::string_view& labels, const auto& value)
+        {
+            if(labels.empty())
+                out += GuelderConsoleLog::Logger::Format(name, ' ', value, '\n');
+            else
+                out += GuelderConsoleLog::Logger::Format(name, '{', labels, "} ", value, '\n');
+        }
+
+        //NOTE: s_Mutex must be locked
+        MetricsFamily& GetFamily(const std::string_view& name, const std::string_view& help, MetricType type)
+        {
+            auto found = s_Families.find(name);
+
+            if(found == s_Families.end())
+                found = s_Families.emplace(std::string{ name }, MetricsFamily{ type, std::string{ help }, {}, {}, {}, {} }).first;
+
+            O_ASSERT(found->second.type == type, "The metric ", name, " is already a ", MetricTypeToString(found->second.type), '.');
+
+            return found->second;
+        }
+    }
+}
+//Counter
+namespace Orchestra
+{
+    void Metrics::Counter::Increment(uint64_t value) noexcept
+    {
+        m_Shards[GetThreadShardIndex()].value.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    uint64_t Metrics::Counter::GetValue() const noexcept
+    {
+        uint64_t value = 0;
+
+        for(const Shard& shard : m_Shards)
+            value += shard.value.load(std::memory_order_relaxed);
+
+        return value;
+    }
+}
+//Gauge
+namespace Orchestra
+{
+    void Metrics::Gauge::Add(double value) noexcept
+    {
+        m_Value.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    void Metrics::Gauge::SetValue(double value) noexcept
+    {
+        m_Value.store(value, std::memory_order_relaxed);
+    }
+    double Metrics::Gauge::GetValue() const noexcept
+    {
+        return m_Value.load(std::memory_order_relaxed);
+    }
+}
+//Histogram
+namespace Orchestra
+{
+    Metrics::Histogram::Histogram(std::vector<double> bounds)
+        : m_Bounds(std::move(bounds)), m_BucketsCounts(std::make_unique<std::atomic_uint64_t[]>(m_Bounds.size() + 1)), m_Sum(0.)
+    {
+        O_ASSERT(std::ranges::is_sorted(m_Bounds), "The bounds of a histogram must be sorted.");
+    }
+
+    void Metrics::Histogram::Observe(double value) noexcept
+    {
+        const size_t bucket = std::ranges::lower_bound(m_Bounds, value) - m_Bounds.begin();
+
+        m_BucketsCounts[bucket].fetch_add(1, std::memory_order_relaxed);
+        m_Sum.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    const std::vector<double>& Metrics::Histogram::GetBounds() const noexcept
+    {
+        return m_Bounds;
+    }
+    std::vector<uint64_t> Metrics::Histogram::GetBucketsCounts() const
+    {
+        std::vector<uint64_t> bucketsCounts(m_Bounds.size() + 1);
+
+        for(size_t i = 0; i < bucketsCounts.size(); i++)
+            bucketsCounts[i] = m_BucketsCounts[i].load(std::memory_order_relaxed);
+
+        return bucketsCounts;
+    }
+    double Metrics::Histogram::GetSum() const noexcept
+    {
+        return m_Sum.load(std::memory_order_relaxed);
+    }
+}
+//ScopedTimer
+namespace Orchestra
+{
+    Metrics::ScopedTimer::ScopedTimer(Histogram& histogram, Counter* failures)
+        : m_Histogram(histogram), m_Failures(failures), m_Beginning(std::chrono::steady_clock::now()), m_UncaughtExceptionsCount(std::uncaught_exceptions()) {}
+    Metrics::ScopedTimer::~ScopedTimer()
+    {
+        if(std::uncaught_exceptions() > m_UncaughtExceptionsCount)
+        {
+            if(m_Failures)
+                m_Failures->Increment();
+
+            return;
+        }
+
+        m_Histogram.Observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - m_Beginning).count());
+    }
+}
+namespace Orchestra
+{
+    const std::vector<double> Metrics::DEFAULT_SECONDS_BOUNDS{ .005, .01, .025, .05, .1, .25, .5, 1., 2.5, 5., 10. };
+
+    Metrics::Counter& Metrics::GetCounter(const std::string_view& name, const std::string_view& help, const Labels& labels)
+    {
+        std::lock_guard lock{ s_Mutex };
+
+        auto& counter = GetFamily(name, help, MetricType::Counter).counters[FormatLabels(labels)];
+
+        if(!counter)
+            counter = std::make_unique<Counter>();
+
+        return *counter;
+    }
+    Metrics::Gauge& Metrics::GetGauge(const std::string_view& name, const std::string_view& help, const Labels& labels)
+    {
+        std::lock_guard lock{ s_Mutex };
+
+        auto& gauge = GetFamily(name, help, MetricType::Gauge).gauges[FormatLabels(labels)];
+
+        if(!gauge)
+            gauge = std::make_unique<Gauge>();
+
+        return *gauge;
+    }
+    Metrics::Histogram& Metrics::GetHistogram(const std::string_view& name, const std::string_view& help, const std::vector<double>& bounds, const Labels& labels)
+    {
+        std::lock_guard lock{ s_Mutex };
+
+        MetricsFamily& family = GetFamily(name, help, MetricType::Histogram);
+
+        if(family.histograms.empty())
+            family.bounds = bounds;
+
+        auto& histogram = family.histograms[FormatLabels(labels)];
+
+        if(!histogram)
+            histogram = std::make_unique<Histogram>(family.bounds);
+
+        return *histogram;
+    }
+
+    size_t Metrics::AddCollector(Collector collector)
+    {
+        std::lock_guard lock{ s_CollectorsMutex };
+
+        const size_t id = s_NextCollectorID++;
+
+        s_Collectors.emplace(id, std::move(collector));
+
+        return id;
+    }
+    void Metrics::RemoveCollector(size_t id)
+    {
+        std::lock_guard lock{ s_CollectorsMutex };
+
+        s_Collectors.erase(id);
+    }
+
+    std::string Metrics::Format()
+    {
+        //the collectors get their gauges, so they are run without s_Mutex
+        {
+            std::lock_guard lock{ s_CollectorsMutex };
+
+            for(const Collector& collector : std::views::values(s_Collectors))
+            {
+                try
+                {
+                    collector();
+                }
+                catch(const OrchestraException& e)
+                {
+                    GE_LOG(Orchestra, Warning, "A metrics collector has failed: ", e.GetFullMessage());
+                }
+            }
+        }
+
+        std::string result;
+
+        std::lock_guard lock{ s_Mutex };
+
+        for(const auto& [name, family] : s_Families)
+        {
+            result += GuelderConsoleLog::Logger::Format("# HELP ", name, ' ', family.help, '\n');
+            result += GuelderConsoleLog::Logger::Format("# TYPE ", name, ' ', MetricTypeToString(family.type), '\n');
+
+            for(const auto& [labels, counter] : family.counters)
+                FormatSample(result, name, labels, counter->GetValue());
+            for(const auto& [labels, gauge] : family.gauges)
+                FormatSample(result, name, labels, gauge->GetValue());
+
+            for(const auto& [labels, histogram] : family.histograms)
+            {
+                const std::string bucketName = name + "_bucket";
+                const std::string labelsPrefix = labels.empty() ? "" : labels + ',';
+                const std::vector<uint64_t> bucketsCounts = histogram->GetBucketsCounts();
+
+                //the buckets of the format are cumulative
+                uint64_t count = 0;
+
+                for(size_t i = 0; i < bucketsCounts.size(); i++)
+                {
+                    count += bucketsCounts[i];
+
+                    if(i < histogram->GetBounds().size())
+                        FormatSample(result, bucketName, GuelderConsoleLog::Logger::Format(labelsPrefix, "le=\"", histogram->GetBounds()[i], '"'), count);
+                    else
+                        FormatSample(result, bucketName, labelsPrefix + "le=\"+Inf\"", count);
+                }
+
+                FormatSample(result, name + "_sum", labels, histogram->GetSum());
+                FormatSample(result, name + "_count", labels, count);
+            }
+        }
+
+        return result;
+    }
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Orchestra
+{
+    //process-wide counters, gauges and histograms, which are formatted in the prometheus text format on a scrape(see MetricsServer).
+    //a metric is created by the first Get call with its name and labels and lives till the end of the process, so the returned reference can be kept
+    class Metrics
+    {
+    public:
+        using Labels = std::vector<std::pair<std::string, std::string>>;
+
+        //every thread adds to its own shard, so the hot paths don't fight for a cache line, the shards are summed on a scrape
+        class Counter
+        {
+        public:
+            static constexpr size_t SHARDS_COUNT = 16;
+
+        public:
+            Counter() = default;
+
+            Counter(const Counter&) = delete;
+            Counter(Counter&&) = delete;
+            Counter& operator=(const Counter&) = delete;
+            Counter& operator=(Counter&&) = delete;
+
+            void Increment(uint64_t value = 1) noexcept;
+
+        public:
+            uint64_t GetValue() const noexcept;
+
+        private:
+            struct alignas(64) Shard
+            {
+                std::atomic_uint64_t value = 0;
+            };
+
+        private:
+            std::array<Shard, SHARDS_COUNT> m_Shards;
+        };
+        class Gauge
+        {
+        public:
+            Gauge() = default;
+
+            Gauge(const Gauge&) = delete;
+            Gauge(Gauge&&) = delete;
+            Gauge& operator=(const Gauge&) = delete;
+            Gauge& operator=(Gauge&&) = delete;
+
+            void Add(double value) noexcept;
+
+        public:
+            void SetValue(double value) noexcept;
+            double GetValue() const noexcept;
+
+        private:
+            std::atomic<double> m_Value = 0.;
+        };
+        class Histogram
+        {
+        public:
+            //bounds are the upper ones of the buckets and must be sorted, the last bucket(+Inf) is added by itself
+            explicit Histogram(std::vector<double> bounds);
+
+            Histogram(const Histogram&) = delete;
+            Histogram(Histogram&&) = delete;
+            Histogram& operator=(const Histogram&) = delete;
+            Histogram& operator=(Histogram&&) = delete;
+
+            void Observe(double value) noexcept;
+
+        public:
+            const std::vector<double>& GetBounds() const noexcept;
+            //the count of each bucket, not cumulative, the last one is +Inf
+            std::vector<uint64_t> GetBucketsCounts() const;
+            double GetSum() const noexcept;
+
+        private:
+            std::vector<double> m_Bounds;
+            std::unique_ptr<std::atomic_uint64_t[]> m_BucketsCounts;
+            std::atomic<double> m_Sum;
+        };
+
+        //observes the seconds from its construction till its destruction, if it is destroyed by an exception, failures is incremented instead
+        class ScopedTimer
+        {
+        public:
+            ScopedTimer(Histogram& histogram, Counter* failures = nullptr);
+            ~ScopedTimer();
+
+            ScopedTimer(const ScopedTimer&) = delete;
+            ScopedTimer(ScopedTimer&&) = delete;
+            ScopedTimer& operator=(const ScopedTimer&) = delete;
+            ScopedTimer& operator=(ScopedTimer&&) = delete;
+
+        private:
+            Histogram& m_Histogram;
+            Counter* m_Failures;
+            std::chrono::steady_clock::time_point m_Beginning;
+            int m_UncaughtExceptionsCount;
+        };
+
+        //is called on every scrape before formatting, so the values which are already counted somewhere else(e.g. cache stats) are set into gauges only then
+        using Collector = std::function<void()>;
+
+    public:
+        //seconds, for the things which take from a fraction of a second to a few ones
+        static const std::vector<double> DEFAULT_SECONDS_BOUNDS;
+
+    public:
+        Metrics() = delete;
+        Metrics(const Metrics&) = delete;
+        Metrics(Metrics&&) = delete;
+        Metrics& operator=(const Metrics&) = delete;
+        Metrics& operator=(Metrics&&) = delete;
+        ~Metrics() = delete;
+
+    public:
+        //the help and the bounds of a name are taken from its first call. Throws if the name has been used by a metric of another type
+        static Counter& GetCounter(const std::string_view& name, const std::string_view& help, const Labels& labels = {});
+        static Gauge& GetGauge(const std::string_view& name, const std::string_view& help, const Labels& labels = {});
+        static Histogram& GetHistogram(const std::string_view& name, const std::string_view& help, const std::vector<double>& bounds = DEFAULT_SECONDS_BOUNDS, const Labels& labels = {});
+
+        //returns an id for RemoveCollector
+        static size_t AddCollector(Collector collector);
+        static void RemoveCollector(size_t id);
+
+        //runs the collectors and formats every metric in the prometheus text exposition format
+        static std::string Format();
+    };
+}
@@ -0,0 +1,235 @@
+#include "MetricsServer.hpp"
+
+#include <string>
+#include <string_view>
+
+#ifdef WIN32
+#define NOMINMAX
+#include <WinSock2.h>
+#include <WS2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+#include <GuelderConsoleLog.hpp>
+
+#include "../Utils.hpp"
+#include "Metrics.hpp"
+
+//private
+namespace Orchestra
+{
+    namespace
+    {
+#ifdef WIN32
+        using Socket = SOCKET;
+
+        constexpr Socket INVALID_SOCKET_VALUE = INVALID_SOCKET;
+
+        void CloseSocket(Socket socket)
+        {
+            closesocket(socket);
+        }
+        void SetReceiveTimeout(Socket socket, std::chrono::milliseconds timeout)
+        {
+            const DWORD value = static_cast<DWORD>(timeout.count());
+            setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+#else
+        using Socket = int;
+
+        constexpr Socket INVALID_SOCKET_VALUE = -1;
+
+        void CloseSocket(Socket socket)
+        {
+            close(socket);
+        }
+        void SetReceiveTimeout(Socket socket, std::chrono::milliseconds timeout)
+        {
+            const timeval value{ static_cast<time_t>(timeout.count() / 1000), static_cast<suseconds_t>(timeout.count() % 1000 * 1000) };
+            setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, &value, sizeof(value));
+        }
+#endif
+
+        bool SendAll(Socket socket, const std::string_view& data)
+        {
+            size_t sent = 0;
+
+            while(sent < data.size())
+            {
+                const int sentNow = send(socket, data.data() + sent, static_cast<int>(data.size() - sent), 0);
+
+                if(sentNow <= 0)
+                    return false;
+
+                sent += static_cast<size_t>(sentNow);
+            }
+
+            return true;
+        }
+        //returns the request line, e.g. "GET /metrics HTTP/1.1", or an empty string if the client hasn't sent it
+        std::string ReceiveRequestLine(Socket socket)
+        {
+            std::string request;
+            char buffer[1024];
+
+            //the headers are read as well, so the client doesn't get a reset connection
+            while(request.size() < MetricsServer::MAX_REQUEST_SIZE && request.find("\r\n\r\n") == std::string::npos)
+            {
+                const int received = recv(socket, buffer, sizeof(buffer), 0);
+
+                if(received <= 0)
+                    break;
+
+                request.append(buffer, static_cast<size_t>(received));
+            }
+
+            const size_t lineEnd = request.find("\r\n");
+
+            if(lineEnd == std::string::npos)
+                return {};
+
+            request.resize(lineEnd);
+
+            return request;
+        }
+        std::string MakeResponse(const std::string_view& status, const std::string_view& body)
+        {
+            return GuelderConsoleLog::Logger::Format("HTTP/1.1 ", status, "\r\n",
+                "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n",
+                "Content-Length: ", body.size(), "\r\n",
+                "Connection: close\r\n\r\n",
+                body);
+        }
+
+        void HandleClient(Socket client)
+        {
+            SetReceiveTimeout(client, MetricsServer::RECEIVE_TIMEOUT);
+
+            const std::string requestLine = ReceiveRequestLine(client);
+
+            if(requestLine.empty())
+                return;
+
+            std::string response;
+
+            if(!requestLine.starts_with("GET "))
+                response = MakeResponse("405 Method Not Allowed", "Only GET is supported.\n");
+            else if(requestLine.starts_with("GET /metrics ") || requestLine.starts_with("GET /metrics?"))
+                response = MakeResponse("200 OK", Metrics::Format());
+            else
+                response = MakeResponse("404 Not Found", "The metrics are at /metrics.\n");
+
+            SendAll(client, response);
+        }
+    }
+}
+namespace Orchestra
+{
+    MetricsServer::MetricsServer(uint16_t port)
+        : m_Port(port), m_Socket(INVALID_SOCKET_VALUE)
+    {
+#ifdef WIN32
+        WSADATA data;
+        O_ASSERT(WSAStartup(MAKEWORD(2, 2), &data) == 0, "Failed to initialize winsock for the metrics server.");
+#endif
+
+        const Socket listeningSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+
+        if(listeningSocket == INVALID_SOCKET_VALUE)
+        {
+#ifdef WIN32
+            WSACleanup();
+#endif
+            O_THROW("Failed to create a socket for the metrics server.");
+        }
+
+        const int reuseAddress = 1;
+        setsockopt(listeningSocket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuseAddress), sizeof(reuseAddress));
+
+        //local only, the metrics aren't meant to be public
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        if(bind(listeningSocket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || listen(listeningSocket, SOMAXCONN) != 0)
+        {
+            CloseSocket(listeningSocket);
+#ifdef WIN32
+            WSACleanup();
+#endif
+            O_THROW("Failed to listen on port ", port, " for the metrics server.");
+        }
+
+        m_Socket = listeningSocket;
+        m_Thread = std::jthread{ [this](std::stop_token stopToken) { Serve(std::move(stopToken)); } };
+
+        GE_LOG(Orchestra, Info, "Serving the metrics at http://127.0.0.1:", port, "/metrics.");
+    }
+    MetricsServer::~MetricsServer()
+    {
+        if(m_Thread.joinable())
+        {
+            m_Thread.request_stop();
+            m_Thread.join();
+        }
+
+        CloseSocket(static_cast<Socket>(m_Socket));
+
+#ifdef WIN32
+        WSACleanup();
+#endif
+    }
+
+    void MetricsServer::Serve(std::stop_token stopToken)
+    {
+        const Socket listeningSocket = static_cast<Socket>(m_Socket);
+
+        while(!stopToken.stop_requested())
+        {
+            fd_set readSet;
+            FD_ZERO(&readSet);
+            FD_SET(listeningSocket, &readSet);
+
+            timeval timeout{ 0, static_cast<decltype(timeval::tv_usec)>(std::chrono::duration_cast<std::chrono::microseconds>(ACCEPT_TIMEOUT).count()) };
+
+            //the first parameter is ignored on windows
+            if(select(static_cast<int>(listeningSocket) + 1, &readSet, nullptr, nullptr, &timeout) <= 0)
+                continue;
+
+            const Socket client = accept(listeningSocket, nullptr, nullptr);
+
+            if(client == INVALID_SOCKET_VALUE)
+                continue;
+
+            try
+            {
+                HandleClient(client);
+            }
+            catch(const OrchestraException& e)
+            {
+                GE_LOG(Orchestra, Warning, "Failed to serve the metrics: ", e.GetFullMessage());
+            }
+            catch(const std::exception& e)
+            {
+                GE_LOG(Orchestra, Warning, "Failed to serve the metrics: ", e.what());
+            }
+
+            CloseSocket(client);
+        }
+    }
+}
+//getters, setters
+namespace Orchestra
+{
+    uint16_t MetricsServer::GetPort() const noexcept
+    {
+        return m_Port;
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <stop_token>
+#include <thread>
+
+namespace Orchestra
+{
+    //a tiny http server on 127.0.0.1, which answers GET /metrics with Metrics::Format, so prometheus(or curl) can scrape the bot.
+    //requests are handled one at a time on its own thread
+    class MetricsServer
+    {
+    public:
+        //how often the listening thread checks whether it has to stop
+        static constexpr std::chrono::milliseconds ACCEPT_TIMEOUT{ 200 };
+        //a client which doesn't send its request in time is dropped
+        static constexpr std::chrono::seconds RECEIVE_TIMEOUT{ 2 };
+        static constexpr size_t MAX_REQUEST_SIZE = 8192;
+
+    public:
+        //throws if the port can't be listened on
+        explicit MetricsServer(uint16_t port);
+        ~MetricsServer();
+
+        MetricsServer(const MetricsServer&) = delete;
+        MetricsServer(MetricsServer&&) = delete;
+        MetricsServer& operator=(const MetricsServer&) = delete;
+        MetricsServer& operator=(MetricsServer&&) = delete;
+
+    public:
+        uint16_t GetPort() const noexcept;
+
+    private:
+        void Serve(std::stop_token stopToken);
+
+    private:
+        uint16_t m_Port;
+#ifdef WIN32
+        uintptr_t m_Socket;
+#else
+        int m_Socket;
+#endif
+        //is the last one, so it is joined before the socket is closed
+        std::jthread m_Thread;
+    };
+}
@@ -0,0 +1,280 @@
+#include "PlaybackTracer.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <unordered_map>
+#include <utility>
+
+#include <GuelderConsoleLog.hpp>
+
+#include "../Utils.hpp"
+
+//private
+namespace Orchestra
+{
+    namespace
+    {
+        struct GuildTraces
+        {
+            PlaybackTracer::Histograms histograms;
+            std::optional<std::chrono::steady_clock::time_point> firstAudioBeginning;
+        };
+
+        std::unordered_map<uint64_t, GuildTraces> s_GuildsTraces;
+        std::filesystem::path s_FilePath;
+
+        std::mutex s_Mutex;
+
+        //rounded to tenths, so the tables stay readable
+        float ToMilliseconds(std::chrono::microseconds duration)
+        {
+            return std::round(std::chrono::duration<float, std::milli>(duration).count() * 10.f) / 10.f;
+        }
+    }
+}
+//Histogram
+namespace Orchestra
+{
+    void PlaybackTracer::Histogram::Add(std::chrono::microseconds duration) noexcept
+    {
+        duration = std::max(duration, std::chrono::microseconds{ 0 });
+
+        const size_t bucket = std::min<size_t>(std::bit_width(static_cast<uint64_t>(duration.count())), BUCKETS_COUNT - 1);
+
+        buckets[bucket]++;
+        count++;
+        total += duration;
+        min = std::min(min, duration);
+        max = std::max(max, duration);
+    }
+    void PlaybackTracer::Histogram::Merge(const Histogram& other) noexcept
+    {
+        for(size_t i = 0; i < BUCKETS_COUNT; i++)
+            buckets[i] += other.buckets[i];
+
+        count += other.count;
+        total += other.total;
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+    }
+
+    std::chrono::microseconds PlaybackTracer::Histogram::GetPercentile(float percentile) const noexcept
+    {
+        if(!count)
+            return std::chrono::microseconds{ 0 };
+
+        const uint64_t rank = std::max<uint64_t>(static_cast<uint64_t>(std::ceil(percentile * static_cast<float>(count))), 1);
+
+        uint64_t counted = 0;
+
+        for(size_t i = 0; i < BUCKETS_COUNT; i++)
+        {
+            counted += buckets[i];
+
+            //the bound can't be bigger than what has actually been recorded
+            if(counted >= rank)
+                return std::min(std::chrono::microseconds{ (int64_t{ 1 } << i) - 1 }, max);
+        }
+
+        return max;
+    }
+    std::chrono::microseconds PlaybackTracer::Histogram::GetMean() const noexcept
+    {
+        return count ? total / static_cast<int64_t>(count) : std::chrono::microseconds{ 0 };
+    }
+}
+//ScopedSpan
+namespace Orchestra
+{
+    PlaybackTracer::ScopedSpan::ScopedSpan(uint64_t guildID, Span span)
+        : m_GuildID(guildID), m_Span(span), m_Beginning(std::chrono::steady_clock::now()), m_UncaughtExceptionsCount(std::uncaught_exceptions()) {}
+    PlaybackTracer::ScopedSpan::~ScopedSpan()
+    {
+        if(std::uncaught_exceptions() > m_UncaughtExceptionsCount)
+            return;
+
+        try
+        {
+            Record(m_GuildID, m_Span, std::chrono::steady_clock::now() - m_Beginning);
+        }
+        catch(...) {}
+    }
+}
+namespace Orchestra
+{
+    void PlaybackTracer::Record(uint64_t guildID, Span span, std::chrono::nanoseconds duration)
+    {
+        std::lock_guard lock{ s_Mutex };
+
+        s_GuildsTraces[guildID].histograms[static_cast<size_t>(span)].Add(std::chrono::duration_cast<std::chrono::microseconds>(duration));
+    }
+
+    void PlaybackTracer::Begin(uint64_t guildID, std::chrono::system_clock::time_point sentTime)
+    {
+        //the steady clock can't be compared with discord's one, so the time which has passed since sending is subtracted instead
+        const auto sincePlaying = std::max(std::chrono::system_clock::now() - sentTime, std::chrono::system_clock::duration{ 0 });
+        const auto beginning = std::chrono::steady_clock::now() - std::chrono::duration_cast<std::chrono::steady_clock::duration>(sincePlaying);
+
+        std::lock_guard lock{ s_Mutex };
+
+        s_GuildsTraces[guildID].firstAudioBeginning = beginning;
+    }
+    void PlaybackTracer::End(uint64_t guildID)
+    {
+        const auto now = std::chrono::steady_clock::now();
+
+        std::chrono::microseconds timeToFirstAudio;
+
+        {
+            std::lock_guard lock{ s_Mutex };
+
+            const auto found = s_GuildsTraces.find(guildID);
+
+            if(found == s_GuildsTraces.end() || !found->second.firstAudioBeginning)
+                return;
+
+            timeToFirstAudio = std::chrono::duration_cast<std::chrono::microseconds>(now - std::exchange(found->second.firstAudioBeginning, std::nullopt).value());
+
+            found->second.histograms[static_cast<size_t>(Span::TimeToFirstAudio)].Add(timeToFirstAudio);
+        }
+
+        GE_LOG(Orchestra, Info, "The first audio of guild ", guildID, " has been sent in ", ToMilliseconds(timeToFirstAudio), "ms after the play command.");
+    }
+
+    std::string PlaybackTracer::Format(const Histograms& histograms)
+    {
+        std::string result;
+
+        for(size_t i = 0; i < SPANS_COUNT; i++)
+        {
+            const Histogram& histogram = histograms[i];
+
+            if(!histogram.count)
+                continue;
+
+            result += GuelderConsoleLog::Logger::Format('`', SpanToString(static_cast<Span>(i)), "`: ", histogram.count,
+                " times, mean ", ToMilliseconds(histogram.GetMean()),
+                "ms, p50 ", ToMilliseconds(histogram.GetPercentile(.5f)),
+                "ms, p90 ", ToMilliseconds(histogram.GetPercentile(.9f)),
+                "ms, p99 ", ToMilliseconds(histogram.GetPercentile(.99f)),
+                "ms, max ", ToMilliseconds(histogram.max), "ms\n");
+        }
+
+        if(result.empty())
+            return "Nothing has been traced yet.\n";
+
+        return result;
+    }
+
+    void PlaybackTracer::WriteToFile(const std::filesystem::path& path)
+    {
+        std::string content;
+
+        {
+            std::lock_guard lock{ s_Mutex };
+
+            Histograms total{};
+
+            for(const auto& [guildID, guildTraces] : s_GuildsTraces)
+            {
+                for(size_t i = 0; i < SPANS_COUNT; i++)
+                    total[i].Merge(guildTraces.histograms[i]);
+
+                content += GuelderConsoleLog::Logger::Format("guild ", guildID, ":\n", Format(guildTraces.histograms), '\n');
+            }
+
+            content = GuelderConsoleLog::Logger::Format("all guilds:\n", Format(total), '\n', content);
+        }
+
+        std::ofstream file{ path, std::ios::trunc };
+
+        O_ASSERT(file.write(content.data(), static_cast<std::streamsize>(content.size())), "Failed to write the playback traces to ", path.string());
+    }
+    bool PlaybackTracer::WriteToFile()
+    {
+        const std::filesystem::path path = GetFilePath();
+
+        if(path.empty())
+            return false;
+
+        WriteToFile(path);
+
+        return true;
+    }
+
+    std::string_view PlaybackTracer::SpanToString(Span span) noexcept
+    {
+        switch(span)
+        {
+        case Span::Delivery:
+            return "delivery";
+        case Span::Parse:
+            return "parse";
+        case Span::Fetch:
+            return "fetch";
+        case Span::RawURL:
+            return "raw url";
+        case Span::DecoderOpen:
+            return "decoder open";
+        case Span::FirstDecode:
+            return "first decode";
+        case Span::FirstSend:
+            return "first send";
+        case Span::TimeToFirstAudio:
+            return "time to first audio";
+        default:
+            return "unknown";
+        }
+    }
+}
+//getters, setters
+namespace Orchestra
+{
+    PlaybackTracer::Histograms PlaybackTracer::GetHistograms(uint64_t guildID)
+    {
+        std::lock_guard lock{ s_Mutex };
+
+        const auto found = s_GuildsTraces.find(guildID);
+
+        return found != s_GuildsTraces.end() ? found->second.histograms : Histograms{};
+    }
+    PlaybackTracer::Histograms PlaybackTracer::GetTotalHistograms()
+    {
+        std::lock_guard lock{ s_Mutex };
+
+        Histograms total{};
+
+        for(const GuildTraces& guildTraces : std::views::values(s_GuildsTraces))
+            for(size_t i = 0; i < SPANS_COUNT; i++)
+                total[i].Merge(guildTraces.histograms[i]);
+
+        return total;
+    }
+
+    void PlaybackTracer::Reset(uint64_t guildID)
+    {
+        std::lock_guard lock{ s_Mutex };
+
+        if(const auto found = s_GuildsTraces.find(guildID); found != s_GuildsTraces.end())
+            found->second.histograms = {};
+    }
+
+    void PlaybackTracer::SetFilePath(std::filesystem::path path)
+    {
+        std::lock_guard lock{ s_Mutex };
+
+        s_FilePath = std::move(path);
+    }
+    std::filesystem::path PlaybackTracer::GetFilePath()
+    {
+        std::lock_guard lock{ s_Mutex };
+
+        return s_FilePath;
+    }
+}
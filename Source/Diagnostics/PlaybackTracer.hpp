@@ -0,0 +1,116 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace Orchestra
+{
+    //process-wide timings of where the time goes between a play command and its first sent audio, every span is kept in a histogram per guild
+    class PlaybackTracer
+    {
+    public:
+        enum class Span : uint8_t
+        {
+            //from the time discord has given to the message till it has been received, so it also contains the difference of the clocks
+            Delivery,
+            //ParseCommand
+            Parse,
+            //FetchURL or FetchSearch of a play command, so a call of yt-dlp for the info about the tracks
+            Fetch,
+            //a raw url, which the playback has waited for
+            RawURL,
+            //avformat_open_input and avformat_find_stream_info of a track
+            DecoderOpen,
+            //reading and decoding of the first frame of a track
+            FirstDecode,
+            //from the beginning of the playback of a track till its first audio has been sent
+            FirstSend,
+            //from the time discord has given to a play command, which has started the playback, till its first audio has been sent
+            TimeToFirstAudio,
+            Count
+        };
+
+        static constexpr size_t SPANS_COUNT = static_cast<size_t>(Span::Count);
+
+        struct Histogram
+        {
+            //the bucket i holds the durations which are less than 2^i microseconds, the last one holds the rest
+            static constexpr size_t BUCKETS_COUNT = 32;
+
+            std::array<uint64_t, BUCKETS_COUNT> buckets{};
+            uint64_t count = 0;
+            std::chrono::microseconds total{ 0 };
+            std::chrono::microseconds min = std::chrono::microseconds::max();
+            std::chrono::microseconds max{ 0 };
+
+            void Add(std::chrono::microseconds duration) noexcept;
+            void Merge(const Histogram& other) noexcept;
+
+            //the upper bound of the bucket which contains the percentile, 0 < percentile <= 1
+            std::chrono::microseconds GetPercentile(float percentile) const noexcept;
+            std::chrono::microseconds GetMean() const noexcept;
+        };
+
+        using Histograms = std::array<Histogram, SPANS_COUNT>;
+
+        //records the time from its construction till its destruction, nothing is recorded if it is destroyed by an exception
+        class ScopedSpan
+        {
+        public:
+            ScopedSpan(uint64_t guildID, Span span);
+            ~ScopedSpan();
+
+            ScopedSpan(const ScopedSpan&) = delete;
+            ScopedSpan(ScopedSpan&&) = delete;
+            ScopedSpan& operator=(const ScopedSpan&) = delete;
+            ScopedSpan& operator=(ScopedSpan&&) = delete;
+
+        private:
+            uint64_t m_GuildID;
+            Span m_Span;
+            std::chrono::steady_clock::time_point m_Beginning;
+            int m_UncaughtExceptionsCount;
+        };
+
+    public:
+        PlaybackTracer() = delete;
+        PlaybackTracer(const PlaybackTracer&) = delete;
+        PlaybackTracer(PlaybackTracer&&) = delete;
+        PlaybackTracer& operator=(const PlaybackTracer&) = delete;
+        PlaybackTracer& operator=(PlaybackTracer&&) = delete;
+        ~PlaybackTracer() = delete;
+
+    public:
+        static void Record(uint64_t guildID, Span span, std::chrono::nanoseconds duration);
+
+        //starts TimeToFirstAudio of the guild, sentTime is the time discord has given to the command. A previous one, which hasn't ended, is dropped
+        static void Begin(uint64_t guildID, std::chrono::system_clock::time_point sentTime);
+        //records TimeToFirstAudio if it has begun, so only the first sent audio after Begin is counted
+        static void End(uint64_t guildID);
+
+        //a table with the count, the mean, p50, p90, p99 and the max of every span which has been recorded
+        static std::string Format(const Histograms& histograms);
+
+        //writes the histograms of every guild and of all of them together, throws if it fails
+        static void WriteToFile(const std::filesystem::path& path);
+        //WriteToFile to the path set with SetFilePath, returns false if there is none
+        static bool WriteToFile();
+
+        static std::string_view SpanToString(Span span) noexcept;
+
+    public:
+        static Histograms GetHistograms(uint64_t guildID);
+        //of all guilds together
+        static Histograms GetTotalHistograms();
+
+        static void Reset(uint64_t guildID);
+
+        //empty turns the writing off
+        static void SetFilePath(std::filesystem::path path);
+        static std::filesystem::path GetFilePath();
+    };
+}
@@ -0,0 +1,374 @@
+#include "AudioCache.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <list>
+#include <mutex>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+#include <GuelderConsoleLog.hpp>
+
+#include "../Utils.hpp"
+
+//private
+namespace Orchestra
+{
+    namespace
+    {
+        struct AudioCacheEntry
+        {
+            std::string key;
+            uint64_t size;
+        };
+
+        std::filesystem::path s_Directory;
+        uint64_t s_MaxSize = 0;
+        bool s_IsLoaded = false;
+
+        //the front is the most recently played one
+        std::list<AudioCacheEntry> s_Entries;
+        std::unordered_map<std::string, std::list<AudioCacheEntry>::iterator> s_EntriesByKeys;
+        uint64_t s_Size = 0;
+
+        std::mutex s_Mutex;
+        //makes the temporary files unique, so two guilds can store the same track at once
+        uint64_t s_TemporaryFilesCount = 0;
+
+        uint64_t s_Hits = 0;
+        uint64_t s_Misses = 0;
+        uint64_t s_SavedBytes = 0;
+
+        constexpr size_t YOUTUBE_VIDEO_ID_SIZE = 11;
+
+        bool IsYouTubeVideoIDCharacter(char c)
+        {
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-' || c == '_';
+        }
+        //returns the id which begins at position, or an empty string if there is no valid one
+        std::string_view ReadYouTubeVideoID(const std::string_view& url, size_t position)
+        {
+            if(position == std::string_view::npos || position + YOUTUBE_VIDEO_ID_SIZE > url.size())
+                return {};
+
+            const std::string_view id = url.substr(position, YOUTUBE_VIDEO_ID_SIZE);
+
+            if(!std::ranges::all_of(id, IsYouTubeVideoIDCharacter))
+                return {};
+            //the id must not be a part of something longer
+            if(position + YOUTUBE_VIDEO_ID_SIZE < url.size() && IsYouTubeVideoIDCharacter(url[position + YOUTUBE_VIDEO_ID_SIZE]))
+                return {};
+
+            return id;
+        }
+        std::string_view FindYouTubeVideoID(const std::string_view& url)
+        {
+            if(url.find("youtube.com") == std::string_view::npos && url.find("youtu.be") == std::string_view::npos)
+                return {};
+
+            for(const std::string_view prefix : { "youtu.be/", "/shorts/", "/live/", "/embed/" })
+                if(const size_t found = url.find(prefix); found != std::string_view::npos)
+                    return ReadYouTubeVideoID(url, found + prefix.size());
+
+            for(const std::string_view parameter : { "?v=", "&v=" })
+                if(const size_t found = url.find(parameter); found != std::string_view::npos)
+                    return ReadYouTubeVideoID(url, found + parameter.size());
+
+            return {};
+        }
+
+        //FNV-1a, std::hash is not guaranteed to be the same between builds and the keys are file names
+        uint64_t HashURL(const std::string_view& url)
+        {
+            uint64_t hash = 14695981039346656037ull;
+
+            for(const char c : url)
+            {
+                hash ^= static_cast<uint8_t>(c);
+                hash *= 1099511628211ull;
+            }
+
+            return hash;
+        }
+
+        std::filesystem::path GetFilePath(const std::string_view& key)
+        {
+            return s_Directory / (std::string{ key } + std::string{ AudioCache::FILE_EXTENSION });
+        }
+        std::filesystem::path GetSeekIndexFilePath(const std::string_view& key)
+        {
+            return s_Directory / (std::string{ key } + std::string{ AudioCache::SEEK_INDEX_FILE_EXTENSION });
+        }
+
+        //NOTE: s_Mutex must be locked
+        void EraseEntry(std::list<AudioCacheEntry>::iterator entry)
+        {
+            std::error_code error;
+            std::filesystem::remove(GetFilePath(entry->key), error);
+
+            //e.g. the file is being played right now, it will be found again on the next Load
+            if(error)
+                GE_LOG(Orchestra, Warning, "Failed to remove ", entry->key, " from the audio cache: ", error.message());
+
+            std::filesystem::remove(GetSeekIndexFilePath(entry->key), error);
+
+            s_Size -= entry->size;
+            s_EntriesByKeys.erase(entry->key);
+            s_Entries.erase(entry);
+        }
+        //NOTE: s_Mutex must be locked
+        void EvictOverMaxSize()
+        {
+            while(s_Size > s_MaxSize && !s_Entries.empty())
+                EraseEntry(std::prev(s_Entries.end()));
+        }
+    }
+}
+namespace Orchestra
+{
+    void AudioCache::Load(const std::filesystem::path& directory, uint64_t maxSize)
+    {
+        std::lock_guard lock{ s_Mutex };
+
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+
+        O_ASSERT(!error, "Failed to create the audio cache directory ", directory.string(), ": ", error.message());
+
+        s_Directory = directory;
+        s_MaxSize = maxSize;
+
+        s_Entries.clear();
+        s_EntriesByKeys.clear();
+        s_Size = 0;
+
+        struct LoadedFile
+        {
+            std::string key;
+            uint64_t size;
+            std::filesystem::file_time_type lastWriteTime;
+        };
+
+        std::vector<LoadedFile> files;
+
+        for(const auto& directoryEntry : std::filesystem::directory_iterator{ directory, error })
+        {
+            if(!directoryEntry.is_regular_file(error))
+                continue;
+
+            const std::filesystem::path& path = directoryEntry.path();
+
+            //kept if its track is there
+            if(path.extension() == SEEK_INDEX_FILE_EXTENSION)
+            {
+                std::filesystem::path audioPath = path;
+                audioPath.replace_extension(FILE_EXTENSION);
+
+                if(!std::filesystem::exists(audioPath, error))
+                    std::filesystem::remove(path, error);
+
+                continue;
+            }
+
+            //half written files of a previous run
+            if(path.extension() != FILE_EXTENSION)
+            {
+                std::filesystem::remove(path, error);
+                continue;
+            }
+
+            files.emplace_back(path.stem().string(), directoryEntry.file_size(error), directoryEntry.last_write_time(error));
+        }
+
+        std::ranges::sort(files, std::ranges::greater{}, &LoadedFile::lastWriteTime);
+
+        for(LoadedFile& file : files)
+        {
+            s_Entries.emplace_back(std::move(file.key), file.size);
+            s_EntriesByKeys.emplace(s_Entries.back().key, std::prev(s_Entries.end()));
+            s_Size += file.size;
+        }
+
+        EvictOverMaxSize();
+
+        s_IsLoaded = true;
+
+        GE_LOG(Orchestra, Info, "Loaded ", s_Entries.size(), " tracks of ", s_Size, " bytes from the audio cache in ", directory.string(), '.');
+    }
+
+    std::string AudioCache::MakeKey(const std::string_view& url)
+    {
+        if(url.empty() || !IsLoaded())
+            return {};
+
+        if(const std::string_view id = FindYouTubeVideoID(url); !id.empty())
+            return "youtube-" + std::string{ id };
+
+        constexpr std::string_view hexDigits = "0123456789abcdef";
+
+        std::string key = "url-0000000000000000";
+        uint64_t hash = HashURL(url);
+
+        for(size_t i = key.size(); hash; i--, hash >>= 4)
+            key[i - 1] = hexDigits[hash & 0xF];
+
+        return key;
+    }
+
+    bool AudioCache::Contains(const std::string_view& key)
+    {
+        if(key.empty())
+            return false;
+
+        std::lock_guard lock{ s_Mutex };
+
+        return s_EntriesByKeys.contains(std::string{ key });
+    }
+    std::optional<std::filesystem::path> AudioCache::Find(const std::string_view& key)
+    {
+        if(key.empty())
+            return std::nullopt;
+
+        std::lock_guard lock{ s_Mutex };
+
+        const auto found = s_EntriesByKeys.find(std::string{ key });
+
+        if(found == s_EntriesByKeys.end())
+        {
+            s_Misses++;
+            return std::nullopt;
+        }
+
+        std::filesystem::path path = GetFilePath(key);
+
+        std::error_code error;
+
+        //the file could have been removed by someone else
+        if(!std::filesystem::exists(path, error))
+        {
+            std::filesystem::remove(GetSeekIndexFilePath(key), error);
+
+            s_Size -= found->second->size;
+            s_Entries.erase(found->second);
+            s_EntriesByKeys.erase(found);
+
+            s_Misses++;
+            return std::nullopt;
+        }
+
+        s_Entries.splice(s_Entries.begin(), s_Entries, found->second);
+
+        //so the order survives restarts
+        std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error);
+
+        s_Hits++;
+        s_SavedBytes += found->second->size;
+
+        GE_LOG(Orchestra, Info, "Playing ", key, " from the audio cache. Audio cache hit rate: ", static_cast<float>(s_Hits) / static_cast<float>(s_Hits + s_Misses) * 100.f, "%, saved bytes: ", s_SavedBytes, '.');
+
+        return path;
+    }
+    void AudioCache::Store(const std::string_view& key, std::span<const uint8_t> data)
+    {
+        if(key.empty() || data.empty())
+            return;
+
+        std::unique_lock lock{ s_Mutex };
+
+        if(!s_IsLoaded || data.size() > s_MaxSize || s_EntriesByKeys.contains(std::string{ key }))
+            return;
+
+        const std::filesystem::path path = GetFilePath(key);
+        std::filesystem::path temporaryPath = path;
+        temporaryPath.replace_extension(GuelderConsoleLog::Logger::Format('.', s_TemporaryFilesCount++, ".tmp"));
+
+        //the other tracks can be found and stored while it is being written
+        lock.unlock();
+
+        {
+            std::ofstream file{ temporaryPath, std::ios::binary | std::ios::trunc };
+
+            if(!file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size())))
+            {
+                GE_LOG(Orchestra, Warning, "Failed to write ", key, " to the audio cache.");
+
+                file.close();
+
+                std::error_code error;
+                std::filesystem::remove(temporaryPath, error);
+
+                return;
+            }
+        }
+
+        std::error_code error;
+
+        lock.lock();
+
+        //it has been stored by someone else or the cache has been reloaded meanwhile
+        if(s_EntriesByKeys.contains(std::string{ key }) || GetFilePath(key) != path)
+        {
+            std::filesystem::remove(temporaryPath, error);
+            return;
+        }
+
+        std::filesystem::rename(temporaryPath, path, error);
+
+        if(error)
+        {
+            GE_LOG(Orchestra, Warning, "Failed to move ", key, " into the audio cache: ", error.message());
+
+            std::filesystem::remove(temporaryPath, error);
+
+            return;
+        }
+
+        s_Entries.emplace_front(std::string{ key }, data.size());
+        s_EntriesByKeys.emplace(s_Entries.front().key, s_Entries.begin());
+        s_Size += data.size();
+
+        EvictOverMaxSize();
+
+        GE_LOG(Orchestra, Info, "Cached ", data.size(), " bytes of ", key, ". Audio cache size: ", s_Size, " bytes in ", s_Entries.size(), " tracks.");
+    }
+
+    std::filesystem::path AudioCache::GetSeekIndexPath(const std::string_view& key)
+    {
+        if(key.empty())
+            return {};
+
+        std::lock_guard lock{ s_Mutex };
+
+        if(!s_IsLoaded)
+            return {};
+
+        return GetSeekIndexFilePath(key);
+    }
+    bool AudioCache::HasTrackOfSeekIndex(const std::filesystem::path& seekIndexPath)
+    {
+        std::lock_guard lock{ s_Mutex };
+
+        if(!s_IsLoaded || seekIndexPath.parent_path() != s_Directory || seekIndexPath.extension() != SEEK_INDEX_FILE_EXTENSION)
+            return false;
+
+        return s_EntriesByKeys.contains(seekIndexPath.stem().string());
+    }
+}
+//getters, setters
+namespace Orchestra
+{
+    bool AudioCache::IsLoaded()
+    {
+        std::lock_guard lock{ s_Mutex };
+
+        return s_IsLoaded;
+    }
+    AudioCache::Stats AudioCache::GetStats()
+    {
+        std::lock_guard lock{ s_Mutex };
+
+        return { s_Hits, s_Misses, s_SavedBytes, s_Entries.size(), s_Size };
+    }
+}
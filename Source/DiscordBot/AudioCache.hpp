@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace Orchestra
+{
+    //process-wide on-disk cache of downloaded audio, the key is made from a webpage url(e.g. the video id of a youtube one).
+    //the audio is stored as it was downloaded, one plain file per track, the least recently played ones are removed when the total size is over the limit
+    class AudioCache
+    {
+    public:
+        struct Stats
+        {
+            uint64_t hits;
+            uint64_t misses;
+            //the bytes which hits didn't have to download
+            uint64_t savedBytes;
+            size_t filesCount;
+            uint64_t size;
+
+            float GetHitRate() const { return hits + misses ? static_cast<float>(hits) / static_cast<float>(hits + misses) : 0.f; }
+        };
+
+    public:
+        AudioCache() = delete;
+        AudioCache(const AudioCache&) = delete;
+        AudioCache(AudioCache&&) = delete;
+        AudioCache& operator=(const AudioCache&) = delete;
+        AudioCache& operator=(AudioCache&&) = delete;
+        ~AudioCache() = delete;
+
+    public:
+        //indexes the files which are already in the directory, the last played ones are the most recent. If it is never called, nothing is cached
+        static void Load(const std::filesystem::path& directory, uint64_t maxSize);
+
+        //the video id for youtube urls, a hash of the url for the rest, empty if the cache isn't loaded or the url is empty
+        static std::string MakeKey(const std::string_view& url);
+
+        //doesn't count as a hit or a miss
+        static bool Contains(const std::string_view& key);
+        //returns the path of the file and marks it as the most recently played one
+        static std::optional<std::filesystem::path> Find(const std::string_view& key);
+        //writes the audio to a temporary file first, so a half written one is never found
+        static void Store(const std::string_view& key, std::span<const uint8_t> data);
+
+        //the sidecar file of the track's SeekIndex, which is removed together with the track. Empty if the cache isn't loaded or the key is empty
+        static std::filesystem::path GetSeekIndexPath(const std::string_view& key);
+        //whether the track of the seek index path(from GetSeekIndexPath) is in the cache, the index of a track which hasn't been stored would be left alone
+        static bool HasTrackOfSeekIndex(const std::filesystem::path& seekIndexPath);
+
+        static bool IsLoaded();
+        static Stats GetStats();
+
+    public:
+        static constexpr std::string_view FILE_EXTENSION = ".audio";
+        static constexpr std::string_view SEEK_INDEX_FILE_EXTENSION = ".index";
+    };
+}
@@ -10,12 +10,25 @@
 
 #include "Command.hpp"
 #include "../Workers/WorkersManager.hpp"
+#include "../Diagnostics/Metrics.hpp"
 #include "../Utils.hpp"
 
 namespace Orchestra
 {
     DiscordBot::DiscordBot(const std::string& token, uint32_t intents)
-        : dpp::cluster(token, intents) {}
+        : dpp::cluster(token, intents)
+    {
+        m_MetricsCollectorID = Metrics::AddCollector([this]
+            {
+                static Metrics::Gauge& pendingCommands = Metrics::GetGauge("orchestra_command_tasks_pending", "The commands which wait for a free thread of the pool.");
+
+                pendingCommands.SetValue(static_cast<double>(m_WorkersManger.GetThreadPool().GetPendingTasksCount()));
+            });
+    }
+    DiscordBot::~DiscordBot()
+    {
+        Metrics::RemoveCollector(m_MetricsCollectorID);
+    }
 
     void DiscordBot::AddCommand(Command command)
     {
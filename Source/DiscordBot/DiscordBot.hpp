@@ -21,7 +21,7 @@ namespace Orchestra
     {
     public:
         DiscordBot(const std::string& token, uint32_t intents = dpp::i_all_intents);
-        ~DiscordBot() override = default;
+        ~DiscordBot() override;
 
         void AddCommand(Command command);
         virtual void RegisterCommands() = 0;
@@ -48,6 +48,10 @@ namespace Orchestra
 
         WorkersManager<void, OrchestraException> m_WorkersManger;
 
+    private:
+        //sets the gauge of the pending commands on a scrape of the metrics
+        size_t m_MetricsCollectorID;
+
     private:
         static bool IsValidParamNameChar(char ch);
         static bool IsValidParamNameBeginningChar(char ch);
@@ -0,0 +1,34 @@
+#include "DiscordVoiceSink.hpp"
+
+#include <dpp/dpp.h>
+
+namespace Orchestra
+{
+    DiscordVoiceSink::DiscordVoiceSink(dpp::discord_voice_client& voiceClient)
+        : m_VoiceClient(voiceClient) {}
+
+    void DiscordVoiceSink::SendAudioRaw(uint16_t* audio, size_t size)
+    {
+        m_VoiceClient.send_audio_raw(audio, size);
+    }
+    void DiscordVoiceSink::SendAudioOpus(uint8_t* packet, size_t size)
+    {
+        m_VoiceClient.send_audio_opus(packet, size);
+    }
+    void DiscordVoiceSink::StopAudio()
+    {
+        m_VoiceClient.stop_audio();
+    }
+}
+//getters, setters
+namespace Orchestra
+{
+    float DiscordVoiceSink::GetSecondsRemaining()
+    {
+        return m_VoiceClient.get_secs_remaining();
+    }
+    uint64_t DiscordVoiceSink::GetGuildID() const
+    {
+        return m_VoiceClient.server_id;
+    }
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <dpp/dpp.h>
+
+#include "VoiceSink.hpp"
+
+namespace Orchestra
+{
+    //forwards everything to discord's voice client, which must outlive it
+    class DiscordVoiceSink : public VoiceSink
+    {
+    public:
+        explicit DiscordVoiceSink(dpp::discord_voice_client& voiceClient);
+        ~DiscordVoiceSink() override = default;
+
+        void SendAudioRaw(uint16_t* audio, size_t size) override;
+        void SendAudioOpus(uint8_t* packet, size_t size) override;
+        void StopAudio() override;
+
+    public:
+        float GetSecondsRemaining() override;
+        uint64_t GetGuildID() const override;
+
+    private:
+        dpp::discord_voice_client& m_VoiceClient;
+    };
+}
@@ -0,0 +1,396 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "../Utils.hpp"
+
+namespace Orchestra
+{
+    //a sequence, which inserts, erases, moves and finds by index in O(log n), instead of shifting the elements like std::vector does.
+    //it is a treap keyed by the sizes of the subtrees, the nodes are never reallocated, so a pointer to one(and to its value) lives till it is erased.
+    //the ranges are [from, to), like in std algorithms
+    template<typename T>
+    class ImplicitTreap
+    {
+    public:
+        struct Node
+        {
+            T value;
+
+            //do not touch these, they belong to the treap
+            Node* left = nullptr;
+            Node* right = nullptr;
+            Node* parent = nullptr;
+            size_t size = 1;
+            uint32_t priority = 0;
+        };
+
+    public:
+        ImplicitTreap() = default;
+        ~ImplicitTreap()
+        {
+            Clear();
+        }
+
+        ImplicitTreap(const ImplicitTreap& other)
+        {
+            CopyFrom(other);
+        }
+        ImplicitTreap& operator=(const ImplicitTreap& other)
+        {
+            if(this != &other)
+            {
+                Clear();
+                CopyFrom(other);
+            }
+
+            return *this;
+        }
+        ImplicitTreap(ImplicitTreap&& other) noexcept
+        {
+            MoveFrom(std::move(other));
+        }
+        ImplicitTreap& operator=(ImplicitTreap&& other) noexcept
+        {
+            if(this != &other)
+            {
+                Clear();
+                MoveFrom(std::move(other));
+            }
+
+            return *this;
+        }
+
+        Node* Insert(size_t index, T value)
+        {
+            O_ASSERT(index <= GetSize(), "Cannot insert at ", index, ", the size is ", GetSize(), '.');
+
+            Node* node = new Node{ std::move(value) };
+            node->priority = m_RandomEngine();
+
+            auto [left, right] = Split(m_Root, index);
+
+            SetRoot(Merge(Merge(left, node), right));
+
+            return node;
+        }
+        void Erase(size_t index)
+        {
+            Erase(index, index + 1);
+        }
+        void Erase(size_t from, size_t to)
+        {
+            O_ASSERT(from <= to && to <= GetSize(), "Cannot erase [", from, ", ", to, "), the size is ", GetSize(), '.');
+
+            auto [left, middleAndRight] = Split(m_Root, from);
+            auto [middle, right] = Split(middleAndRight, to - from);
+
+            Destroy(middle);
+
+            SetRoot(Merge(left, right));
+        }
+
+        //the same as Transfer from Utils.hpp: the element at "from" ends up at "to"
+        void Move(size_t from, size_t to)
+        {
+            O_ASSERT(from < GetSize() && to < GetSize(), "Cannot move ", from, " to ", to, ", the size is ", GetSize(), '.');
+
+            if(from == to)
+                return;
+
+            auto [left, nodeAndRight] = Split(m_Root, from);
+            auto [node, right] = Split(nodeAndRight, 1);
+
+            auto [newLeft, newRight] = Split(Merge(left, right), to);
+
+            SetRoot(Merge(Merge(newLeft, node), newRight));
+        }
+        //O(to - from), the nodes are relinked, so the pointers to them stay valid
+        void Reverse(size_t from, size_t to)
+        {
+            RearrangeRange(from, to, [](std::vector<Node*>& nodes) { std::ranges::reverse(nodes); });
+        }
+        //O(to - from), the nodes are relinked, so the pointers to them stay valid
+        template<typename RandomEngine>
+        void Shuffle(size_t from, size_t to, RandomEngine& randomEngine)
+        {
+            RearrangeRange(from, to, [&randomEngine](std::vector<Node*>& nodes) { std::ranges::shuffle(nodes, randomEngine); });
+        }
+
+        void Clear()
+        {
+            Destroy(m_Root);
+            m_Root = nullptr;
+        }
+
+        //the function is called with Node& in the order of the sequence
+        template<typename Function>
+        void ForEach(Function&& function) const
+        {
+            ForEach(m_Root, function);
+        }
+        template<typename Function>
+        void ForEach(size_t from, size_t to, Function&& function) const
+        {
+            O_ASSERT(from <= to && to <= GetSize(), "Cannot iterate [", from, ", ", to, "), the size is ", GetSize(), '.');
+
+            ForEach(m_Root, from, to, function);
+        }
+
+    public:
+        size_t GetSize() const noexcept { return GetSize(m_Root); }
+        bool IsEmpty() const noexcept { return !m_Root; }
+
+        T& operator[](size_t index) { return GetNode(index)->value; }
+        const T& operator[](size_t index) const { return GetNode(index)->value; }
+
+        Node* GetNode(size_t index) const
+        {
+            O_ASSERT(index < GetSize(), "The index ", index, " is out of range, the size is ", GetSize(), '.');
+
+            Node* node = m_Root;
+
+            while(true)
+            {
+                const size_t leftSize = GetSize(node->left);
+
+                if(index < leftSize)
+                    node = node->left;
+                else if(index == leftSize)
+                    return node;
+                else
+                {
+                    index -= leftSize + 1;
+                    node = node->right;
+                }
+            }
+        }
+        //the node must belong to this treap
+        size_t GetIndex(const Node* node) const noexcept
+        {
+            size_t index = GetSize(node->left);
+
+            for(; node->parent; node = node->parent)
+                if(node == node->parent->right)
+                    index += GetSize(node->parent->left) + 1;
+
+            return index;
+        }
+
+    private:
+        static size_t GetSize(const Node* node) noexcept { return node ? node->size : 0; }
+
+        //must be called after the children of the node have been changed
+        static void Update(Node* node) noexcept
+        {
+            node->size = 1 + GetSize(node->left) + GetSize(node->right);
+
+            if(node->left)
+                node->left->parent = node;
+            if(node->right)
+                node->right->parent = node;
+        }
+
+        //the first one gets "count" elements
+        static std::pair<Node*, Node*> Split(Node* node, size_t count) noexcept
+        {
+            if(!node)
+                return { nullptr, nullptr };
+
+            if(GetSize(node->left) >= count)
+            {
+                auto [left, right] = Split(node->left, count);
+
+                node->left = right;
+                Update(node);
+
+                if(left)
+                    left->parent = nullptr;
+
+                return { left, node };
+            }
+            else
+            {
+                auto [left, right] = Split(node->right, count - GetSize(node->left) - 1);
+
+                node->right = left;
+                Update(node);
+
+                if(right)
+                    right->parent = nullptr;
+
+                return { node, right };
+            }
+        }
+        static Node* Merge(Node* left, Node* right) noexcept
+        {
+            if(!left)
+                return right;
+            if(!right)
+                return left;
+
+            if(left->priority > right->priority)
+            {
+                left->right = Merge(left->right, right);
+                Update(left);
+
+                return left;
+            }
+            else
+            {
+                right->left = Merge(left, right->left);
+                Update(right);
+
+                return right;
+            }
+        }
+
+        //builds a treap of the nodes in their order in O(n), keeping their priorities
+        static Node* Build(const std::vector<Node*>& nodes)
+        {
+            std::vector<Node*> rightSpine;
+
+            for(Node* node : nodes)
+            {
+                node->left = nullptr;
+                node->right = nullptr;
+
+                Node* last = nullptr;
+
+                while(!rightSpine.empty() && rightSpine.back()->priority < node->priority)
+                {
+                    last = rightSpine.back();
+                    rightSpine.pop_back();
+                }
+
+                node->left = last;
+
+                if(!rightSpine.empty())
+                    rightSpine.back()->right = node;
+
+                rightSpine.push_back(node);
+            }
+
+            if(rightSpine.empty())
+                return nullptr;
+
+            UpdateSubtree(rightSpine.front());
+            rightSpine.front()->parent = nullptr;
+
+            return rightSpine.front();
+        }
+        static void UpdateSubtree(Node* node) noexcept
+        {
+            if(!node)
+                return;
+
+            UpdateSubtree(node->left);
+            UpdateSubtree(node->right);
+            Update(node);
+        }
+        static void Collect(Node* node, std::vector<Node*>& nodes)
+        {
+            if(!node)
+                return;
+
+            Collect(node->left, nodes);
+            nodes.push_back(node);
+            Collect(node->right, nodes);
+        }
+
+        static void Destroy(Node* node) noexcept
+        {
+            if(!node)
+                return;
+
+            Destroy(node->left);
+            Destroy(node->right);
+
+            delete node;
+        }
+        static Node* Copy(const Node* node, Node* parent)
+        {
+            if(!node)
+                return nullptr;
+
+            Node* copy = new Node{ node->value, nullptr, nullptr, parent, node->size, node->priority };
+
+            copy->left = Copy(node->left, copy);
+            copy->right = Copy(node->right, copy);
+
+            return copy;
+        }
+
+        template<typename Function>
+        static void ForEach(Node* node, Function& function)
+        {
+            if(!node)
+                return;
+
+            ForEach(node->left, function);
+            function(*node);
+            ForEach(node->right, function);
+        }
+        //goes only into the subtrees which intersect [from, to), which are relative to the node
+        template<typename Function>
+        static void ForEach(Node* node, size_t from, size_t to, Function& function)
+        {
+            if(!node || from >= to)
+                return;
+
+            const size_t leftSize = GetSize(node->left);
+
+            if(from < leftSize)
+                ForEach(node->left, from, std::min(to, leftSize), function);
+            if(from <= leftSize && leftSize < to)
+                function(*node);
+            if(to > leftSize + 1)
+                ForEach(node->right, from > leftSize ? from - leftSize - 1 : 0, to - leftSize - 1, function);
+        }
+
+        template<typename Rearrange>
+        void RearrangeRange(size_t from, size_t to, Rearrange&& rearrange)
+        {
+            O_ASSERT(from <= to && to <= GetSize(), "Cannot rearrange [", from, ", ", to, "), the size is ", GetSize(), '.');
+
+            auto [left, middleAndRight] = Split(m_Root, from);
+            auto [middle, right] = Split(middleAndRight, to - from);
+
+            std::vector<Node*> nodes;
+            nodes.reserve(to - from);
+
+            Collect(middle, nodes);
+            rearrange(nodes);
+
+            SetRoot(Merge(Merge(left, Build(nodes)), right));
+        }
+
+        void SetRoot(Node* root) noexcept
+        {
+            m_Root = root;
+
+            if(m_Root)
+                m_Root->parent = nullptr;
+        }
+
+        void CopyFrom(const ImplicitTreap& other)
+        {
+            m_Root = Copy(other.m_Root, nullptr);
+            m_RandomEngine = other.m_RandomEngine;
+        }
+        void MoveFrom(ImplicitTreap&& other) noexcept
+        {
+            m_Root = std::exchange(other.m_Root, nullptr);
+            m_RandomEngine = other.m_RandomEngine;
+        }
+
+    private:
+        Node* m_Root = nullptr;
+        //the priorities only have to be random enough to keep the treap balanced
+        std::mt19937 m_RandomEngine;
+    };
+}
@@ -23,6 +23,7 @@
 #include "Player.hpp"
 #include "Yt_DlpManager.hpp"
 #include "TracksQueue.hpp"
+#include "../Diagnostics/PlaybackTracer.hpp"
 
 using namespace GuelderConsoleLog;
 
@@ -86,6 +87,16 @@ namespace Orchestra
                             guildsConfig.WriteVariable({ variablePath, Logger::Format(properties.sentPacketsSize), DataType::UInt, false });
                         }
 
+                        variablePath = Logger::Format(event.created->id, "/decodeAheadBufferSize");
+                        try
+                        {
+                            properties.decodeAheadBufferSize = guildsConfig.GetVariable(variablePath).GetValue<uint32_t>();
+                        }
+                        catch(...)
+                        {
+                            guildsConfig.WriteVariable({ variablePath, Logger::Format(properties.decodeAheadBufferSize), DataType::UInt, false });
+                        }
+
                         variablePath = Logger::Format(event.created->id, "/enableLogSentPackets");
                         try
                         {
@@ -96,6 +107,16 @@ namespace Orchestra
                             guildsConfig.WriteVariable({ variablePath, Logger::Format(properties.enableLogSentPackets), DataType::Bool, false });
                         }
 
+                        variablePath = Logger::Format(event.created->id, "/useNativeEqualizer");
+                        try
+                        {
+                            properties.useNativeEqualizer = guildsConfig.GetVariable(variablePath).GetValue<bool>();
+                        }
+                        catch(...)
+                        {
+                            guildsConfig.WriteVariable({ variablePath, Logger::Format(properties.useNativeEqualizer), DataType::Bool, false });
+                        }
+
                         variablePath = Logger::Format(event.created->id, "/commandsPrefix");
                         try
                         {
@@ -179,6 +200,23 @@ namespace Orchestra
             }
         );
 
+        //paces sending of audio instead of polling the voice client
+        on_voice_buffer_send(
+            [this](const dpp::voice_buffer_send_t& event)
+            {
+                if(!event.voice_client)
+                    return;
+
+                //on_guild_create may be inserting into the map on another thread
+                std::lock_guard guildLock{ m_GuildCreateMutex };
+
+                const auto found = m_GuildsBotInstances.find(event.voice_client->server_id);
+
+                if(found != m_GuildsBotInstances.end())
+                    found->second.player.player.OnVoiceBufferSent(event.voice_client->get_secs_remaining());
+            }
+        );
+
         ////TODO: is this necessary? - yes it is
         //on_ready(
         //    [this/*, commandPrefix, paramPrefix*/](const dpp::ready_t& readyEvent)
@@ -278,7 +316,8 @@ namespace Orchestra
                 ParamProperties{Type::Bool,   GetParamName("speed", "last")},
                 ParamProperties{Type::Int,    GetParamName("speed", "from")},
                 ParamProperties{Type::Int,    GetParamName("speed", "to")},
-                ParamProperties{Type::Int,    GetParamName("speed", "playlist")}
+                ParamProperties{Type::Int,    GetParamName("speed", "playlist")},
+                ParamProperties{Type::Bool,   GetParamName("speed", "keeppitch")}
             }
             });
         //bass
@@ -410,6 +449,14 @@ namespace Orchestra
             std::bind(&OrchestraDiscordBot::CommandTerminate, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3),
             {}
             });
+        //trace
+        AddCommand({ m_CommandsNamesConfig.GetVariable("trace").GetRawValue(),
+            std::bind(&OrchestraDiscordBot::CommandTrace, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3),
+            {
+                ParamProperties{Type::Bool,   GetParamName("trace", "all")},
+                ParamProperties{Type::Bool,   GetParamName("trace", "reset")}
+            }
+            });
     }
 
     void OrchestraDiscordBot::RegisterCommands()
@@ -433,8 +480,14 @@ namespace Orchestra
                         {
                             const size_t commandOffset = foundCommandPrefix.size();
 
+                            PlaybackTracer::Record(message.msg.guild_id, PlaybackTracer::Span::Delivery, std::max(std::chrono::system_clock::now() - GetSentTime(message.msg), std::chrono::system_clock::duration{ 0 }));
+
+                            const auto parsingBeginning = std::chrono::steady_clock::now();
+
                             ParsedCommandWithIndex parsedCommandWithIndex = ParseCommand(m_Commands, content, commandOffset, properties->paramsPrefix);
 
+                            PlaybackTracer::Record(message.msg.guild_id, PlaybackTracer::Span::Parse, std::chrono::steady_clock::now() - parsingBeginning);
+
                             properties.Unlock();
 
                             O_ASSERT(CommandChecker(message, parsedCommandWithIndex.parsedCommand), "The command check failed with user with ID ", message.msg.author.id);
@@ -453,7 +506,8 @@ namespace Orchestra
                                     GE_LOG(Orchestra, Info, "User with ID: ", message.msg.author.id, " \"", _parsedCommand.name, "\" command. Work with index ", index, " has just ended on ", std::this_thread::get_id(), " thread");
                                 },
                                 [message](const OrchestraException& oe) { message.reply(Logger::Format("**Exception:** ", oe.GetUserMessage())); },
-                                true);
+                                true,
+                                message.msg.guild_id);
 
                             m_WorkersManger.Work(id);
                         }
@@ -496,8 +550,14 @@ namespace Orchestra
                             {
                                 const size_t commandOffset = foundCommandPrefix.size();
 
+                                PlaybackTracer::Record(message.msg.guild_id, PlaybackTracer::Span::Delivery, std::max(std::chrono::system_clock::now() - GetSentTime(message.msg), std::chrono::system_clock::duration{ 0 }));
+
+                                const auto parsingBeginning = std::chrono::steady_clock::now();
+
                                 ParsedCommandWithIndex parsedCommandWithIndex = ParseCommand(m_Commands, content, commandOffset, properties->paramsPrefix);
 
+                                PlaybackTracer::Record(message.msg.guild_id, PlaybackTracer::Span::Parse, std::chrono::steady_clock::now() - parsingBeginning);
+
                                 properties.Unlock();
 
                                 O_ASSERT(CommandChecker(message, parsedCommandWithIndex.parsedCommand), "The command check failed with user with ID ", message.msg.author.id);
@@ -516,7 +576,8 @@ namespace Orchestra
                                         GE_LOG(Orchestra, Warning, "User with ID: ", message.msg.author.id, " \"", _parsedCommand.name, "\" command. Work with index ", index, " has just ended on ", std::this_thread::get_id(), " thread");
                                     },
                                     [message](const OrchestraException& oe) { message.reply(Logger::Format("**Exception:** ", oe.GetUserMessage())); },
-                                    true);
+                                    true,
+                                    message.msg.guild_id);
 
                                 m_WorkersManger.Work(id);
                             }
@@ -560,6 +621,16 @@ namespace Orchestra
                 botInstance.joinedCondition.wait_for(lock, std::chrono::milliseconds(10), [this, &botInstance] { return botInstance.isJoined == false; });
             }
 
+        try
+        {
+            if(PlaybackTracer::WriteToFile())
+                GE_LOG(Orchestra, Info, "The playback traces have been written to ", PlaybackTracer::GetFilePath().string(), '.');
+        }
+        catch(const OrchestraException& e)
+        {
+            GE_LOG(Orchestra, Warning, e.GetFullMessage());
+        }
+
         shutdown();
     }
 }
@@ -661,12 +732,16 @@ namespace Orchestra
                     searchEngine = StringToSearchEngine(playParams.searchEngine);
                 }
 
+                PlaybackTracer::ScopedSpan fetchSpan{ message.msg.guild_id, PlaybackTracer::Span::Fetch };
+
                 tracksQueue->FetchSearch(m_Paths.yt_dlpExecutablePath, value, searchEngine, playParams.speed, playParams.repeat, insertIndex, true);
             }
             else
             {
                 GetParamValue(params, GetParamName(commandName, "shuffle"), playParams.doShuffle);
 
+                PlaybackTracer::ScopedSpan fetchSpan{ message.msg.guild_id, PlaybackTracer::Span::Fetch };
+
                 tracksQueue->FetchURL(m_Paths.yt_dlpExecutablePath, value, m_RandomEngine, playParams.doShuffle, playParams.speed, static_cast<size_t>(playParams.repeat), insertIndex, true);
             }
         }
@@ -706,27 +781,26 @@ namespace Orchestra
         BotPlayer& botPlayer = GetBotPlayer(guildID);
 
         if(botPlayer.currentPlaylistIndex == std::numeric_limits<uint32_t>::max())
-        {
-            bool found = false;
-            for(size_t j = 0; j < tracksQueue->GetPlaylistsSize(); j++)
-            {
-                const PlaylistInfo& playlistInfo = tracksQueue->GetPlaylistInfos()[j];
+            botPlayer.currentPlaylistIndex = tracksQueue->FindPlaylistIndex(botPlayer.currentTrackIndex).value_or(std::numeric_limits<uint32_t>::max());
 
-                const bool isInRange = botPlayer.currentTrackIndex >= playlistInfo.beginIndex && botPlayer.currentTrackIndex <= playlistInfo.endIndex;
+        return botPlayer.currentPlaylistIndex;
+    }
+    size_t OrchestraDiscordBot::PredictNextTrackIndex(const TracksQueue* tracksQueue, size_t currentTrackIndex, size_t trackRepeated, size_t playlistRepeated, size_t prevPlaylistUniqueIndex)
+    {
+        //the end of a playlist ignores the repeat count of the track
+        if(const std::optional<size_t> playlistIndex = tracksQueue->FindPlaylistIndex(currentTrackIndex))
+        {
+            const PlaylistInfo& playlistInfo = tracksQueue->GetPlaylistInfo(playlistIndex.value());
 
-                if(isInRange)
-                {
-                    found = true;
-                    botPlayer.currentPlaylistIndex = j;
+            if(currentTrackIndex == playlistInfo.endIndex)
+            {
+                const size_t repeated = playlistInfo.uniqueIndex == prevPlaylistUniqueIndex ? playlistRepeated : 0;
 
-                    break;
-                }
+                return repeated + 1 >= playlistInfo.repeat ? currentTrackIndex + 1 : playlistInfo.beginIndex;
             }
-            if(!found)
-                botPlayer.currentPlaylistIndex = std::numeric_limits<uint32_t>::max();
         }
 
-        return botPlayer.currentPlaylistIndex;
+        return trackRepeated + 1 >= tracksQueue->GetTrackInfo(currentTrackIndex).repeat ? currentTrackIndex + 1 : currentTrackIndex;
     }
 
     void OrchestraDiscordBot::ReplyWithInfoAboutTrack(const dpp::snowflake& guildID, const dpp::message_create_t& message, const TrackInfo& trackInfo, bool outputURL, bool printCurrentTimestamp)
@@ -781,6 +855,11 @@ namespace Orchestra
         return GetBotInstance(guildID).player;
     }
 
+    std::chrono::system_clock::time_point OrchestraDiscordBot::GetSentTime(const dpp::message& message)
+    {
+        return std::chrono::system_clock::time_point{ std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::duration<double>(message.id.get_creation_time())) };
+    }
+
     std::string OrchestraDiscordBot::GetRawVariableValue(const GuelderResourcesManager::ConfigFile& configFile, const std::string_view& path)
     {
         return configFile.GetVariable(path).GetRawValue();
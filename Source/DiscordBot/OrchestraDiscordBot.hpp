@@ -9,6 +9,7 @@
 
 #include "DiscordBot.hpp"
 #include "OrchestraDiscordBotInstance.hpp"
+#include "PlaybackScheduler.hpp"
 #include "Yt_DlpManager.hpp"
 #include "TracksQueue.hpp"
 
@@ -63,8 +64,12 @@ namespace Orchestra
         void CommandSkip(const dpp::message_create_t& message, const std::vector<Param>& params, const std::string_view& value);
         void CommandLeave(const dpp::message_create_t& message, const std::vector<Param>& params, const std::string_view& value);
         void CommandTerminate(const dpp::message_create_t& message, const std::vector<Param>& params, const std::string_view& value);
+        void CommandTrace(const dpp::message_create_t& message, const std::vector<Param>& params, const std::string_view& value);
 
     private:
+        //the part of CommandPlay, which plays the queue until it ends, it runs on a thread of m_PlaybackScheduler
+        void PlayQueue(const dpp::message_create_t& message, const std::vector<Param>& params);
+
         static void ConnectToMemberVoice(const dpp::message_create_t& message);
 
         void WaitUntilJoined(const dpp::snowflake& guildID, const std::chrono::milliseconds& delay);
@@ -92,11 +97,16 @@ namespace Orchestra
         void SendEmbedsSequentially(const dpp::message_create_t& event, const std::vector<dpp::embed>& embeds, size_t index = 0);
 
         uint32_t GetCurrentPlaylistIndex(const dpp::snowflake& guildID, const TracksQueue* tracksQueue);
+        //the index of a track which will be played after currentTrackIndex if nothing is skipped, repeat counters are the same as in CommandPlay
+        static size_t PredictNextTrackIndex(const TracksQueue* tracksQueue, size_t currentTrackIndex, size_t trackRepeated, size_t playlistRepeated, size_t prevPlaylistUniqueIndex);
         void ReplyWithInfoAboutTrack(const dpp::snowflake& guildID, const dpp::message_create_t& message, const TrackInfo& trackInfo, bool outputURL = true, bool printCurrentTimestamp = false);
 
         BotInstance& GetBotInstance(const dpp::snowflake& guildID);
         BotPlayer& GetBotPlayer(const dpp::snowflake& guildID);
 
+        //the time discord has given to the message, it is taken from the message's id
+        static std::chrono::system_clock::time_point GetSentTime(const dpp::message& message);
+
         static std::string GetRawVariableValue(const GuelderResourcesManager::ConfigFile& configFile, const std::string_view& path);
         std::string GetParamName(const std::string_view& commandName, const std::string_view& paramName) const;
 
@@ -108,6 +118,7 @@ namespace Orchestra
     private:
         //first - guild id, second is BotInstance
         std::unordered_map<dpp::snowflake, BotInstance> m_GuildsBotInstances;
+        //guards the insertions into m_GuildsBotInstances and the lookups from the voice thread
         std::mutex m_GuildCreateMutex;
 
         dpp::snowflake m_BossSnowflake;
@@ -122,5 +133,8 @@ namespace Orchestra
         GuelderResourcesManager::ConfigFile m_CommandsNamesConfig;
 
         std::mutex m_HistoryLogMutex;
+
+        //declared last, so playbacks are joined before the guilds' instances are destroyed
+        PlaybackScheduler m_PlaybackScheduler;
     };
 }
\ No newline at end of file
@@ -10,6 +10,11 @@
 #include <GuelderConsoleLogMacroses.hpp>
 
 #include "OrchestraDiscordBotInstance.hpp"
+#include "RawURLCache.hpp"
+#include "AudioCache.hpp"
+#include "Yt_DlpWorkerPool.hpp"
+#include "DiscordVoiceSink.hpp"
+#include "../Diagnostics/PlaybackTracer.hpp"
 
 //commands
 namespace Orchestra
@@ -146,9 +151,11 @@ namespace Orchestra
         constexpr std::string_view commandName = "current";
 
         BotPlayer& botPlayer = GetBotPlayer(message.msg.guild_id);
-        auto tracksQueue = botPlayer.AccessBinarySemaphoreTracksQueue();
+        //doesn't wait for the playback, which can hold the queue while yt-dlp works
+        const auto tracksQueue = botPlayer.GetTracksQueueSnapshot();
+        const size_t currentTrackIndex = botPlayer.currentTrackIndex;
 
-        if(!tracksQueue->GetTracksSize())
+        if(currentTrackIndex >= tracksQueue->GetTracksSize())
         {
             Reply(message, "I'm not even playing anything!");
             return;
@@ -157,7 +164,7 @@ namespace Orchestra
         bool showURL = false;
         GetParamValue(params, GetParamName(commandName, "url"), showURL);
 
-        ReplyWithInfoAboutTrack(message.msg.guild_id, message, tracksQueue->GetTrackInfo(botPlayer.currentTrackIndex), showURL, true);
+        ReplyWithInfoAboutTrack(message.msg.guild_id, message, tracksQueue->GetTrackInfo(currentTrackIndex), showURL, true);
     }
     void OrchestraDiscordBot::CommandQueue(const dpp::message_create_t& message, const std::vector<Param>& params, const std::string_view& value)
     {
@@ -166,7 +173,8 @@ namespace Orchestra
         dpp::voiceconn* voice = IsVoiceConnectionReady(message.msg.guild_id);
 
         BotPlayer& botPlayer = GetBotPlayer(message.msg.guild_id);
-        auto tracksQueue = botPlayer.AccessBinarySemaphoreTracksQueue();
+        //doesn't wait for the playback, which can hold the queue while yt-dlp works
+        const auto tracksQueue = botPlayer.GetTracksQueueSnapshot();
 
         O_ASSERT(tracksQueue->GetTracksSize() > 0, "The queue is empty!");
 
@@ -226,7 +234,7 @@ namespace Orchestra
                     embed.add_field(playlistBeginField, "");
                 }
 
-                const auto& [URL, rawURL, title, duration, playlistIndex, repeat, speed] = tracksQueue->GetTrackInfo(trackIndex);
+                const auto& [URL, rawURL, title, duration, playlistIndex, repeat, speed, formatHints] = tracksQueue->GetTrackInfo(trackIndex);
 
                 std::string fieldTitle;
 
@@ -298,6 +306,10 @@ namespace Orchestra
 
         const size_t tracksNumberBefore = tracksQueue->GetTracksSize();
 
+        //the playback is started by this command, so its first audio is traced
+        if(!tracksNumberBefore)
+            PlaybackTracer::Begin(message.msg.guild_id, GetSentTime(message.msg));
+
         AddToQueue(*tracksQueue, commandName, message, params, value.data());
 
         //tracksQueue.Unlock();
@@ -305,6 +317,44 @@ namespace Orchestra
         if(tracksNumberBefore)
             return;
 
+        tracksQueue.Unlock();
+
+        //the queue is played on its own thread, so the command returns right away and does not hold the guild's lane
+        m_PlaybackScheduler.Start(message.msg.guild_id, [this, message, _params = params](std::stop_token stopToken)
+            {
+                BotPlayer& botPlayer = GetBotPlayer(message.msg.guild_id);
+
+                //the bot is being destroyed, it is stopped like CommandStop does it
+                std::stop_callback stopPlayback{ stopToken, [&botPlayer]
+                    {
+                        botPlayer.player.Stop();
+                        botPlayer.isStopped = true;
+                        botPlayer.gettingRawURLCondition.notify_all();
+                    } };
+
+                try
+                {
+                    PlayQueue(message, _params);
+                }
+                catch(const OrchestraException& e)
+                {
+                    GE_LOG(Orchestra, Error, "Playback of guild ", message.msg.guild_id, " has ended with an exception: ", e.GetFullMessage());
+                    message.reply(Logger::Format("**Exception:** ", e.GetUserMessage()));
+                }
+                catch(const std::exception& e)
+                {
+                    GE_LOG(Orchestra, Error, "Playback of guild ", message.msg.guild_id, " has ended with an exception: ", e.what());
+                }
+            });
+    }
+    void OrchestraDiscordBot::PlayQueue(const dpp::message_create_t& message, const std::vector<Param>& params)
+    {
+        constexpr std::string_view commandName = "play";
+
+        BotPlayer& botPlayer = GetBotPlayer(message.msg.guild_id);
+
+        auto tracksQueue = botPlayer.AccessBinarySemaphoreTracksQueue();
+
         int beginIndex = 0;
         GetParamValue(params, GetParamName(commandName, "index"), beginIndex);
         botPlayer.currentTrackIndex = beginIndex;
@@ -358,10 +408,24 @@ namespace Orchestra
 
             botPlayer.hasRawURLRetrievingCompleted = false;
 
+            //resolves the raw url of the next track and opens its decoder while the current one is playing
+            std::jthread prefetchThread;
+
             for(size_t i = 0, playlistRepeated = 0, trackRepeated = 0; true; ++i)
             {
                 const TrackInfo* currentTrackInfo = nullptr;
 
+                //the prefetching may also be setting the raw url of the current track
+                if(prefetchThread.joinable())
+                {
+                    if(*tracksQueue)
+                        tracksQueue.Unlock();
+
+                    prefetchThread.join();
+
+                    tracksQueue = botPlayer.AccessBinarySemaphoreTracksQueue();
+                }
+
                 bool caughtException = false;
                 try
                 {
@@ -371,36 +435,90 @@ namespace Orchestra
                         break;
 
                     size_t indexToSetRawURL = botPlayer.currentTrackIndex;
-                    currentTrackInfo = &tracksQueue->GetTrackInfos()[botPlayer.currentTrackIndex];
+                    currentTrackInfo = &tracksQueue->GetTrackInfo(botPlayer.currentTrackIndex);
 
                     prevUniqueTrackIndex = currentTrackInfo->uniqueIndex;
 
-                    //this if is the shittiest in the entire solution
+                    //the track could have been waiting in the queue for longer than its raw url lives
+                    if(!currentTrackInfo->URL.empty() && RawURLCache::HasRawURLExpired(currentTrackInfo->rawURL))
+                        tracksQueue->SetTrackRawURL(indexToSetRawURL, "");
+
                     if(currentTrackInfo->rawURL.empty())
+                        if(auto cached = RawURLCache::Find(currentTrackInfo->URL))
+                            tracksQueue->SetTrackRawURL(indexToSetRawURL, std::move(cached->rawURL), std::move(cached->formatHints));
+
+                    //a cached track is played from the disk, so it doesn't need a raw url at all
+                    const std::string audioCacheKey = AudioCache::MakeKey(currentTrackInfo->URL);
+                    const bool isAudioCached = AudioCache::Contains(audioCacheKey);
+
+                    //this if is the shittiest in the entire solution
+                    if(!isAudioCached && currentTrackInfo->rawURL.empty())
                     {
+                        const auto rawURLBeginning = std::chrono::steady_clock::now();
+
                         bool receivedRawURL = false;
+                        bool rethrow = false;
 
-                        auto processReadInfo = Yt_DlpManager::StartGetRawURLFromURL(m_Paths.yt_dlpExecutablePath, currentTrackInfo->URL);
+                        //a yt-dlp worker is killed through the stop token of the thread, yt-dlp executable with TerminateProcess
+                        const bool useWorkerPool = Yt_DlpWorkerPool::IsRunning();
 
-                        bool rethrow = false;
+                        std::optional<GuelderResourcesManager::ResourcesManager::ProcessReadInfo> processReadInfo;
+
+                        if(!useWorkerPool)
+                            processReadInfo = Yt_DlpManager::StartGetRawURLFromURL(m_Paths.yt_dlpExecutablePath, currentTrackInfo->URL);
 
-                        std::jthread gettingRawURLThread{ [&]
+                        std::jthread gettingRawURLThread{ [&, url = currentTrackInfo->URL](std::stop_token stopToken)
                         {
+                            std::optional<std::string> rawURL;
+
                             //a long one
-                            auto result = Yt_DlpManager::FinishGetRawURLFromURL(processReadInfo);
+                            if(useWorkerPool)
+                            {
+                                try
+                                {
+                                    rawURL = Yt_DlpWorkerPool::RequestRawURL(url, stopToken);
+                                }
+                                catch(const OrchestraException& e)
+                                {
+                                    if(!stopToken.stop_requested())
+                                    {
+                                        GE_LOG(Orchestra, Warning, e.GetFullMessage());
+
+                                        {
+                                            std::lock_guard lock{ botPlayer.gettingRawURLMutex };
+                                            rethrow = true;
+                                        }
+
+                                        botPlayer.gettingRawURLCondition.notify_all();
+                                    }
+                                }
+                            }
+                            else
+                            {
+                                auto result = Yt_DlpManager::FinishGetRawURLFromURL(processReadInfo.value());
 
-                            if(result.has_value())
+                                if(result.has_value())
+                                    rawURL = std::move(result.value()[0]);
+                            }
+
+                            if(rawURL.has_value())
                             {
                                 tracksQueue = botPlayer.AccessBinarySemaphoreTracksQueue();
 
-                                auto found = std::ranges::find_if(tracksQueue->GetTrackInfos(), [&prevUniqueTrackIndex](const TrackInfo& info) { return info.uniqueIndex == prevUniqueTrackIndex; });
-                                O_ASSERT(found != tracksQueue->GetTrackInfos().end(), "Failed to find a track with unique index ", prevUniqueTrackIndex, ", which would have received a raw url.");
+                                const auto foundIndex = tracksQueue->FindTrackIndex(prevUniqueTrackIndex);
+                                O_ASSERT(foundIndex.has_value(), "Failed to find a track with unique index ", prevUniqueTrackIndex, ", which would have received a raw url.");
+
+                                RawURLCache::Insert(tracksQueue->GetTrackInfo(foundIndex.value()).URL, rawURL.value());
 
-                                tracksQueue->SetTrackRawURL(found - tracksQueue->GetTrackInfos().begin(),std::move(result.value()[0]));
+                                tracksQueue->SetTrackRawURL(foundIndex.value(), std::move(rawURL.value()));
 
-                                GE_LOG(Orchestra, Warning, tracksQueue->GetTrackInfo(found - tracksQueue->GetTrackInfos().begin()).rawURL);
+                                GE_LOG(Orchestra, Warning, tracksQueue->GetTrackInfo(foundIndex.value()).rawURL);
 
-                                receivedRawURL = true;
+                                //under the mutex, so the notification is not lost if it comes before the wait
+                                {
+                                    std::lock_guard lock{ botPlayer.gettingRawURLMutex };
+                                    receivedRawURL = true;
+                                }
 
                                 //tracksQueue.Unlock();
 
@@ -410,7 +528,11 @@ namespace Orchestra
 
                         tracksQueue.Unlock();
                         std::unique_lock lock{ botPlayer.gettingRawURLMutex };
-                        botPlayer.gettingRawURLCondition.wait(lock);
+
+                        if(!receivedRawURL && !rethrow)
+                            botPlayer.gettingRawURLCondition.wait(lock);
+
+                        lock.unlock();
 
                         //if(!*tracksQueue)
                             tracksQueue = botPlayer.AccessBinarySemaphoreTracksQueue();
@@ -418,18 +540,75 @@ namespace Orchestra
                         if(rethrow)
                             O_THROW("Failed to get raw track URL.");
 
+                        if(receivedRawURL)
+                            PlaybackTracer::Record(message.msg.guild_id, PlaybackTracer::Span::RawURL, std::chrono::steady_clock::now() - rawURLBeginning);
+
                         if(!receivedRawURL)
                         {
                             GE_LOG(Orchestra, Warning, "TERMINATING");
-                            processReadInfo.processInfo.TerminateProcess();
+
+                            if(useWorkerPool)
+                                gettingRawURLThread.request_stop();
+                            else
+                                processReadInfo.value().processInfo.TerminateProcess();
+
                             decodeCurrentTrack = false;
                         }
                     }
 
-                    if(decodeCurrentTrack)
+                    if(decodeCurrentTrack && !botPlayer.player.SetPrefetchedDecoder(currentTrackInfo->uniqueIndex, currentTrackInfo->speed))
                     {
-                        botPlayer.player.SetDecoder(currentTrackInfo->rawURL, Decoder::DEFAULT_SAMPLE_RATE / currentTrackInfo->speed);
+                        const auto cachedAudioPath = isAudioCached ? AudioCache::Find(audioCacheKey) : std::nullopt;
+                        const std::string url = cachedAudioPath ? cachedAudioPath->string() : currentTrackInfo->rawURL;
+                        const AudioFormatHints formatHints = cachedAudioPath ? AudioFormatHints{} : currentTrackInfo->formatHints;
+                        const float speed = currentTrackInfo->speed;
+                        const std::string webpageURL = currentTrackInfo->URL;
 
+                        //opening can take a while, so the queue is released, otherwise skip, stop and leave would wait for it instead of cancelling it
+                        tracksQueue.Unlock();
+
+                        bool hasOpened;
+                        std::optional<std::string> resolvedAgainRawURL;
+
+                        try
+                        {
+                            hasOpened = botPlayer.player.SetDecoder(url, speed, audioCacheKey, formatHints);
+                        }
+                        catch(const OrchestraException& e)
+                        {
+                            //a file of the audio cache or a raw url, which has been played as it is, cannot be resolved again
+                            if(cachedAudioPath || webpageURL.empty())
+                                throw;
+
+                            GE_LOG(Orchestra, Warning, "Failed to open the raw url of ", webpageURL, ", resolving it once again. Exception: ", e.GetFullMessage());
+
+                            //the raw url could have been revoked before it expired, so the cache must not serve it again
+                            RawURLCache::Erase(webpageURL);
+
+                            //a long one
+                            resolvedAgainRawURL = Yt_DlpManager::GetRawURLFromURL(m_Paths.yt_dlpExecutablePath, webpageURL);
+
+                            hasOpened = botPlayer.player.SetDecoder(resolvedAgainRawURL.value(), speed, audioCacheKey);
+                        }
+
+                        tracksQueue = botPlayer.AccessBinarySemaphoreTracksQueue();
+
+                        if(resolvedAgainRawURL)
+                            if(const auto foundIndex = tracksQueue->FindTrackIndex(prevUniqueTrackIndex))
+                                tracksQueue->SetTrackRawURL(foundIndex.value(), std::move(resolvedAgainRawURL.value()));
+
+                        //the queue could have been changed meanwhile
+                        if(!hasOpened || botPlayer.currentTrackIndex >= tracksQueue->GetTracksSize() || tracksQueue->GetTrackInfo(botPlayer.currentTrackIndex).uniqueIndex != prevUniqueTrackIndex)
+                            decodeCurrentTrack = false;
+                        else
+                        {
+                            indexToSetRawURL = botPlayer.currentTrackIndex;
+                            currentTrackInfo = &tracksQueue->GetTrackInfo(botPlayer.currentTrackIndex);
+                        }
+                    }
+
+                    if(decodeCurrentTrack)
+                    {
                         //printing info about the track
                         if(!noInfo)
                         {
@@ -460,11 +639,99 @@ namespace Orchestra
                             ReplyWithInfoAboutTrack(message.msg.guild_id, message, tmp);
                         }
 
+                        const size_t nextTrackIndex = PredictNextTrackIndex(*tracksQueue, botPlayer.currentTrackIndex, trackRepeated, playlistRepeated, prevPlaylistIndex);
+
+                        if(nextTrackIndex < tracksQueue->GetTracksSize())
+                        {
+                            prefetchThread = std::jthread{ [this, &botPlayer, nextTrackInfo = tracksQueue->GetTrackInfo(nextTrackIndex)](std::stop_token stopToken)
+                            {
+                                try
+                                {
+                                    const std::string audioCacheKey = AudioCache::MakeKey(nextTrackInfo.URL);
+
+                                    if(const auto cachedAudioPath = AudioCache::Find(audioCacheKey))
+                                    {
+                                        botPlayer.player.Prefetch(nextTrackInfo.uniqueIndex, cachedAudioPath->string(), "", {}, stopToken);
+                                        return;
+                                    }
+
+                                    std::string rawURL = nextTrackInfo.rawURL;
+
+                                    if(rawURL.empty() || (!nextTrackInfo.URL.empty() && RawURLCache::HasRawURLExpired(rawURL)))
+                                    {
+                                        //a long one
+                                        rawURL = Yt_DlpManager::GetRawURLFromURL(m_Paths.yt_dlpExecutablePath, nextTrackInfo.URL, stopToken);
+
+                                        if(stopToken.stop_requested())
+                                            return;
+
+                                        auto tracksQueue = botPlayer.AccessBinarySemaphoreTracksQueue();
+
+                                        const auto foundIndex = tracksQueue->FindTrackIndex(nextTrackInfo.uniqueIndex);
+
+                                        if(foundIndex.has_value() && tracksQueue->GetTrackInfo(foundIndex.value()).rawURL == nextTrackInfo.rawURL)
+                                            tracksQueue->SetTrackRawURL(foundIndex.value(), rawURL);
+                                    }
+
+                                    //the hints describe only the raw url they have come with
+                                    botPlayer.player.Prefetch(nextTrackInfo.uniqueIndex, rawURL, audioCacheKey, rawURL == nextTrackInfo.rawURL ? nextTrackInfo.formatHints : AudioFormatHints{}, stopToken);
+                                }
+                                catch(const OrchestraException& e)
+                                {
+                                    if(stopToken.stop_requested())
+                                    {
+                                        GE_LOG(Orchestra, Info, "Prefetching of the next track has been cancelled.");
+                                    }
+                                    else
+                                    {
+                                        GE_LOG(Orchestra, Warning, "Failed to prefetch the next track. Exception: ", e.GetFullMessage());
+                                    }
+                                }
+                                catch(const std::exception& e)
+                                {
+                                    GE_LOG(Orchestra, Warning, "Failed to prefetch the next track. Exception: ", e.what());
+                                }
+                            } };
+                        }
+
+                        //the next track is resolved by the prefetch, the ones after it in the background
+                        {
+                            std::vector<RawURLResolver::Request> requests;
+                            requests.reserve(RawURLResolver::RESOLVED_AHEAD_TRACKS_COUNT);
+
+                            for(size_t i = botPlayer.currentTrackIndex + 1; i < tracksQueue->GetTracksSize() && requests.size() < RawURLResolver::RESOLVED_AHEAD_TRACKS_COUNT; i++)
+                            {
+                                const TrackInfo& trackInfo = tracksQueue->GetTrackInfo(i);
+
+                                if(i == nextTrackIndex || !trackInfo.HasURL())
+                                    continue;
+
+                                if(trackInfo.rawURL.empty() || RawURLCache::HasRawURLExpired(trackInfo.rawURL))
+                                    requests.emplace_back(trackInfo.uniqueIndex, trackInfo.URL);
+                            }
+
+                            botPlayer.rawURLResolver.Resolve(m_Paths.yt_dlpExecutablePath, std::move(requests), [&botPlayer](size_t uniqueIndex, std::string rawURL)
+                                {
+                                    auto tracksQueue = botPlayer.AccessBinarySemaphoreTracksQueue();
+
+                                    const auto foundIndex = tracksQueue->FindTrackIndex(uniqueIndex);
+
+                                    if(!foundIndex.has_value())
+                                        return;
+
+                                    const std::string& currentRawURL = tracksQueue->GetTrackInfo(foundIndex.value()).rawURL;
+
+                                    if(currentRawURL.empty() || RawURLCache::HasRawURLExpired(currentRawURL))
+                                        tracksQueue->SetTrackRawURL(foundIndex.value(), std::move(rawURL));
+                                });
+                        }
+
                         tracksQueue.Unlock();
 
                         //GE_LOG(Orchestra, Error, "\tPLAY DECODING", indexToSetRawURL);
 
-                        botPlayer.player.DecodeAndSendAudio(voice);
+                        DiscordVoiceSink voiceSink{ *voice->voiceclient };
+                        botPlayer.player.DecodeAndSendAudio(voiceSink);
                     }
                     //else
                         //tracksQueue.Unlock();
@@ -487,6 +754,10 @@ namespace Orchestra
 
                 if(caughtException)
                 {
+                    //the exception could have been thrown while the queue was released
+                    if(!*tracksQueue)
+                        tracksQueue = botPlayer.AccessBinarySemaphoreTracksQueue();
+
                     //haven't tested this
                     tracksQueue->DeleteTrack(botPlayer.currentTrackIndex);
                     continue;
@@ -498,7 +769,7 @@ namespace Orchestra
                 if(botPlayer.currentTrackIndex >= tracksQueue->GetTracksSize())
                     break;
 
-                currentTrackInfo = &tracksQueue->GetTrackInfos()[botPlayer.currentTrackIndex];
+                currentTrackInfo = &tracksQueue->GetTrackInfo(botPlayer.currentTrackIndex);
 
                 const bool wasTrackSkipped = prevUniqueTrackIndex != currentTrackInfo->uniqueIndex;
                 bool incrementCurrentIndex = !wasTrackSkipped;
@@ -506,30 +777,20 @@ namespace Orchestra
                 if(!wasTrackSkipped)
                     trackRepeated++;
 
-                bool found = false;
-                for(size_t j = 0; j < tracksQueue->GetPlaylistsSize(); j++)
-                {
-                    const PlaylistInfo& playlistInfo = tracksQueue->GetPlaylistInfos()[j];
-
-                    const bool isInRange = botPlayer.currentTrackIndex >= playlistInfo.beginIndex && botPlayer.currentTrackIndex <= playlistInfo.endIndex;
+                const std::optional<size_t> playlistIndex = tracksQueue->FindPlaylistIndex(botPlayer.currentTrackIndex);
 
-                    if(isInRange)
-                    {
-                        currentPlaylistInfo = &playlistInfo;
-                        isInPlaylist = true;
-                        playlistRepeat = playlistInfo.repeat;
-                        found = true;
-
-                        if(prevPlaylistIndex != currentPlaylistInfo->uniqueIndex)
-                            playlistRepeated = 0;
+                if(playlistIndex.has_value())
+                {
+                    currentPlaylistInfo = &tracksQueue->GetPlaylistInfo(playlistIndex.value());
+                    isInPlaylist = true;
+                    playlistRepeat = currentPlaylistInfo->repeat;
 
-                        botPlayer.currentPlaylistIndex = j;
+                    if(prevPlaylistIndex != currentPlaylistInfo->uniqueIndex)
+                        playlistRepeated = 0;
 
-                        break;
-                    }
+                    botPlayer.currentPlaylistIndex = playlistIndex.value();
                 }
-
-                if(!found)
+                else
                 {
                     isInPlaylist = false;
                     currentPlaylistInfo = nullptr;
@@ -576,6 +837,21 @@ namespace Orchestra
                 }
             }
 
+            if(prefetchThread.joinable())
+            {
+                if(*tracksQueue)
+                    tracksQueue.Unlock();
+
+                //its yt-dlp request or opening is cancelled, so the join doesn't wait for them
+                prefetchThread.request_stop();
+                prefetchThread.join();
+
+                tracksQueue = botPlayer.AccessBinarySemaphoreTracksQueue();
+            }
+
+            botPlayer.player.CancelPrefetch();
+            botPlayer.rawURLResolver.Cancel();
+
             tracksQueue->Clear();
 
             botPlayer.currentTrackIndex = 0;
@@ -629,11 +905,10 @@ namespace Orchestra
             O_ASSERT(from < to && to < tracksQueue->GetTracksSize(), "Invalid start or end indicies.");
             O_ASSERT(speed > 0.f, "Invalid speed value.");
 
-            for(size_t i = from; i <= to; i++)
-                tracksQueue->SetTrackSpeed(i, speed);
+            tracksQueue->SetTracksSpeed(from, to, speed);
 
             if(botPlayer.currentTrackIndex >= from && botPlayer.currentTrackIndex <= to)
-                botPlayer.player.SetAudioSampleRate(Decoder::DEFAULT_SAMPLE_RATE * speed);
+                botPlayer.player.SetSpeed(speed);
 
             tracksQueue->AddPlaylist(from, to, speed, repeat, (name));
         }
@@ -663,6 +938,16 @@ namespace Orchestra
 
         O_ASSERT(speed > 0.f, "Invalid speed value");
 
+        //is global, like bass or equalizer
+        bool preservePitch = botPlayer.player.GetPreservePitch();
+        GetParamValue(params, GetParamName(commandName, "keeppitch"), preservePitch);
+
+        if(preservePitch)
+            O_ASSERT(speed >= AudioFilterGraph::MIN_PITCH_PRESERVING_SPEED && speed <= AudioFilterGraph::MAX_PITCH_PRESERVING_SPEED, "The speed with preserved pitch must be between ", AudioFilterGraph::MIN_PITCH_PRESERVING_SPEED, " and ", AudioFilterGraph::MAX_PITCH_PRESERVING_SPEED, '.');
+
+        if(preservePitch != botPlayer.player.GetPreservePitch())
+            botPlayer.player.SetPreservePitch(preservePitch);
+
         const int fromParamIndex = GetParamIndex(params, GetParamName(commandName, "from"));
         int from = 0;
         if(fromParamIndex != -1)
@@ -702,11 +987,10 @@ namespace Orchestra
                 O_ASSERT(botPlayer.player.IsDecoderReady(), "The Decoder is not ready.");
 
                 if(tracksQueue->GetTrackInfo(botPlayer.currentTrackIndex).speed != speed)
-                    botPlayer.player.SetAudioSampleRate(Decoder::DEFAULT_SAMPLE_RATE / speed);
+                    botPlayer.player.SetSpeed(speed);
             }
 
-            for(int i = from; i <= to; i++)
-                tracksQueue->SetTrackSpeed(i, speed);
+            tracksQueue->SetTracksSpeed(from, to, speed);
         }
         else
         {
@@ -736,7 +1020,7 @@ namespace Orchestra
                 O_ASSERT(botPlayer.player.IsDecoderReady(), "The Decoder is not ready.");
 
                 if(tracksQueue->GetTrackInfo(botPlayer.currentTrackIndex).speed != speed)
-                    botPlayer.player.SetAudioSampleRate(Decoder::DEFAULT_SAMPLE_RATE / speed);
+                    botPlayer.player.SetSpeed(speed);
             }
 
             tracksQueue->SetTrackSpeed(index, speed);
@@ -903,8 +1187,7 @@ namespace Orchestra
             O_ASSERT(from >= 0 && from < to && to < tracksQueue->GetTracksSize(), "\"from or \"to\" is outside of the range.");
 
             if(playlistParamIndex == -1)
-                for(int i = from; i <= to; i++)
-                    tracksQueue->SetTrackRepeatCount(i, repeatCount);
+                tracksQueue->SetTracksRepeatCount(from, to, repeatCount);
             else
                 tracksQueue->SetPlaylistRepeatCount(playlistIndex, repeatCount);
         }
@@ -1309,20 +1592,11 @@ namespace Orchestra
 
         if(skipPlaylist)
         {
-            bool found = false;
-            for(const auto& playlistInfo : tracksQueue->GetPlaylistInfos())
-            {
-                const bool isInRange = botPlayer.currentTrackIndex >= playlistInfo.beginIndex && botPlayer.currentTrackIndex <= playlistInfo.endIndex;
+            const std::optional<size_t> playlistIndex = tracksQueue->FindPlaylistIndex(botPlayer.currentTrackIndex);
 
-                if(isInRange)
-                {
-                    skipToIndex = playlistInfo.endIndex + 1;
-                    found = true;
-                    break;
-                }
-            }
+            O_ASSERT(playlistIndex.has_value(), "Current track is not in a playlist.");
 
-            O_ASSERT(found, "Current track is not in a playlist.");
+            skipToIndex = tracksQueue->GetPlaylistInfo(playlistIndex.value()).endIndex + 1;
         }
         else if(toindex != -1)
         {
@@ -1361,6 +1635,8 @@ namespace Orchestra
         {
             botPlayer.currentTrackIndex = skipToIndex;
             botPlayer.gettingRawURLCondition.notify_all();
+            //the track may be still opening, in which case the decoder isn't ready and Skip isn't called
+            botPlayer.player.CancelOpening();
         }
         if(skip)
         {
@@ -1398,4 +1674,36 @@ namespace Orchestra
         else
             Reply(message, "You are not The Boss!");
     }
+    void OrchestraDiscordBot::CommandTrace(const dpp::message_create_t& message, const std::vector<Param>& params, const std::string_view& value)
+    {
+        constexpr std::string_view commandName = "trace";
+
+        const bool isBoss = m_BossSnowflake != 0 && message.msg.author.id == m_BossSnowflake;
+
+        O_ASSERT(isBoss || message.msg.author.id == GetBotInstance(message.msg.guild_id).AccessBinarySemaphoreOrchestraDiscordBotInstanceProperties()->adminSnowflake, "Only the admin can see the playback traces.");
+
+        bool all = false;
+        bool reset = false;
+
+        GetParamValue(params, GetParamName(commandName, "all"), all);
+        GetParamValue(params, GetParamName(commandName, "reset"), reset);
+
+        O_ASSERT(!all || isBoss, "Only the boss can see the playback traces of all guilds.");
+
+        const std::string traces = PlaybackTracer::Format(all ? PlaybackTracer::GetTotalHistograms() : PlaybackTracer::GetHistograms(message.msg.guild_id));
+
+        try
+        {
+            PlaybackTracer::WriteToFile();
+        }
+        catch(const OrchestraException& e)
+        {
+            GE_LOG(Orchestra, Warning, e.GetFullMessage());
+        }
+
+        if(reset)
+            PlaybackTracer::Reset(message.msg.guild_id);
+
+        Reply(message, all ? "**Playback traces of all guilds:**\n" : "**Playback traces:**\n", traces);
+    }
 }
\ No newline at end of file
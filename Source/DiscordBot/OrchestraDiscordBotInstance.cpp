@@ -8,8 +8,8 @@
 //BotPlayer
 namespace Orchestra
 {
-    OrchestraDiscordBotPlayer::OrchestraDiscordBotPlayer(uint32_t sentPacketsSize, bool enableLogSentPackets)
-        : player(sentPacketsSize, enableLogSentPackets), currentPlaylistIndex(std::numeric_limits<uint32_t>::max()) {}
+    OrchestraDiscordBotPlayer::OrchestraDiscordBotPlayer(uint32_t sentPacketsSize, uint32_t decodeAheadBufferSize, bool enableLogSentPackets, bool useNativeEqualizer)
+        : player(sentPacketsSize, decodeAheadBufferSize, enableLogSentPackets, useNativeEqualizer), currentPlaylistIndex(std::numeric_limits<uint32_t>::max()) {}
 
     OrchestraDiscordBotPlayer::OrchestraDiscordBotPlayer(const OrchestraDiscordBotPlayer& other)
     {
@@ -31,6 +31,11 @@ namespace Orchestra
 
         return *this;
     }
+    std::shared_ptr<const TracksQueueSnapshot> OrchestraDiscordBotPlayer::GetTracksQueueSnapshot() const
+    {
+        return m_TracksQueue.GetSnapshot();
+    }
+
     void OrchestraDiscordBotPlayer::CopyFrom(const OrchestraDiscordBotPlayer& other)
     {
         player = other.player;
@@ -54,7 +59,7 @@ namespace Orchestra
 namespace Orchestra
 {
     OrchestraDiscordBotInstance::OrchestraDiscordBotInstance(FullOrchestraDiscordBotInstanceProperties properties)
-        : player(properties.sentPacketsSize, properties.enableLogSentPackets), m_Properties(std::move(properties.properties)) {
+        : player(properties.sentPacketsSize, properties.decodeAheadBufferSize, properties.enableLogSentPackets, properties.useNativeEqualizer), m_Properties(std::move(properties.properties)) {
     }
     OrchestraDiscordBotInstance::OrchestraDiscordBotInstance(const OrchestraDiscordBotInstance& other)
     {
@@ -9,6 +9,7 @@
 
 #include "../Utils.hpp"
 #include "Player.hpp"
+#include "RawURLResolver.hpp"
 #include "TracksQueue.hpp"
 
 namespace Orchestra
@@ -23,7 +24,11 @@ namespace Orchestra
     struct FullOrchestraDiscordBotInstanceProperties
     {
         uint32_t sentPacketsSize = 200000;
+        //how many bytes of PCM can be decoded ahead of the voice client
+        uint32_t decodeAheadBufferSize = 2000000;
         bool enableLogSentPackets = false;
+        //bass boost and equalizer are done by in-house biquads instead of libavfilter
+        bool useNativeEqualizer = false;
 
         OrchestraDiscordBotInstanceProperties properties = {};
     };
@@ -41,13 +46,16 @@ namespace Orchestra
     public:
         O_DEFINE_STRUCT_GUARD_BINARY_SEMAPHORE_GETTER(TracksQueue, &m_TracksQueue, &m_TracksQueueBinarySemaphore)
     public:
-        OrchestraDiscordBotPlayer(uint32_t sentPacketsSize = 0, bool enableLogSentPackets = false);
+        OrchestraDiscordBotPlayer(uint32_t sentPacketsSize = 0, uint32_t decodeAheadBufferSize = 0, bool enableLogSentPackets = false, bool useNativeEqualizer = false);
 
         OrchestraDiscordBotPlayer(const OrchestraDiscordBotPlayer& other);
         OrchestraDiscordBotPlayer(OrchestraDiscordBotPlayer&& other) noexcept;
         OrchestraDiscordBotPlayer& operator=(const OrchestraDiscordBotPlayer& other);
         OrchestraDiscordBotPlayer& operator=(OrchestraDiscordBotPlayer&& other) noexcept;
 
+        //the last published state of the tracks queue, which doesn't wait for the semaphore, so it is for the commands which only show the queue
+        std::shared_ptr<const TracksQueueSnapshot> GetTracksQueueSnapshot() const;
+
         Player player;
         std::atomic_bool hasRawURLRetrievingCompleted;
 
@@ -65,6 +73,10 @@ namespace Orchestra
     private:
         void CopyFrom(const OrchestraDiscordBotPlayer& other);
         void MoveFrom(OrchestraDiscordBotPlayer&& other) noexcept;
+
+    public:
+        //it is declared after the tracks queue, so its callback, which fills the queue, has returned before the queue is destroyed. It is neither copied nor moved
+        RawURLResolver rawURLResolver;
     };
     class OrchestraDiscordBotInstance
     {
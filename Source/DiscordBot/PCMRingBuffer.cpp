@@ -0,0 +1,128 @@
+#include "PCMRingBuffer.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace Orchestra
+{
+    PCMRingBuffer::PCMRingBuffer(size_t capacity)
+        : m_Data(capacity ? std::make_unique<uint8_t[]>(capacity) : nullptr), m_Capacity(capacity), m_WriteIndex(0), m_ReadIndex(0), m_Sequence(0) {}
+
+    PCMRingBuffer::PCMRingBuffer(const PCMRingBuffer& other)
+        : PCMRingBuffer(other.m_Capacity) {}
+    PCMRingBuffer& PCMRingBuffer::operator=(const PCMRingBuffer& other)
+    {
+        Resize(other.m_Capacity);
+
+        return *this;
+    }
+
+    size_t PCMRingBuffer::Write(std::span<const uint8_t> data)
+    {
+        const size_t writeIndex = m_WriteIndex.load(std::memory_order_relaxed);
+        const size_t readIndex = m_ReadIndex.load(std::memory_order_acquire);
+
+        const size_t size = std::min(data.size(), m_Capacity - (writeIndex - readIndex));
+
+        if(!size)
+            return 0;
+
+        const size_t position = writeIndex % m_Capacity;
+        const size_t firstPartSize = std::min(size, m_Capacity - position);
+
+        std::memcpy(m_Data.get() + position, data.data(), firstPartSize);
+        std::memcpy(m_Data.get(), data.data() + firstPartSize, size - firstPartSize);
+
+        Commit(size);
+
+        return size;
+    }
+    std::span<uint8_t> PCMRingBuffer::GetContiguousWritableSpan() noexcept
+    {
+        if(!m_Capacity)
+            return {};
+
+        const size_t writeIndex = m_WriteIndex.load(std::memory_order_relaxed);
+        const size_t position = writeIndex % m_Capacity;
+
+        return { m_Data.get() + position, std::min(GetWritableSize(), m_Capacity - position) };
+    }
+    void PCMRingBuffer::Commit(size_t size) noexcept
+    {
+        m_WriteIndex.fetch_add(size, std::memory_order_release);
+        Notify();
+    }
+
+    size_t PCMRingBuffer::Read(std::span<uint8_t> out)
+    {
+        const size_t readIndex = m_ReadIndex.load(std::memory_order_relaxed);
+        const size_t writeIndex = m_WriteIndex.load(std::memory_order_acquire);
+
+        const size_t size = std::min(out.size(), writeIndex - readIndex);
+
+        if(!size)
+            return 0;
+
+        const size_t position = readIndex % m_Capacity;
+        const size_t firstPartSize = std::min(size, m_Capacity - position);
+
+        std::memcpy(out.data(), m_Data.get() + position, firstPartSize);
+        std::memcpy(out.data() + firstPartSize, m_Data.get(), size - firstPartSize);
+
+        m_ReadIndex.store(readIndex + size, std::memory_order_release);
+        Notify();
+
+        return size;
+    }
+    void PCMRingBuffer::Discard() noexcept
+    {
+        m_ReadIndex.store(m_WriteIndex.load(std::memory_order_acquire), std::memory_order_release);
+        Notify();
+    }
+
+    void PCMRingBuffer::Notify() noexcept
+    {
+        m_Sequence.fetch_add(1, std::memory_order_release);
+        m_Sequence.notify_all();
+    }
+
+    void PCMRingBuffer::Resize(size_t capacity)
+    {
+        if(capacity != m_Capacity)
+        {
+            m_Data = capacity ? std::make_unique<uint8_t[]>(capacity) : nullptr;
+            m_Capacity = capacity;
+        }
+
+        m_WriteIndex = 0;
+        m_ReadIndex = 0;
+    }
+    void PCMRingBuffer::Swap(PCMRingBuffer& other) noexcept
+    {
+        std::swap(m_Data, other.m_Data);
+        std::swap(m_Capacity, other.m_Capacity);
+
+        const size_t writeIndex = m_WriteIndex.exchange(other.m_WriteIndex.load());
+        other.m_WriteIndex = writeIndex;
+
+        const size_t readIndex = m_ReadIndex.exchange(other.m_ReadIndex.load());
+        other.m_ReadIndex = readIndex;
+    }
+}
+//getters, setters
+namespace Orchestra
+{
+    size_t PCMRingBuffer::GetCapacity() const noexcept
+    {
+        return m_Capacity;
+    }
+    size_t PCMRingBuffer::GetReadableSize() const noexcept
+    {
+        return m_WriteIndex.load(std::memory_order_acquire) - m_ReadIndex.load(std::memory_order_acquire);
+    }
+    size_t PCMRingBuffer::GetWritableSize() const noexcept
+    {
+        return m_Capacity - GetReadableSize();
+    }
+}
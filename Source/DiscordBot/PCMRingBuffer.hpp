@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <span>
+#include <cstdint>
+
+namespace Orchestra
+{
+    //lock-free single producer, single consumer byte ring buffer for decoded PCM.
+    //the indices grow monotonically and are wrapped only when accessing m_Data, so readable size is always m_WriteIndex - m_ReadIndex
+    class PCMRingBuffer
+    {
+    public:
+        PCMRingBuffer(size_t capacity = 0);
+
+        //copies only the capacity, not the content
+        PCMRingBuffer(const PCMRingBuffer& other);
+        PCMRingBuffer& operator=(const PCMRingBuffer& other);
+
+        //producer side
+        //writes as much as fits, returns the number of written bytes
+        size_t Write(std::span<const uint8_t> data);
+        //the contiguous free region right after the write position, use it to write without copying and then call Commit
+        std::span<uint8_t> GetContiguousWritableSpan() noexcept;
+        void Commit(size_t size) noexcept;
+
+        //consumer side
+        //reads as much as there is, returns the number of read bytes
+        size_t Read(std::span<uint8_t> out);
+        //drops everything written so far
+        void Discard() noexcept;
+
+        //blocks until predicate returns true, it is checked on every Write, Commit, Read, Discard and Notify
+        template<typename Predicate>
+        void Wait(Predicate&& predicate) const;
+        //wakes up the waiting thread, so it rechecks its predicate
+        void Notify() noexcept;
+
+        //NOTE: not thread safe, the content is dropped
+        void Resize(size_t capacity);
+        //NOTE: not thread safe, neither of the buffers should be used by other threads
+        void Swap(PCMRingBuffer& other) noexcept;
+
+    public:
+        size_t GetCapacity() const noexcept;
+        size_t GetReadableSize() const noexcept;
+        size_t GetWritableSize() const noexcept;
+
+    private:
+        std::unique_ptr<uint8_t[]> m_Data;
+        size_t m_Capacity;
+
+        //are on different cache lines, so the producer and the consumer do not fight over one
+        alignas(64) std::atomic_size_t m_WriteIndex;
+        alignas(64) std::atomic_size_t m_ReadIndex;
+        //is changed on every operation, both sides wait on this one, so Notify cannot get lost between checking the predicate and falling asleep
+        alignas(64) std::atomic_uint32_t m_Sequence;
+    };
+
+    template<typename Predicate>
+    void PCMRingBuffer::Wait(Predicate&& predicate) const
+    {
+        while(true)
+        {
+            const uint32_t sequence = m_Sequence.load(std::memory_order_acquire);
+
+            if(predicate())
+                return;
+
+            m_Sequence.wait(sequence, std::memory_order_acquire);
+        }
+    }
+}
@@ -0,0 +1,109 @@
+#include "PlaybackScheduler.hpp"
+
+#include <algorithm>
+#include <ranges>
+
+#include <GuelderConsoleLog.hpp>
+
+#include "../Utils.hpp"
+#include "../Diagnostics/Metrics.hpp"
+
+namespace Orchestra
+{
+    PlaybackScheduler::~PlaybackScheduler()
+    {
+        std::unordered_map<uint64_t, Playback> playbacks;
+
+        {
+            std::lock_guard lock{ m_Mutex };
+            playbacks = std::move(m_Playbacks);
+        }
+
+        //all of them are stopped first, so they end at once instead of one after another
+        for(Playback& playback : std::views::values(playbacks))
+            playback.thread.request_stop();
+
+        //jthreads are joined here
+        playbacks.clear();
+    }
+
+    void PlaybackScheduler::Start(uint64_t guildID, std::function<void(std::stop_token)> playback)
+    {
+        std::unique_lock lock{ m_Mutex };
+
+        JoinEndedPlaybacks();
+
+        if(const auto found = m_Playbacks.find(guildID); found != m_Playbacks.end())
+        {
+            GE_LOG(Orchestra, Warning, "Waiting for the previous playback of guild ", guildID, " to end.");
+
+            std::jthread previous = std::move(found->second.thread);
+            m_Playbacks.erase(found);
+
+            lock.unlock();
+            previous.join();
+            lock.lock();
+        }
+
+        auto hasEnded = std::make_shared<std::atomic_bool>(false);
+
+        static Metrics::Gauge& activeVoiceSessions = Metrics::GetGauge("orchestra_active_voice_sessions", "How many guilds are playing a queue right now.");
+
+        m_Playbacks.insert_or_assign(guildID, Playback{
+            std::jthread{ [_playback = std::move(playback), hasEnded, guildID](std::stop_token stopToken)
+                {
+                    activeVoiceSessions.Add(1.);
+
+                    const ScopeGuard onEnded{ [&hasEnded]
+                        {
+                            activeVoiceSessions.Add(-1.);
+                            *hasEnded = true;
+                        } };
+
+                    //an exception, which escapes a thread, terminates the whole bot
+                    try
+                    {
+                        _playback(std::move(stopToken));
+                    }
+                    catch(const OrchestraException& e)
+                    {
+                        GE_LOG(Orchestra, Error, "Playback of guild ", guildID, " has thrown: ", e.GetFullMessage());
+                    }
+                    catch(const std::exception& e)
+                    {
+                        GE_LOG(Orchestra, Error, "Playback of guild ", guildID, " has thrown: ", e.what());
+                    }
+                    catch(...)
+                    {
+                        GE_LOG(Orchestra, Error, "Playback of guild ", guildID, " has thrown an unknown exception.");
+                    }
+                } },
+            hasEnded });
+
+        GE_LOG(Orchestra, Info, "Started playback of guild ", guildID, ". Active playbacks: ", m_Playbacks.size(), '.');
+    }
+
+    void PlaybackScheduler::JoinEndedPlaybacks()
+    {
+        //an ended thread is only returning, so joining it is instant
+        std::erase_if(m_Playbacks, [](const auto& pair) { return pair.second.hasEnded->load(); });
+    }
+}
+//getters, setters
+namespace Orchestra
+{
+    bool PlaybackScheduler::IsPlaying(uint64_t guildID) const
+    {
+        std::lock_guard lock{ m_Mutex };
+
+        const auto found = m_Playbacks.find(guildID);
+
+        return found != m_Playbacks.end() && !found->second.hasEnded->load();
+    }
+    size_t PlaybackScheduler::GetActivePlaybacksCount() const
+    {
+        std::lock_guard lock{ m_Mutex };
+
+        return std::ranges::count_if(m_Playbacks, [](const auto& pair) { return !pair.second.hasEnded->load(); });
+    }
+}
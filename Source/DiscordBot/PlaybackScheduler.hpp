@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <unordered_map>
+
+namespace Orchestra
+{
+    //owns one playback thread per guild, so playing a queue for hours does not occupy a command worker
+    class PlaybackScheduler
+    {
+    public:
+        PlaybackScheduler() = default;
+        //stops all playbacks and waits for them to end
+        ~PlaybackScheduler();
+
+        PlaybackScheduler(const PlaybackScheduler&) = delete;
+        PlaybackScheduler(PlaybackScheduler&&) = delete;
+        PlaybackScheduler& operator=(const PlaybackScheduler&) = delete;
+        PlaybackScheduler& operator=(PlaybackScheduler&&) = delete;
+
+        //if the guild's previous playback is still running, it is waited for, as it can only be ending(its queue was empty).
+        //the stop token is stopped by the destructor, the exceptions of the playback are logged
+        void Start(uint64_t guildID, std::function<void(std::stop_token)> playback);
+
+    public:
+        bool IsPlaying(uint64_t guildID) const;
+        size_t GetActivePlaybacksCount() const;
+
+    private:
+        struct Playback
+        {
+            std::jthread thread;
+            //shared with the thread, so it does not touch the map
+            std::shared_ptr<std::atomic_bool> hasEnded;
+        };
+
+    private:
+        void JoinEndedPlaybacks();
+
+    private:
+        mutable std::mutex m_Mutex;
+        std::unordered_map<uint64_t, Playback> m_Playbacks;
+    };
+}
@@ -5,24 +5,79 @@
 #include <mutex>
 #include <future>
 #include <chrono>
+#include <string>
 #include <vector>
-#include <chrono>
+#include <algorithm>
+#include <exception>
+#include <utility>
+#include <limits>
 
 extern "C"
 {
 #include <libavutil/samplefmt.h>
 }
 
-#include <dpp/dpp.h>
-
 #include "../Utils.hpp"
 #include "../FFmpeg/Decoder.hpp"
+#include "../Diagnostics/AllocationsCounter.hpp"
+#include "../Diagnostics/PlaybackTracer.hpp"
+#include "AudioCache.hpp"
+
+//private
+namespace Orchestra
+{
+    namespace
+    {
+        SharedSource::DownloadedCallback MakeStoringInAudioCache(const std::string_view& audioCacheKey)
+        {
+            if(audioCacheKey.empty())
+                return {};
+
+            return [key = std::string{ audioCacheKey }](std::span<const uint8_t> data) { AudioCache::Store(key, data); };
+        }
+        Decoder OpenDecoder(const std::string_view& url, const std::string_view& audioCacheKey, std::stop_token stopToken, const AudioFormatHints& formatHints)
+        {
+            Decoder decoder{ url, Decoder::DEFAULT_SAMPLE_RATE, Decoder::DEFAULT_OUT_SAMPLE_FORMAT, MakeStoringInAudioCache(audioCacheKey), std::move(stopToken), formatHints };
+
+            //the positions in a downloaded track are the same as in its cached file, so the index of the first playback is used by the next ones
+            if(!audioCacheKey.empty())
+                decoder.SetSeekIndexPath(AudioCache::GetSeekIndexPath(audioCacheKey));
+
+            return decoder;
+        }
+
+        //the metrics of a guild, which are got once per track
+        struct PlaybackMetrics
+        {
+            Metrics::Counter& decodingNanoseconds;
+            Metrics::Counter& filteringNanoseconds;
+            Metrics::Counter& underruns;
+            Metrics::Gauge& decodeAheadBufferFill;
+        };
+
+        PlaybackMetrics GetPlaybackMetrics(uint64_t guildID)
+        {
+            const Metrics::Labels labels{ { "guild", std::to_string(guildID) } };
+
+            return
+            {
+                Metrics::GetCounter("orchestra_decoding_nanoseconds_total", "The time spent in decoding and resampling of audio.", labels),
+                Metrics::GetCounter("orchestra_filtering_nanoseconds_total", "The time spent in the filters(speed, bass boost, equalizer).", labels),
+                Metrics::GetCounter("orchestra_underruns_total", "How many times the decoding has been behind the voice client.", labels),
+                Metrics::GetGauge("orchestra_decode_ahead_buffer_fill_ratio", "How much of the decode ahead buffer is filled, from 0 to 1.", labels)
+            };
+        }
+    }
+}
 
 //main stuff
 namespace Orchestra
 {
-    Player::Player(uint32_t sentPacketsSize, bool enableLogSentPackets)
-        : m_SentPacketSize(sentPacketsSize), m_EnableLogSentPackets(enableLogSentPackets), m_BassBoostSettings(0.f, 0.f, 0.f) {
+    Player::Player(uint32_t sentPacketsSize, uint32_t decodeAheadBufferSize, bool enableLogSentPackets, bool useNativeEqualizer)
+        : m_SentPacketSize(std::min(sentPacketsSize, MAX_SENT_PACKET_SIZE)), m_DecodeAheadBufferSize(decodeAheadBufferSize), m_EnableLogSentPackets(enableLogSentPackets),
+        m_HasPrimedAudio(false), m_PrefetchedUniqueIndex(std::numeric_limits<size_t>::max()),
+        m_FilterGraph(Decoder::DEFAULT_SAMPLE_RATE, AudioFilterGraph::OUT_CHANNELS_COUNT, 1.f, false, useNativeEqualizer),
+        m_BassBoostSettings(0.f, 0.f, 0.f), m_Speed(1.f), m_PreservePitch(false), m_UseNativeEqualizer(useNativeEqualizer) {
     }
     Player::Player(const Player& other)
     {
@@ -49,374 +104,832 @@ namespace Orchestra
     {
         m_Decoder = other.m_Decoder;
         m_SentPacketSize = other.m_SentPacketSize;
+        m_DecodeAheadBufferSize = other.m_DecodeAheadBufferSize;
         m_EnableLogSentPackets = other.m_EnableLogSentPackets;
         m_IsDecoding = other.m_IsDecoding.load();
         m_IsSkippingFrames = other.m_IsSkippingFrames.load();
-        m_ShouldReturnToCurrentTimestamp = other.m_ShouldReturnToCurrentTimestamp.load();
-        m_PreviousSampleRate = other.m_PreviousSampleRate.load();
         m_IsPaused = other.m_IsPaused.load();
         m_CurrentDecodingTimestamp = other.m_CurrentDecodingTimestamp.load();
+        m_DecodingAllocationsPerSecond = other.m_DecodingAllocationsPerSecond.load();
+        m_DecodeAheadBuffer = other.m_DecodeAheadBuffer;
+        m_UnderrunsCount = other.m_UnderrunsCount.load();
+        m_HasPrimedAudio = false;
+        m_PrefetchedUniqueIndex = std::numeric_limits<size_t>::max();
         m_BassBoostSettings = other.m_BassBoostSettings;
         m_EqualizerFrequencies = other.m_EqualizerFrequencies;
+        m_FilterGraph = other.m_FilterGraph;
+        m_Speed = other.m_Speed.load();
+        m_PreservePitch = other.m_PreservePitch.load();
+        m_UseNativeEqualizer = other.m_UseNativeEqualizer.load();
     }
     void Player::MoveFrom(Player&& other) noexcept
     {
         m_Decoder = std::move(other.m_Decoder);
         m_SentPacketSize = other.m_SentPacketSize;
+        m_DecodeAheadBufferSize = other.m_DecodeAheadBufferSize;
         m_EnableLogSentPackets = other.m_EnableLogSentPackets;
         m_IsDecoding = other.m_IsDecoding.load();
         m_IsSkippingFrames = other.m_IsSkippingFrames.load();
-        m_ShouldReturnToCurrentTimestamp = other.m_ShouldReturnToCurrentTimestamp.load();
-        m_PreviousSampleRate = other.m_PreviousSampleRate.load();
         m_IsPaused = other.m_IsPaused.load();
         m_CurrentDecodingTimestamp = other.m_CurrentDecodingTimestamp.load();
+        m_DecodingAllocationsPerSecond = other.m_DecodingAllocationsPerSecond.load();
+        m_DecodeAheadBuffer = other.m_DecodeAheadBuffer;
+        m_UnderrunsCount = other.m_UnderrunsCount.load();
+        m_HasPrimedAudio = false;
+        m_PrefetchedUniqueIndex = std::numeric_limits<size_t>::max();
         m_BassBoostSettings = other.m_BassBoostSettings;
         m_EqualizerFrequencies = std::move(other.m_EqualizerFrequencies);
+        m_FilterGraph = std::move(other.m_FilterGraph);
+        m_Speed = other.m_Speed.load();
+        m_PreservePitch = other.m_PreservePitch.load();
+        m_UseNativeEqualizer = other.m_UseNativeEqualizer.load();
     }
 }
 namespace Orchestra
 {
     //TODO: maybe remake it somehow with WaitUntil
-    void Player::LazyDecodingCheck(const std::chrono::milliseconds& toWait, std::unique_lock<std::mutex>& pauseLock, const std::chrono::milliseconds& sleepFor)
+    void Player::WaitForVoiceBufferLow(VoiceSink& voiceSink, std::unique_lock<std::mutex>& pauseLock)
     {
-        auto startedTime = std::chrono::steady_clock::now();
-
-        while(m_IsDecoding)
+        while(m_IsDecoding && !m_IsSkippingFrames)
         {
-            const auto waited = std::chrono::steady_clock::now() - startedTime;
+            m_PauseCondition.wait(pauseLock, [this] { return m_IsPaused == false; });
 
-            m_PauseCondition.wait(pauseLock, [this, &startedTime, &waited] { startedTime = std::chrono::steady_clock::now() - waited; return m_IsPaused == false; });
+            const float remainingSeconds = voiceSink.GetSecondsRemaining();
 
-            if(m_IsSkippingFrames || std::chrono::steady_clock::now() - startedTime >= toWait)
+            if(remainingSeconds <= VOICE_BUFFER_LOW_WATER_SECONDS)
                 break;
 
-            std::this_thread::sleep_for(sleepFor);
+            m_IsVoiceBufferLow = false;
+            m_IsWaitingForVoiceBuffer = true;
+
+            //OnVoiceBufferSent wakes it up, the deadline is just in case the voice client events stop coming
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(remainingSeconds - VOICE_BUFFER_LOW_WATER_SECONDS));
+
+            m_PauseCondition.wait_until(pauseLock, deadline, [this] { return m_IsVoiceBufferLow || m_IsPaused || !m_IsDecoding || m_IsSkippingFrames; });
+
+            m_IsWaitingForVoiceBuffer = false;
+        }
+    }
+    void Player::NotifySender()
+    {
+        //the mutex makes sure the sender is either before checking the flags or already waiting
+        {
+            std::lock_guard pauseLock{ m_PauseMutex };
+        }
+
+        m_PauseCondition.notify_all();
+        m_DecodeAheadBuffer.Notify();
+    }
+
+    std::stop_token Player::RenewStopSource(std::stop_source& stopSource)
+    {
+        std::lock_guard stopSourcesLock{ m_StopSourcesMutex };
+
+        stopSource = std::stop_source{};
+
+        return stopSource.get_token();
+    }
+    void Player::RequestStop(std::stop_source& stopSource)
+    {
+        std::lock_guard stopSourcesLock{ m_StopSourcesMutex };
+
+        stopSource.request_stop();
+    }
+
+    void Player::DecodeAhead(Metrics::Counter& decodingNanoseconds)
+    {
+        std::vector<uint8_t> wrappedFrameBuffer;
+
+        uint64_t decodingAllocations = 0;
+        float decodedSeconds = 0.f;
+
+        std::unique_lock decodingLock{ m_DecodingMutex };
+
+        try
+        {
+            while(m_IsDecoding)
+            {
+                //if the out sample rate grows too much, the rest of a frame stays in the decoder till the next call
+                const size_t frameSize = std::min<size_t>(m_Decoder.GetMaxOutBufferSize(), m_DecodeAheadBuffer.GetCapacity());
+
+                //skipping is applied by the sender, otherwise frames from the old timestamp could be written after it has discarded the buffer
+                if(m_HasDecodingFinished || m_IsSkippingFrames || m_DecodeAheadBuffer.GetWritableSize() < frameSize)
+                {
+                    decodingLock.unlock();
+                    m_DecodeAheadBuffer.Wait(
+                        [this, frameSize]
+                        {
+                            return !m_IsDecoding || (!m_HasDecodingFinished && !m_IsSkippingFrames && m_DecodeAheadBuffer.GetWritableSize() >= frameSize);
+                        });
+                    decodingLock.lock();
+
+                    continue;
+                }
+
+                const uint64_t allocationsBeforeDecoding = AllocationsCounter::GetThreadAllocations();
+
+                if(!m_Decoder.AreThereFramesToProcess())
+                {
+                    m_HasDecodingFinished = true;
+                    m_DecodeAheadBuffer.Notify();
+
+                    continue;
+                }
+
+                const auto decodingBeginning = std::chrono::steady_clock::now();
+
+                const size_t decodedSize = DecodeFrameTo(m_Decoder, m_DecodeAheadBuffer, wrappedFrameBuffer, frameSize);
+
+                decodingNanoseconds.Increment(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - decodingBeginning).count());
+
+                if constexpr(AllocationsCounter::IS_ENABLED)
+                {
+                    decodingAllocations += AllocationsCounter::GetThreadAllocations() - allocationsBeforeDecoding;
+                    decodedSeconds += static_cast<float>(decodedSize) / static_cast<float>(m_Decoder.GetChannelsCount() * m_Decoder.GetBytesPerSample()) / static_cast<float>(m_Decoder.GetOutSampleRate());
+
+                    if(decodedSeconds > 0.f)
+                        m_DecodingAllocationsPerSecond = static_cast<float>(decodingAllocations) / decodedSeconds;
+                }
+            }
+        }
+        catch(...)
+        {
+            //is rethrown by DecodeAndSendAudio
+            m_DecodeAheadException = std::current_exception();
+            m_HasDecodingFinished = true;
+            m_DecodeAheadBuffer.Notify();
+        }
+    }
+
+    bool Player::CanSendOpusPackets(const Decoder& decoder)
+    {
+        std::lock_guard filterLock{ m_FilterMutex };
+
+        return decoder.CanPassthroughOpus() && m_FilterGraph.HasNoEffects();
+    }
+    bool Player::SendOpusPackets(VoiceSink& voiceSink, uint64_t& totalSentPackets, uint64_t& totalSentSize, std::chrono::steady_clock::time_point playbackBeginning)
+    {
+        //the same amount of audio as one packet of the decoding path
+        const float sentPacketSeconds = static_cast<float>(m_SentPacketSize) / static_cast<float>(m_Decoder.GetChannelsCount() * m_Decoder.GetBytesPerSample() * Decoder::DEFAULT_SAMPLE_RATE);
+
+        float sentSeconds = 0.f;
+        bool hasSentAnything = false;
+
+        while(true)
+        {
+            std::unique_lock pauseLock{ m_PauseMutex };
+            m_PauseCondition.wait(pauseLock, [this] { return m_IsPaused == false; });
+
+            if(!m_IsDecoding)
+                return true;
+
+            //the filters are applied by the decoding path, which continues right from the next packet
+            if(!CanSendOpusPackets(m_Decoder))
+                return false;
+
+            if(m_IsSkippingFrames)
+            {
+                pauseLock.unlock();
+
+                std::lock_guard decodingLock{ m_DecodingMutex };
+
+                m_Decoder.SkipToSeconds(m_SkipToTimestamp);
+                m_CurrentDecodingTimestamp = m_SkipToTimestamp.load();
+
+                m_IsSkippingFrames = false;
+
+                sentSeconds = 0.f;
+                hasSentAnything = false;
+
+                continue;
+            }
+
+            //not sending till the voice client is about to run out of audio
+            if(hasSentAnything && sentSeconds >= sentPacketSeconds)
+            {
+                WaitForVoiceBufferLow(voiceSink, pauseLock);
+                sentSeconds = 0.f;
+
+                continue;
+            }
+
+            pauseLock.unlock();
+
+            std::unique_lock decodingLock{ m_DecodingMutex };
+
+            if(!m_Decoder.ReadAudioPacket())
+            {
+                decodingLock.unlock();
+
+                //everything has been sent, so waiting till the voice client plays the rest, because it still can be skipped
+                pauseLock.lock();
+                WaitForVoiceBufferLow(voiceSink, pauseLock);
+
+                if(m_IsSkippingFrames || !CanSendOpusPackets(m_Decoder))
+                    continue;
+
+                return true;
+            }
+
+            const std::span<uint8_t> packet = m_Decoder.GetPacketData();
+            const float packetSeconds = m_Decoder.GetPacketDurationSeconds();
+
+            voiceSink.SendAudioOpus(packet.data(), packet.size());
+
+            if(!totalSentPackets)
+                TraceFirstSend(voiceSink, playbackBeginning);
+
+            m_CurrentDecodingTimestamp += packetSeconds;
+            sentSeconds += packetSeconds;
+            hasSentAnything = true;
+
+            totalSentPackets++;
+            totalSentSize += packet.size();
+
+            if(m_EnableLogSentPackets)
+                GE_LOG(Orchestra, Info, "m_CurrentDecodingTimestamp = ", m_CurrentDecodingTimestamp, "s",
+                    "; voiceSink.GetSecondsRemaining() = ", voiceSink.GetSecondsRemaining(), "s",
+                    "; opusPacketSize = ", packet.size(),
+                    "; totalSentPackets = ", totalSentPackets);
         }
     }
 
-    void Player::DecodeAndSendAudio(const dpp::voiceconn* voice)
+    void Player::TraceFirstSend(const VoiceSink& voiceSink, std::chrono::steady_clock::time_point playbackBeginning) const
+    {
+        const uint64_t guildID = voiceSink.GetGuildID();
+        const Decoder::OpenTimings& openTimings = m_Decoder.GetOpenTimings();
+
+        PlaybackTracer::Record(guildID, PlaybackTracer::Span::FirstSend, std::chrono::steady_clock::now() - playbackBeginning);
+        PlaybackTracer::Record(guildID, PlaybackTracer::Span::DecoderOpen, openTimings.open + openTimings.probe);
+
+        //opus packets are sent without decoding
+        if(openTimings.firstFrame)
+            PlaybackTracer::Record(guildID, PlaybackTracer::Span::FirstDecode, openTimings.firstPacket.value_or(std::chrono::microseconds{ 0 }) + openTimings.firstFrame.value());
+
+        PlaybackTracer::End(guildID);
+    }
+
+    size_t Player::GetDecodeAheadBufferCapacity(const Decoder& decoder) const
+    {
+        //must fit at least one packet and a frame which did not fit into that packet
+        return std::max<size_t>(m_DecodeAheadBufferSize, m_SentPacketSize + decoder.GetMaxOutBufferSize());
+    }
+    size_t Player::DecodeFrameTo(const Decoder& decoder, PCMRingBuffer& buffer, std::vector<uint8_t>& wrappedFrameBuffer, size_t frameSize)
     {
-        //std::unique_lock decodingLock{ m_DecodingMutex };
+        auto writableSpan = buffer.GetContiguousWritableSpan();
 
+        if(writableSpan.size() >= frameSize)
+        {
+            const size_t decodedSize = decoder.DecodeAudioFrame(writableSpan);
+            buffer.Commit(decodedSize);
+
+            return decodedSize;
+        }
+
+        //the free space wraps around, so the frame cannot be decoded right into the buffer
+        if(wrappedFrameBuffer.size() < frameSize)
+            wrappedFrameBuffer.resize(frameSize);
+
+        const size_t decodedSize = decoder.DecodeAudioFrame({ wrappedFrameBuffer.data(), frameSize });
+        buffer.Write({ wrappedFrameBuffer.data(), decodedSize });
+
+        return decodedSize;
+    }
+
+    void Player::DecodeAndSendAudio(VoiceSink& voiceSink)
+    {
         O_ASSERT(m_Decoder.IsReady(), "m_Decoder is not ready.");
 
-        //if(!m_BassBoostSettings.IsEmpty() && !m_Decoder.IsBassBoostActive())
-        m_Decoder.SetBassBoost(m_BassBoostSettings.decibelsBoost, m_BassBoostSettings.frequency, m_BassBoostSettings.bandwidth);
-        m_Decoder.SetEqualizer(m_EqualizerFrequencies);
+        const auto playbackBeginning = std::chrono::steady_clock::now();
 
-        //TODO: put this into config.txt
-        constexpr float waitFactor = .9f;
-        float currentWaitFactor = 1.f;
+        const PlaybackMetrics metrics = GetPlaybackMetrics(voiceSink.GetGuildID());
 
         GE_LOG(Orchestra, Info, "Total duration of audio: ", m_Decoder.GetTotalDurationSeconds(), "s.");
 
-        std::vector<uint8_t> buffer;
-        buffer.reserve(m_SentPacketSize);
+        if(m_Decoder.IsShared())
+            GE_LOG(Orchestra, Info, "The audio is downloaded once for all guilds which play it.");
+
+        {
+            std::lock_guard filterLock{ m_FilterMutex };
+
+            //the filters must not keep anything from the previous track
+            m_FilterGraph.Reset(m_Decoder.GetOutSampleRate(), m_Decoder.GetChannelsCount());
+        }
+
+        constexpr int outBytesPerSample = AudioFilterGraph::OUT_CHANNELS_COUNT * sizeof(int16_t);
+        constexpr size_t opusFrameSize = OPUS_FRAME_SAMPLES * outBytesPerSample;
+
+        //the voice client pads every opus frame which isn't full with silence, so only whole ones are sent
+        const size_t sentPacketSize = std::max<size_t>(m_SentPacketSize / opusFrameSize, 1) * opusFrameSize;
+
+        const int channelsCountTimesBytesPerSample = m_Decoder.GetChannelsCount() * m_Decoder.GetBytesPerSample();
+        //the same number of samples as in a sent packet, the filters can produce a bit more or less of them
+        const size_t filteredChunkSize = sentPacketSize / outBytesPerSample * channelsCountTimesBytesPerSample;
+
+        //opus packets are sent as they are, unless a filter is enabled in the middle of the track
+        const bool canSendOpusPackets = !m_HasPrimedAudio && CanSendOpusPackets(m_Decoder);
+
+        if(canSendOpusPackets)
+            GE_LOG(Orchestra, Info, "The audio is opus, so it is sent without decoding.");
+
+        //the prefetched audio has been decoded with the same decoder, so it is just continued
+        if(!m_HasPrimedAudio)
+            m_DecodeAheadBuffer.Resize(GetDecodeAheadBufferCapacity(m_Decoder));
+
+        m_HasPrimedAudio = false;
 
-        uint64_t totalReads = 0;
+        std::vector<uint8_t> buffer(filteredChunkSize);
+        //is filtered, but not sent yet
+        std::vector<uint8_t> filteredBuffer;
+        filteredBuffer.reserve(sentPacketSize * 2);
+
+        uint64_t totalSentPackets = 0;
         uint64_t totalSentSize = 0;
-        //float totalDuration = 0;
 
         GE_LOG(Orchestra, Info, "PlayAudio is executing on thread with index ", std::this_thread::get_id(), '.');
 
         m_IsDecoding = true;
+        m_IsSkippingFrames = false;
+        m_HasDecodingFinished = false;
+        m_DecodeAheadException = nullptr;
+        m_UnderrunsCount = 0;
+        m_DecodingAllocationsPerSecond = 0.f;
 
         float currentSentDuration = 0.f;
         float totalSentDuration = 0.f;
 
-        const int channelsCountTimesBytesPerSample = m_Decoder.GetChannelsCount() * m_Decoder.GetBytesPerSample();
-
-        //bool skipping = false;
+        std::jthread decodeAheadThread;
 
-        constexpr int initialSampleRate = Decoder::DEFAULT_SAMPLE_RATE;
-        m_PreviousSampleRate = initialSampleRate;
+        bool hasSentAnything = false;
+        bool isUnderrun = false;
+        bool hasSentAllOpusPackets = false;
 
-        bool areThereFramesToProcess = m_Decoder.AreThereFramesToProcess();
-        bool waitingAfterLastBytes = false;
+        std::exception_ptr sendingException;
 
-        while(areThereFramesToProcess || waitingAfterLastBytes)
+        try
         {
-            std::unique_lock pauseLock{ m_PauseMutex };
-            m_PauseCondition.wait(pauseLock, [this] { return m_IsPaused == false; });
+            if(canSendOpusPackets)
+                hasSentAllOpusPackets = SendOpusPackets(voiceSink, totalSentPackets, totalSentSize, playbackBeginning);
 
-            if(!m_IsDecoding)
-                break;
+            if(!hasSentAllOpusPackets)
+                decodeAheadThread = std::jthread{ [this, &metrics] { DecodeAhead(metrics.decodingNanoseconds); } };
 
-            std::unique_lock decodingLock{ m_DecodingMutex };
-            //if(!decodingLock.owns_lock())
-                //decodingLock.lock();
-            auto out = m_Decoder.DecodeAudioFrame();
-            decodingLock.unlock();
+            while(!hasSentAllOpusPackets)
+            {
+                std::unique_lock pauseLock{ m_PauseMutex };
+                m_PauseCondition.wait(pauseLock, [this] { return m_IsPaused == false; });
+
+                if(!m_IsDecoding)
+                    break;
 
-            buffer.insert(buffer.end(), out.begin(), out.end());
+                if(m_IsSkippingFrames)
+                {
+                    //the setters lock m_DecodingMutex before m_PauseMutex
+                    pauseLock.unlock();
 
-            out.clear();
-            out.shrink_to_fit();
+                    std::lock_guard decodingLock{ m_DecodingMutex };
 
-            areThereFramesToProcess = m_Decoder.AreThereFramesToProcess();
+                    m_Decoder.SkipToSeconds(m_SkipToTimestamp);
+                    m_CurrentDecodingTimestamp = m_SkipToTimestamp.load();
 
-            if(buffer.size() >= m_SentPacketSize || !areThereFramesToProcess)
-            {
-                decodingLock.lock();
+                    m_IsSkippingFrames = false;
+                    m_HasDecodingFinished = false;
+
+                    //also wakes up the decoding thread
+                    m_DecodeAheadBuffer.Discard();
+                    filteredBuffer.clear();
+
+                    hasSentAnything = false;
+                    isUnderrun = false;
 
-                //TODO: make so that when I call !skip -secs to skip this loop and start decoding
-                //I need to call from discord stop and proceed to decoding
-                if(!m_IsSkippingFrames && !m_ShouldReturnToCurrentTimestamp)
+                    continue;
+                }
+
+                //not filtering till the voice client is about to run out of audio, so the changed filters are heard as soon as possible
+                if(hasSentAnything)
                 {
-                    decodingLock.unlock();
-                    LazyDecodingCheck(std::chrono::milliseconds{ static_cast<int>(voice->voiceclient->get_secs_remaining() * currentWaitFactor) * 1000 }, pauseLock);
-                    decodingLock.lock();
+                    WaitForVoiceBufferLow(voiceSink, pauseLock);
 
                     if(!m_IsDecoding)
                         break;
+                    if(m_IsSkippingFrames)
+                        continue;
                 }
-                else
-                {
-                    //if(!m_ShouldReturnToCurrentTimestamp)
-                        //voice->voiceclient->stop_audio();
-                    m_IsSkippingFrames = false;
-                }
-
-                const float sampleRateRatio = static_cast<float>(initialSampleRate) / m_Decoder.GetOutSampleRate();
-                const float prevSampleRateRatio = static_cast<float>(initialSampleRate) / m_PreviousSampleRate;
 
-                if(!m_IsSkippingFrames)
+                if(filteredBuffer.size() < sentPacketSize)
                 {
-                    if(m_ShouldReturnToCurrentTimestamp)
+                    if(m_DecodeAheadBuffer.GetReadableSize() < filteredChunkSize && !m_HasDecodingFinished)
                     {
-                        voice->voiceclient->stop_audio();
-                        m_ShouldReturnToCurrentTimestamp = false;
+                        if(hasSentAnything && !isUnderrun)
+                        {
+                            isUnderrun = true;
+                            ++m_UnderrunsCount;
+                            metrics.underruns.Increment();
+
+                            if(m_EnableLogSentPackets)
+                                GE_LOG(Orchestra, Warning, "The decoding is behind the voice client, underruns count: ", m_UnderrunsCount, '.');
+                        }
+
+                        pauseLock.unlock();
+
+                        m_DecodeAheadBuffer.Wait(
+                            [this, filteredChunkSize]
+                            {
+                                return m_DecodeAheadBuffer.GetReadableSize() >= filteredChunkSize || m_HasDecodingFinished || !m_IsDecoding || m_IsPaused || m_IsSkippingFrames;
+                            });
+
+                        continue;
                     }
 
-                    voice->voiceclient->send_audio_raw(reinterpret_cast<uint16_t*>(buffer.data()), buffer.size());
-
-                    totalSentSize += buffer.size();
-                    const float remainingSeconds = voice->voiceclient->get_secs_remaining();
-                    currentSentDuration = remainingSeconds - (currentSentDuration * (1.f - currentWaitFactor));
-
-                    m_CurrentDecodingTimestamp += static_cast<float>(buffer.size()) / static_cast<float>(channelsCountTimesBytesPerSample) / static_cast<float>(m_Decoder.GetOutSampleRate())/* * sampleRateRatio*/;
-
-                    totalSentDuration += currentSentDuration * sampleRateRatio;
-                    
-                    if(m_EnableLogSentPackets)
-                        GE_LOG(Orchestra, Info, "m_CurrentDecodingTimestamp = ", m_CurrentDecodingTimestamp, "s",
-                            "; totalSentDuration = ", totalSentDuration, "s",
-                            "; voice->voiceclient->get_secs_remaining() = ", remainingSeconds, "s",
-                            "; currentSentDuration = ", currentSentDuration, "s",
-                            "; buffer.size() = ", buffer.size(),
-                            "; totalReads = ", totalReads,
-                            "; currentWaitFactor = ", currentWaitFactor);
-
-                    if(currentWaitFactor == waitFactor)
-                        currentWaitFactor = 1.f;
-                    else
-                        currentWaitFactor = waitFactor;
+                    if(const size_t readSize = m_DecodeAheadBuffer.Read({ buffer.data(), filteredChunkSize }))
+                    {
+                        {
+                            std::lock_guard filterLock{ m_FilterMutex };
+
+                            const auto filteringBeginning = std::chrono::steady_clock::now();
+
+                            m_FilterGraph.Process({ buffer.data(), readSize }, filteredBuffer);
+
+                            metrics.filteringNanoseconds.Increment(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - filteringBeginning).count());
+                        }
+
+                        m_CurrentDecodingTimestamp += static_cast<float>(readSize) / static_cast<float>(channelsCountTimesBytesPerSample) / static_cast<float>(m_Decoder.GetOutSampleRate());
+
+                        continue;
+                    }
                 }
-                else if(m_ShouldReturnToCurrentTimestamp)
+
+                if(filteredBuffer.empty())
                 {
-                    const float remainingSeconds = voice->voiceclient->get_secs_remaining();
-                    m_CurrentDecodingTimestamp -= remainingSeconds * prevSampleRateRatio;
-                    GE_LOG(Orchestra, Warning, "There is a need to skip to currently playing frame!\nprevSampleRateRatio = ", prevSampleRateRatio, "\nm_CurrentDecodingTimestamp = ", m_CurrentDecodingTimestamp, "\nremainingSeconds = ", remainingSeconds);
-                    m_Decoder.SkipToSeconds(m_CurrentDecodingTimestamp);
+                    //everything has been decoded and sent, so waiting till the voice client plays the rest, because it still can be skipped
+                    WaitForVoiceBufferLow(voiceSink, pauseLock);
+
+                    if(m_IsSkippingFrames)
+                        continue;
+
+                    break;
                 }
 
-                buffer.clear();
+                //the rest of the track can be less than a packet
+                const size_t sentSize = std::min(filteredBuffer.size(), sentPacketSize);
 
-                decodingLock.unlock();
-            }
+                const float remainingSecondsBeforeSending = voiceSink.GetSecondsRemaining();
 
-            if(!areThereFramesToProcess)
-            {
-                LazyDecodingCheck(std::chrono::milliseconds{ static_cast<int>(voice->voiceclient->get_secs_remaining() * waitFactor) * 1000 }, pauseLock);
+                voiceSink.SendAudioRaw(reinterpret_cast<uint16_t*>(filteredBuffer.data()), sentSize);
 
-                areThereFramesToProcess = m_Decoder.AreThereFramesToProcess();
-            }
+                if(!totalSentPackets)
+                    TraceFirstSend(voiceSink, playbackBeginning);
 
-            totalReads++;
+                filteredBuffer.erase(filteredBuffer.begin(), filteredBuffer.begin() + sentSize);
+
+                hasSentAnything = true;
+                isUnderrun = false;
+
+                metrics.decodeAheadBufferFill.SetValue(static_cast<double>(m_DecodeAheadBuffer.GetReadableSize()) / static_cast<double>(m_DecodeAheadBuffer.GetCapacity()));
+
+                totalSentPackets++;
+                totalSentSize += sentSize;
+                const float remainingSeconds = voiceSink.GetSecondsRemaining();
+                currentSentDuration = remainingSeconds - remainingSecondsBeforeSending;
+
+                totalSentDuration += currentSentDuration;
+
+                if(m_EnableLogSentPackets)
+                    GE_LOG(Orchestra, Info, "m_CurrentDecodingTimestamp = ", m_CurrentDecodingTimestamp, "s",
+                        "; totalSentDuration = ", totalSentDuration, "s",
+                        "; voiceSink.GetSecondsRemaining() = ", remainingSeconds, "s",
+                        "; currentSentDuration = ", currentSentDuration, "s",
+                        "; sentSize = ", sentSize,
+                        "; decodedAheadSize = ", m_DecodeAheadBuffer.GetReadableSize(),
+                        "; totalSentPackets = ", totalSentPackets,
+                        "; decodingAllocationsPerSecond(without FFmpeg's) = ", m_DecodingAllocationsPerSecond,
+                        "; underrunsCount = ", m_UnderrunsCount);
+            }
+        }
+        catch(...)
+        {
+            sendingException = std::current_exception();
         }
 
+        m_IsDecoding = false;
+        m_DecodeAheadBuffer.Notify();
+
+        if(decodeAheadThread.joinable())
+            decodeAheadThread.join();
+
+        metrics.decodeAheadBufferFill.SetValue(0.);
+
         if(m_EnableLogSentPackets)
-            GE_LOG(Orchestra, Info, "Playback finished. Total number of reads: ", totalReads, " reads. Total size of sent data: ", totalSentSize, ". m_CurrentDecodingTimestamp: ", m_CurrentDecodingTimestamp, '.');
+            GE_LOG(Orchestra, Info, "Playback finished. Total number of sent packets: ", totalSentPackets, ". Total size of sent data: ", totalSentSize, ". m_CurrentDecodingTimestamp: ", m_CurrentDecodingTimestamp, ". Decoding allocations per second(without FFmpeg's): ", m_DecodingAllocationsPerSecond, ". Underruns count: ", m_UnderrunsCount, '.');
 
-        m_IsDecoding = false;
-        m_PreviousSampleRate = 0;
         m_CurrentDecodingTimestamp = 0.f;
+
+        try
+        {
+            //the track could have been skipped before it was downloaded, or not have fit in the cache
+            if(AudioCache::HasTrackOfSeekIndex(m_Decoder.GetSeekIndexPath()) && m_Decoder.SaveSeekIndex())
+                GE_LOG(Orchestra, Info, "Saved the seek index of the track.");
+        }
+        catch(const OrchestraException& e)
+        {
+            GE_LOG(Orchestra, Warning, "Failed to save the seek index: ", e.GetFullMessage());
+        }
+
+        if(sendingException)
+            std::rethrow_exception(sendingException);
+        if(m_DecodeAheadException)
+            std::rethrow_exception(std::exchange(m_DecodeAheadException, nullptr));
     }
 
     void Player::Stop()
     {
+        CancelOpening();
+
+        //the prefetched track won't be played, not waiting for it to open
+        m_IsPrefetchCancelled = true;
+        RequestStop(m_PrefetchStopSource);
+
         std::unique_lock decodingLock{ m_DecodingMutex };
         Pause(true);
 
         m_IsDecoding = false;
         m_IsPaused = false;
         m_PauseCondition.notify_all();
+        m_DecodeAheadBuffer.Notify();
 
         Pause(false);
     }
+    void Player::OnVoiceBufferSent(float remainingSeconds)
+    {
+        if(!m_IsWaitingForVoiceBuffer || remainingSeconds > VOICE_BUFFER_LOW_WATER_SECONDS)
+            return;
+
+        {
+            std::lock_guard pauseLock{ m_PauseMutex };
+            m_IsVoiceBufferLow = true;
+        }
+
+        m_PauseCondition.notify_all();
+    }
     void Player::Pause(bool pause)
     {
         m_IsPaused = pause;
         m_PauseCondition.notify_all();
+        m_DecodeAheadBuffer.Notify();
     }
 
     void Player::Skip()
     {
+        CancelOpening();
+
         m_IsDecoding = false;
         m_IsPaused = false;
         m_PauseCondition.notify_all();
+        m_DecodeAheadBuffer.Notify();
     }
 
     void Player::SkipToSeconds(float seconds)
     {
         std::unique_lock decodingLock{ m_DecodingMutex };
 
-        m_Decoder.SkipToSeconds(seconds);
-        m_CurrentDecodingTimestamp = seconds;
-        m_IsSkippingFrames = true;
+        if(m_IsDecoding)
+        {
+            //the sender does the actual skipping, because it also has to discard already decoded frames
+            m_SkipToTimestamp = seconds;
+            m_IsSkippingFrames = true;
+            NotifySender();
+        }
+        else
+        {
+            m_Decoder.SkipToSeconds(seconds);
+            m_CurrentDecodingTimestamp = seconds;
+        }
     }
     void Player::SkipSeconds(float seconds)
     {
-        std::unique_lock decodingLock{ m_DecodingMutex };
+        //the lock is released, because SkipToSeconds locks it
+        float timestamp;
+        {
+            std::unique_lock decodingLock{ m_DecodingMutex };
 
-        m_CurrentDecodingTimestamp += seconds;
-        m_Decoder.SkipToSeconds(m_CurrentDecodingTimestamp);
-        m_IsSkippingFrames = true;
-    }
+            timestamp = (m_IsSkippingFrames ? m_SkipToTimestamp.load() : m_CurrentDecodingTimestamp.load()) + seconds;
+        }
 
-    void Player::SetDecoder(const std::string_view& url, int sampleRate)
-    {
-        m_Decoder = Decoder{ url, sampleRate };
+        SkipToSeconds(timestamp);
     }
 
-    void Player::ResetDecoder()
+    void Player::CancelOpening()
     {
-        m_Decoder.Reset();
-    }
-    bool Player::IsDecoderReady() const
-    {
-        return m_Decoder.IsReady();
+        RequestStop(m_DecoderStopSource);
     }
 
-    void Player::SetBassBoost(BassBoostSettings bassBoostSettings)
+    bool Player::SetDecoder(const std::string_view& url, float speed, const std::string_view& audioCacheKey, const AudioFormatHints& formatHints)
     {
-        std::lock_guard bassBoostSettingsLock{ m_DecodingMutex };
-
-        m_BassBoostSettings = std::move(bassBoostSettings);
+        const std::stop_token stopToken = RenewStopSource(m_DecoderStopSource);
 
-        if(m_Decoder.IsReady())
+        try
+        {
+            m_Decoder = OpenDecoder(url, audioCacheKey, stopToken, formatHints);
+        }
+        catch(const OrchestraException&)
         {
-            const bool wasPaused = m_IsPaused;
+            if(!stopToken.stop_requested())
+                throw;
 
-            if(!wasPaused)
-                Pause(true);
+            GE_LOG(Orchestra, Info, "Opening of the track has been cancelled.");
 
-            m_ShouldReturnToCurrentTimestamp = true;
-            m_IsSkippingFrames = true;
+            return false;
+        }
 
-            m_Decoder.SetBassBoost(m_BassBoostSettings.decibelsBoost, m_BassBoostSettings.frequency, m_BassBoostSettings.bandwidth);
+        SetSpeed(speed);
 
-            if(!wasPaused)
-                Pause(false);
-        }
-    }
-    void Player::SetBassBoost(float decibelsBoost, float frequencyToAdjust, float bandwidth)
-    {
-        SetBassBoost(BassBoostSettings{ decibelsBoost, frequencyToAdjust, bandwidth });
+        return true;
     }
 
-    void Player::InsertOrAssignEqualizerFrequency(float frequency, float decibelsBoost)
+    void Player::Prefetch(size_t uniqueIndex, const std::string_view& url, const std::string_view& audioCacheKey, const AudioFormatHints& formatHints, std::stop_token stopToken)
     {
-        std::lock_guard equalizersLock{ m_DecodingMutex };
+        std::lock_guard prefetchLock{ m_PrefetchMutex };
 
-        m_EqualizerFrequencies.insert_or_assign(frequency, decibelsBoost);
+        m_IsPrefetchCancelled = false;
+        m_PrefetchedUniqueIndex = std::numeric_limits<size_t>::max();
+
+        const std::stop_token prefetchStopToken = RenewStopSource(m_PrefetchStopSource);
 
-        if(m_Decoder.IsReady())
+        //called at once if it has already been requested
+        std::stop_callback cancelOnStop{ stopToken, [this]
+            {
+                m_IsPrefetchCancelled = true;
+                RequestStop(m_PrefetchStopSource);
+            } };
+
+        //a long one
+        try
+        {
+            m_PrefetchedDecoder = OpenDecoder(url, audioCacheKey, prefetchStopToken, formatHints);
+        }
+        catch(const OrchestraException&)
         {
-            const bool wasPaused = m_IsPaused;
+            if(!prefetchStopToken.stop_requested())
+                throw;
 
-            if(!wasPaused)
-                Pause(true);
+            GE_LOG(Orchestra, Info, "Prefetching of the track with unique index ", uniqueIndex, " has been cancelled.");
 
-            m_ShouldReturnToCurrentTimestamp = true;
-            m_IsSkippingFrames = true;
+            return;
+        }
 
-            m_Decoder.SetEqualizer(m_EqualizerFrequencies);
+        m_PrefetchedBuffer.Resize(GetDecodeAheadBufferCapacity(m_PrefetchedDecoder));
 
-            if(!wasPaused)
-                Pause(false);
+        //opus packets may be sent without decoding, in which case the primed audio would be wasted, and opening is the only long part anyway
+        if(m_PrefetchedDecoder.CanPassthroughOpus())
+        {
+            m_PrefetchedUniqueIndex = uniqueIndex;
+            GE_LOG(Orchestra, Info, "Prefetched the track with unique index ", uniqueIndex, ", its audio is opus, so it is not primed.");
+
+            return;
         }
+
+        const size_t frameSize = std::min<size_t>(m_PrefetchedDecoder.GetMaxOutBufferSize(), m_PrefetchedBuffer.GetCapacity());
+        const size_t primedSize = std::min<size_t>(
+            static_cast<size_t>(PREFETCH_PRIMED_SECONDS * m_PrefetchedDecoder.GetOutSampleRate()) * m_PrefetchedDecoder.GetChannelsCount() * m_PrefetchedDecoder.GetBytesPerSample(),
+            m_PrefetchedBuffer.GetCapacity() - frameSize);
+
+        std::vector<uint8_t> wrappedFrameBuffer;
+
+        while(!m_IsPrefetchCancelled && m_PrefetchedBuffer.GetReadableSize() < primedSize && m_PrefetchedDecoder.AreThereFramesToProcess())
+            DecodeFrameTo(m_PrefetchedDecoder, m_PrefetchedBuffer, wrappedFrameBuffer, frameSize);
+
+        if(m_IsPrefetchCancelled)
+        {
+            m_PrefetchedDecoder.Reset();
+            return;
+        }
+
+        m_PrefetchedUniqueIndex = uniqueIndex;
+
+        GE_LOG(Orchestra, Info, "Prefetched ", static_cast<float>(m_PrefetchedBuffer.GetReadableSize()) / static_cast<float>(m_PrefetchedDecoder.GetOutSampleRate() * m_PrefetchedDecoder.GetChannelsCount() * m_PrefetchedDecoder.GetBytesPerSample()), "s of the track with unique index ", uniqueIndex, '.');
     }
-    void Player::EraseEqualizerFrequency(float frequency)
+    bool Player::SetPrefetchedDecoder(size_t uniqueIndex, float speed)
     {
-        std::lock_guard equalizersLock{ m_DecodingMutex };
+        std::lock_guard prefetchLock{ m_PrefetchMutex };
 
-        m_EqualizerFrequencies.erase(frequency);
+        if(!m_PrefetchedDecoder.IsReady() || m_PrefetchedUniqueIndex != uniqueIndex)
+        {
+            m_PrefetchedDecoder.Reset();
+            m_PrefetchedUniqueIndex = std::numeric_limits<size_t>::max();
+
+            return false;
+        }
 
-        if(m_Decoder.IsReady())
+        m_Decoder = std::move(m_PrefetchedDecoder);
+        m_PrefetchedDecoder.Reset();
+        m_PrefetchedUniqueIndex = std::numeric_limits<size_t>::max();
+
+        //the decoder is stopped by the source it has been opened with
         {
-            const bool wasPaused = m_IsPaused;
+            std::lock_guard stopSourcesLock{ m_StopSourcesMutex };
+            m_DecoderStopSource = std::exchange(m_PrefetchStopSource, std::stop_source{});
+        }
 
-            if(!wasPaused)
-                Pause(true);
+        m_DecodeAheadBuffer.Swap(m_PrefetchedBuffer);
+        //the primed audio is not filtered yet, so it is always usable, unless it is opus, which is not primed at all
+        m_HasPrimedAudio = m_DecodeAheadBuffer.GetReadableSize() > 0;
 
-            m_ShouldReturnToCurrentTimestamp = true;
-            m_IsSkippingFrames = true;
+        SetSpeed(speed);
+
+        return true;
+    }
+    void Player::CancelPrefetch()
+    {
+        m_IsPrefetchCancelled = true;
+        //otherwise the lock waits till the prefetched url is opened
+        RequestStop(m_PrefetchStopSource);
 
-            m_Decoder.SetEqualizer(m_EqualizerFrequencies);
+        std::lock_guard prefetchLock{ m_PrefetchMutex };
 
-            if(!wasPaused)
-                Pause(false);
-        }
+        m_PrefetchedDecoder.Reset();
+        m_PrefetchedUniqueIndex = std::numeric_limits<size_t>::max();
     }
-    void Player::ClearEqualizer()
+
+    void Player::ResetDecoder()
     {
-        std::lock_guard equalizersLock{ m_DecodingMutex };
+        m_Decoder.Reset();
+    }
+    bool Player::IsDecoderReady() const
+    {
+        return m_Decoder.IsReady();
+    }
 
-        m_EqualizerFrequencies.clear();
+    void Player::SetBassBoost(BassBoostSettings bassBoostSettings)
+    {
+        std::lock_guard filterLock{ m_FilterMutex };
 
-        if(m_Decoder.IsReady())
-        {
-            const bool wasPaused = m_IsPaused;
+        m_BassBoostSettings = std::move(bassBoostSettings);
+
+        //is heard right after the audio which has already been sent
+        m_FilterGraph.SetBassBoost(m_BassBoostSettings.decibelsBoost, m_BassBoostSettings.frequency, m_BassBoostSettings.bandwidth);
+    }
+    void Player::SetBassBoost(float decibelsBoost, float frequencyToAdjust, float bandwidth)
+    {
+        SetBassBoost(BassBoostSettings{ decibelsBoost, frequencyToAdjust, bandwidth });
+    }
 
-            if(!wasPaused)
-                Pause(true);
+    void Player::InsertOrAssignEqualizerFrequency(float frequency, float decibelsBoost)
+    {
+        std::lock_guard filterLock{ m_FilterMutex };
 
-            m_ShouldReturnToCurrentTimestamp = true;
-            m_IsSkippingFrames = true;
+        m_EqualizerFrequencies.insert_or_assign(frequency, decibelsBoost);
+        m_FilterGraph.SetEqualizer(m_EqualizerFrequencies);
+    }
+    void Player::EraseEqualizerFrequency(float frequency)
+    {
+        std::lock_guard filterLock{ m_FilterMutex };
 
-            m_Decoder.SetEqualizer(m_EqualizerFrequencies);
+        m_EqualizerFrequencies.erase(frequency);
+        m_FilterGraph.SetEqualizer(m_EqualizerFrequencies);
+    }
+    void Player::ClearEqualizer()
+    {
+        std::lock_guard filterLock{ m_FilterMutex };
 
-            if(!wasPaused)
-                Pause(false);
-        }
+        m_EqualizerFrequencies.clear();
+        m_FilterGraph.SetEqualizer(m_EqualizerFrequencies);
     }
 }
 //getters, setters
 namespace Orchestra
 {
-    void Player::SetAudioSampleRate(int sampleRate)
+    void Player::SetSpeed(float speed)
     {
-        std::unique_lock decodingLock{ m_DecodingMutex };
-
-        const bool wasPaused = m_IsPaused;
-
-        if(!wasPaused)
-            Pause(true);
+        std::lock_guard filterLock{ m_FilterMutex };
 
-        m_PreviousSampleRate = m_Decoder.GetOutSampleRate();
-        m_Decoder.SetOutSampleRate(sampleRate);
-
-        m_ShouldReturnToCurrentTimestamp = true;
-        m_IsSkippingFrames = true;
+        m_FilterGraph.SetSpeed(speed);
+        m_Speed = speed;
+    }
+    float Player::GetSpeed() const
+    {
+        return m_Speed;
+    }
+    void Player::SetPreservePitch(bool preservePitch)
+    {
+        std::lock_guard filterLock{ m_FilterMutex };
 
-        if(!wasPaused)
-            Pause(false);
+        m_FilterGraph.SetPreservePitch(preservePitch);
+        m_PreservePitch = preservePitch;
+    }
+    bool Player::GetPreservePitch() const
+    {
+        return m_PreservePitch;
     }
+    void Player::SetUseNativeEqualizer(bool useNativeEqualizer)
+    {
+        std::lock_guard filterLock{ m_FilterMutex };
 
-    int Player::GetAudioSampleRate() const
+        m_FilterGraph.SetUseNativeEqualizer(useNativeEqualizer);
+        m_UseNativeEqualizer = useNativeEqualizer;
+    }
+    bool Player::GetUseNativeEqualizer() const
     {
-        return m_Decoder.GetOutSampleRate();
+        return m_UseNativeEqualizer;
     }
 
     void Player::SetEnableLogSentPackets(bool enable)
@@ -425,7 +938,11 @@ namespace Orchestra
     }
     void Player::SetSentPacketSize(uint32_t size)
     {
-        m_SentPacketSize = size;
+        m_SentPacketSize = std::min(size, MAX_SENT_PACKET_SIZE);
+    }
+    void Player::SetDecodeAheadBufferSize(uint32_t size)
+    {
+        m_DecodeAheadBufferSize = size;
     }
 
     bool Player::GetIsPaused() const noexcept
@@ -445,6 +962,10 @@ namespace Orchestra
     {
         return m_SentPacketSize;
     }
+    uint32_t Player::GetDecodeAheadBufferSize() const noexcept
+    {
+        return m_DecodeAheadBufferSize;
+    }
 
     float Player::GetCurrentTimestamp() const
     {
@@ -454,6 +975,14 @@ namespace Orchestra
     {
         return m_Decoder.GetTotalDurationSeconds();
     }
+    float Player::GetDecodingAllocationsPerSecond() const noexcept
+    {
+        return m_DecodingAllocationsPerSecond;
+    }
+    uint64_t Player::GetUnderrunsCount() const noexcept
+    {
+        return m_UnderrunsCount;
+    }
 
     const Player::BassBoostSettings& Player::GetBassBoostSettings() const
     {
@@ -1,15 +1,20 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <mutex>
 #include <future>
 #include <vector>
 #include <string_view>
 #include <map>
-
-#include <dpp/dpp.h>
+#include <exception>
+#include <stop_token>
 
 #include "../FFmpeg/Decoder.hpp"
+#include "../FFmpeg/AudioFilterGraph.hpp"
+#include "../Diagnostics/Metrics.hpp"
+#include "PCMRingBuffer.hpp"
+#include "VoiceSink.hpp"
 
 namespace Orchestra
 {
@@ -25,24 +30,38 @@ namespace Orchestra
             bool IsEmpty() const { return !decibelsBoost && !frequency && !bandwidth; }
         };
     public:
-        Player(uint32_t sentPacketsSize = 0, bool enableLogSentPackets = false);
+        Player(uint32_t sentPacketsSize = 0, uint32_t decodeAheadBufferSize = 0, bool enableLogSentPackets = false, bool useNativeEqualizer = false);
 
         Player(const Player& other);
         Player& operator=(const Player& other);
         Player(Player&& other) noexcept;
         Player& operator=(Player&& other) noexcept;
 
-        //blocks current thread
-        void DecodeAndSendAudio(const dpp::voiceconn* voice);
+        //blocks current thread, the decoding itself runs ahead on another thread
+        void DecodeAndSendAudio(VoiceSink& voiceSink);
 
+        //also cancels opening of a decoder
         void Stop();
+        //must be called on every voice buffer event of the voice client, wakes DecodeAndSendAudio up, when the voice client is about to run out of audio
+        void OnVoiceBufferSent(float remainingSeconds);
         void Pause(bool pause);
+        //also cancels opening of a decoder
         void Skip();
+        //aborts SetDecoder, which is opening a url right now, and the reads of the current decoder which wait for the network
+        void CancelOpening();
         
         void SkipToSeconds(float seconds);
         void SkipSeconds(float seconds);
 
-        void SetDecoder(const std::string_view& url, int sampleRate = Decoder::DEFAULT_SAMPLE_RATE);
+        //if audioCacheKey isn't empty, the downloaded audio is stored in AudioCache with it. Returns false if the opening has been cancelled by CancelOpening, Skip or Stop
+        bool SetDecoder(const std::string_view& url, float speed = 1.f, const std::string_view& audioCacheKey = "", const AudioFormatHints& formatHints = {});
+
+        //opens a decoder for the next track and decodes PREFETCH_PRIMED_SECONDS of it, so it can be played without a gap. Blocks current thread.
+        //it is cancelled by CancelPrefetch, Stop or stopToken, even if it hasn't started yet when stopToken is requested
+        void Prefetch(size_t uniqueIndex, const std::string_view& url, const std::string_view& audioCacheKey = "", const AudioFormatHints& formatHints = {}, std::stop_token stopToken = {});
+        //replaces the current decoder with the prefetched one, returns false if the prefetched decoder is not of the track with uniqueIndex
+        bool SetPrefetchedDecoder(size_t uniqueIndex, float speed = 1.f);
+        void CancelPrefetch();
 
         void ResetDecoder();
         bool IsDecoderReady() const;
@@ -55,21 +74,45 @@ namespace Orchestra
         void ClearEqualizer();
 
     public:
-        void SetAudioSampleRate(int sampleRate);
-        int GetAudioSampleRate() const;
+        static constexpr float PREFETCH_PRIMED_SECONDS = 5.f;
+        //the next packet is filtered and sent when the voice client has less audio than this, so the filters' changes are heard that fast
+        static constexpr float VOICE_BUFFER_LOW_WATER_SECONDS = .1f;
+        //the voice client encodes raw audio into opus frames of this length, 60ms
+        static constexpr size_t OPUS_FRAME_SAMPLES = 2880;
+        //the filters are applied before sending, so a bigger packet delays their changes by its length(older Guilds.cfg have 700000 for every guild). 4 frames, 240ms
+        static constexpr uint32_t MAX_SENT_PACKET_SIZE = OPUS_FRAME_SAMPLES * AudioFilterGraph::OUT_CHANNELS_COUNT * sizeof(int16_t) * 4;
+
+    public:
+        //is applied right away, without decoding again
+        void SetSpeed(float speed);
+        float GetSpeed() const;
+        //whether the speed is changed by time-stretching instead of resampling, which changes the pitch too
+        void SetPreservePitch(bool preservePitch);
+        bool GetPreservePitch() const;
+        //whether bass boost and equalizer are done by BiquadEqualizer instead of libavfilter
+        void SetUseNativeEqualizer(bool useNativeEqualizer);
+        bool GetUseNativeEqualizer() const;
 
         void SetEnableLogSentPackets(bool enable);
         void SetSentPacketSize(uint32_t size);
+        //is applied on the next DecodeAndSendAudio
+        void SetDecodeAheadBufferSize(uint32_t size);
 
         bool GetIsPaused() const noexcept;
         bool GetIsDecoding() const noexcept;
 
         bool GetEnableLogSentPackets() const noexcept;
         uint32_t GetSentPacketSize() const noexcept;
+        uint32_t GetDecodeAheadBufferSize() const noexcept;
 
         float GetCurrentTimestamp() const;
         //if return is 0, then there are no decoders
         float GetTotalDuration() const;
+        //operator new calls made by the decoding path of the current(or the last) track per second of decoded audio, should be 0 in steady state.
+        //FFmpeg's own allocations aren't counted, and it is always 0 if AllocationsCounter::IS_ENABLED is false
+        float GetDecodingAllocationsPerSecond() const noexcept;
+        //how many times the current(or the last) track had to wait for decoding while the voice client was running out of audio
+        uint64_t GetUnderrunsCount() const noexcept;
 
         const BassBoostSettings& GetBassBoostSettings() const;
 
@@ -80,7 +123,28 @@ namespace Orchestra
         bool HasDecoderFinished() const;
 
     private:
-        void LazyDecodingCheck(const std::chrono::milliseconds& toWait, std::unique_lock<std::mutex>& pauseLock, const std::chrono::milliseconds& sleepFor = std::chrono::milliseconds(10));
+        //fills m_DecodeAheadBuffer till m_IsDecoding is false, runs on its own thread. The time spent in decoding is added to decodingNanoseconds
+        void DecodeAhead(Metrics::Counter& decodingNanoseconds);
+
+        size_t GetDecodeAheadBufferCapacity(const Decoder& decoder) const;
+        //decodes the current packet into the buffer, frameSize bytes of it must be writable
+        static size_t DecodeFrameTo(const Decoder& decoder, PCMRingBuffer& buffer, std::vector<uint8_t>& wrappedFrameBuffer, size_t frameSize);
+
+        //whether the decoder's packets can be sent to the voice client without decoding, which is possible only without filters and speed
+        bool CanSendOpusPackets(const Decoder& decoder);
+        //replaces the source with a new one, so the previous requests don't affect the next decoder, returns the new token
+        std::stop_token RenewStopSource(std::stop_source& stopSource);
+        void RequestStop(std::stop_source& stopSource);
+
+        //sends the packets of m_Decoder as they are, returns false if the playback has to be continued by decoding, because a filter has been enabled
+        bool SendOpusPackets(VoiceSink& voiceSink, uint64_t& totalSentPackets, uint64_t& totalSentSize, std::chrono::steady_clock::time_point playbackBeginning);
+        //records the spans of the track in PlaybackTracer, it is called once the first audio of the track has been sent
+        void TraceFirstSend(const VoiceSink& voiceSink, std::chrono::steady_clock::time_point playbackBeginning) const;
+
+        //returns when the voice client has less than VOICE_BUFFER_LOW_WATER_SECONDS of audio or the sender has something else to do
+        void WaitForVoiceBufferLow(VoiceSink& voiceSink, std::unique_lock<std::mutex>& pauseLock);
+        //wakes the sender up after m_IsSkippingFrames has been set
+        void NotifySender();
 
     private:
         void CopyFrom(const Player& other);
@@ -89,25 +153,56 @@ namespace Orchestra
         Decoder m_Decoder;
 
         uint32_t m_SentPacketSize;
+        uint32_t m_DecodeAheadBufferSize;
         bool m_EnableLogSentPackets : 1;
 
+        //DecodeAhead is the producer, DecodeAndSendAudio is the consumer
+        PCMRingBuffer m_DecodeAheadBuffer;
+        std::atomic_bool m_HasDecodingFinished;
+        std::exception_ptr m_DecodeAheadException;
+        std::atomic_uint64_t m_UnderrunsCount;
+        //whether m_DecodeAheadBuffer already contains the beginning of the track from the prefetched decoder
+        bool m_HasPrimedAudio : 1;
+
+        //the next track, is not copied or moved
+        Decoder m_PrefetchedDecoder;
+        PCMRingBuffer m_PrefetchedBuffer;
+        size_t m_PrefetchedUniqueIndex;
+        std::mutex m_PrefetchMutex;
+        std::atomic_bool m_IsPrefetchCancelled;
+
+        //the tokens of m_Decoder and m_PrefetchedDecoder, are not copied or moved
+        std::stop_source m_DecoderStopSource;
+        std::stop_source m_PrefetchStopSource;
+        std::mutex m_StopSourcesMutex;
+
         std::mutex m_DecodingMutex;
 
         std::atomic_bool m_IsDecoding;
         std::atomic_bool m_IsSkippingFrames;
-        std::atomic_bool m_ShouldReturnToCurrentTimestamp;
-
-        std::atomic_int m_PreviousSampleRate;
+        //is applied by the consumer when m_IsSkippingFrames is true
+        std::atomic<float> m_SkipToTimestamp;
 
         std::atomic_bool m_IsPaused;
         std::condition_variable m_PauseCondition;
         std::mutex m_PauseMutex;
 
-        //this one DOESN'T show the current timestamp in real time, but it shows till which seconds frames have been decoded
+        std::atomic_bool m_IsWaitingForVoiceBuffer;
+        std::atomic_bool m_IsVoiceBufferLow;
+
+        //this one DOESN'T show the current timestamp in real time, but it shows till which seconds frames have been sent to the voice client
         std::atomic<float> m_CurrentDecodingTimestamp;
 
+        std::atomic<float> m_DecodingAllocationsPerSecond;
+
+        //the filters are applied by the sender right before sending, so it locks this one only for a moment
+        std::mutex m_FilterMutex;
+        AudioFilterGraph m_FilterGraph;
         BassBoostSettings m_BassBoostSettings;
         //first - frequency, second - decibels boost
         std::map<float, float> m_EqualizerFrequencies;
+        std::atomic<float> m_Speed;
+        std::atomic_bool m_PreservePitch;
+        std::atomic_bool m_UseNativeEqualizer;
     };
 }
\ No newline at end of file
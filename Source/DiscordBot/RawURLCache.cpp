@@ -0,0 +1,253 @@
+#include "RawURLCache.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <cctype>
+#include <algorithm>
+
+#include <GuelderConsoleLog.hpp>
+
+#include "../Utils.hpp"
+
+//private
+namespace Orchestra
+{
+    namespace
+    {
+        struct RawURLCacheEntry
+        {
+            std::string rawURL;
+            //unix seconds
+            int64_t expireTimestamp;
+            AudioFormatHints formatHints;
+        };
+
+        std::unordered_map<std::string, RawURLCacheEntry> s_Entries;
+        std::mutex s_Mutex;
+
+        std::ofstream s_File;
+
+        uint64_t s_Hits = 0;
+        uint64_t s_Misses = 0;
+        uint64_t s_Expired = 0;
+
+        int64_t GetCurrentTimestamp()
+        {
+            return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+        bool IsEntryAlive(const RawURLCacheEntry& entry, int64_t currentTimestamp)
+        {
+            return entry.expireTimestamp - RawURLCache::EXPIRE_MARGIN.count() > currentTimestamp;
+        }
+        int64_t CalculateExpireTimestamp(const std::string_view& rawURL)
+        {
+            const int64_t expireTimestamp = RawURLCache::ParseExpireTimestamp(rawURL);
+
+            if(expireTimestamp)
+                return expireTimestamp;
+
+            return GetCurrentTimestamp() + RawURLCache::EXPIRE_MARGIN.count() + RawURLCache::DEFAULT_LIFETIME.count();
+        }
+        //"-" stands for an empty string, so the fields stay separated by spaces
+        std::string_view WriteField(const std::string_view& field)
+        {
+            return field.empty() ? "-" : field;
+        }
+        std::string ReadField(std::string field)
+        {
+            return field == "-" ? std::string{} : std::move(field);
+        }
+
+        //one entry per line: expireTimestamp url rawURL container codec sampleRate channelsCount. Urls cannot contain spaces, so they are used as separators.
+        //the lines of older files end after rawURL, they are read without the hints. An erased entry is written with expireTimestamp 0
+        void WriteEntry(std::ostream& stream, const std::string_view& url, const RawURLCacheEntry& entry)
+        {
+            const AudioFormatHints& hints = entry.formatHints;
+
+            stream << entry.expireTimestamp << ' ' << url << ' ' << WriteField(entry.rawURL) << ' ' << WriteField(hints.container) << ' ' << WriteField(hints.codec) << ' ' << hints.sampleRate << ' ' << hints.channelsCount << '\n';
+        }
+    }
+}
+namespace Orchestra
+{
+    void RawURLCache::Load(const std::filesystem::path& path)
+    {
+        std::lock_guard lock{ s_Mutex };
+
+        const int64_t currentTimestamp = GetCurrentTimestamp();
+
+        size_t loadedCount = 0;
+
+        {
+            std::ifstream file{ path };
+
+            std::string line;
+
+            while(std::getline(file, line))
+            {
+                std::istringstream lineStream{ line };
+
+                int64_t expireTimestamp;
+                std::string url;
+                std::string rawURL;
+
+                if(!(lineStream >> expireTimestamp >> url >> rawURL))
+                    continue;
+
+                RawURLCacheEntry entry{ ReadField(std::move(rawURL)), expireTimestamp, {} };
+
+                std::string container;
+                std::string codec;
+
+                if(lineStream >> container >> codec >> entry.formatHints.sampleRate >> entry.formatHints.channelsCount)
+                {
+                    entry.formatHints.container = ReadField(std::move(container));
+                    entry.formatHints.codec = ReadField(std::move(codec));
+                }
+                else
+                    entry.formatHints = {};
+
+                //the file is append-only, so the later entries are newer
+                if(IsEntryAlive(entry, currentTimestamp))
+                    s_Entries.insert_or_assign(std::move(url), std::move(entry));
+                else
+                    s_Entries.erase(url);
+
+                loadedCount++;
+            }
+        }
+
+        //rewriting the file without expired and overwritten entries, so it does not grow forever
+        s_File = std::ofstream{ path, std::ios::trunc };
+
+        O_ASSERT(s_File.is_open(), "Failed to open raw url cache file ", path.string());
+
+        for(const auto& [url, entry] : s_Entries)
+            WriteEntry(s_File, url, entry);
+
+        s_File.flush();
+
+        GE_LOG(Orchestra, Info, "Loaded ", s_Entries.size(), " raw urls out of ", loadedCount, " from ", path.string(), '.');
+    }
+
+    std::optional<RawURLCache::Entry> RawURLCache::Find(const std::string_view& url)
+    {
+        std::lock_guard lock{ s_Mutex };
+
+        const auto found = s_Entries.find(std::string{ url });
+
+        if(found == s_Entries.end())
+        {
+            s_Misses++;
+            return std::nullopt;
+        }
+
+        if(!IsEntryAlive(found->second, GetCurrentTimestamp()))
+        {
+            s_Entries.erase(found);
+
+            s_Expired++;
+            s_Misses++;
+            return std::nullopt;
+        }
+
+        s_Hits++;
+
+        return Entry{ found->second.rawURL, found->second.formatHints };
+    }
+    void RawURLCache::Insert(const std::string_view& url, std::string rawURL, AudioFormatHints formatHints)
+    {
+        if(url.empty() || rawURL.empty())
+            return;
+
+        RawURLCacheEntry entry{ std::move(rawURL), 0, std::move(formatHints) };
+        entry.expireTimestamp = CalculateExpireTimestamp(entry.rawURL);
+
+        std::lock_guard lock{ s_Mutex };
+
+        if(s_File.is_open())
+        {
+            WriteEntry(s_File, url, entry);
+            s_File.flush();
+        }
+
+        s_Entries.insert_or_assign(std::string{ url }, std::move(entry));
+
+        GE_LOG(Orchestra, Info, "Cached raw url of ", url, ". Raw url cache hits: ", s_Hits, ", misses: ", s_Misses, ", size: ", s_Entries.size(), '.');
+    }
+    void RawURLCache::Erase(const std::string_view& url)
+    {
+        std::lock_guard lock{ s_Mutex };
+
+        if(!s_Entries.erase(std::string{ url }))
+            return;
+
+        //the file is append-only, so the erased entry is overwritten by one, which Load drops as expired
+        if(s_File.is_open())
+        {
+            WriteEntry(s_File, url, {});
+            s_File.flush();
+        }
+
+        GE_LOG(Orchestra, Info, "Erased raw url of ", url, " from the cache.");
+    }
+
+    int64_t RawURLCache::ParseExpireTimestamp(const std::string_view& rawURL)
+    {
+        constexpr std::string_view expireParamName = "expire";
+
+        //googlevideo has expire=..., some manifests have /expire/.../, CloudFront(soundcloud) has Expires=...
+        for(size_t position = 0; position + expireParamName.size() < rawURL.size(); position++)
+        {
+            const bool isName = std::ranges::equal(rawURL.substr(position, expireParamName.size()), expireParamName, [](char a, char b) { return std::tolower(static_cast<unsigned char>(a)) == b; });
+
+            if(!isName)
+                continue;
+
+            //the name must be a whole parameter, not a part of another one
+            if(position && rawURL[position - 1] != '?' && rawURL[position - 1] != '&' && rawURL[position - 1] != '/')
+                continue;
+
+            size_t valuePosition = position + expireParamName.size();
+
+            if(valuePosition < rawURL.size() && std::tolower(static_cast<unsigned char>(rawURL[valuePosition])) == 's')
+                valuePosition++;
+
+            if(valuePosition >= rawURL.size() || (rawURL[valuePosition] != '=' && rawURL[valuePosition] != '/'))
+                continue;
+
+            valuePosition++;
+
+            int64_t timestamp = 0;
+
+            for(; valuePosition < rawURL.size() && std::isdigit(static_cast<unsigned char>(rawURL[valuePosition])); valuePosition++)
+                timestamp = timestamp * 10 + (rawURL[valuePosition] - '0');
+
+            if(timestamp)
+                return timestamp;
+        }
+
+        return 0;
+    }
+    bool RawURLCache::HasRawURLExpired(const std::string_view& rawURL)
+    {
+        const int64_t expireTimestamp = ParseExpireTimestamp(rawURL);
+
+        return expireTimestamp && !IsEntryAlive({ {}, expireTimestamp, {} }, GetCurrentTimestamp());
+    }
+}
+//getters, setters
+namespace Orchestra
+{
+    RawURLCache::Stats RawURLCache::GetStats()
+    {
+        std::lock_guard lock{ s_Mutex };
+
+        return { s_Hits, s_Misses, s_Expired, s_Entries.size() };
+    }
+}
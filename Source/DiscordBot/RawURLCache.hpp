@@ -0,0 +1,64 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "../FFmpeg/AudioFormatHints.hpp"
+
+namespace Orchestra
+{
+    //process-wide cache of raw audio urls, the key is a webpage url(e.g. https://www.youtube.com/watch?v=...).
+    //raw urls usually have an expire timestamp(googlevideo ones do), entries are not returned after it
+    class RawURLCache
+    {
+    public:
+        struct Entry
+        {
+            std::string rawURL;
+            //describe the raw url, empty if yt-dlp hasn't given them
+            AudioFormatHints formatHints;
+        };
+        struct Stats
+        {
+            uint64_t hits;
+            uint64_t misses;
+            //entries which were found, but had already expired
+            uint64_t expired;
+            size_t size;
+        };
+
+    public:
+        RawURLCache() = delete;
+        RawURLCache(const RawURLCache&) = delete;
+        RawURLCache(RawURLCache&&) = delete;
+        RawURLCache& operator=(const RawURLCache&) = delete;
+        RawURLCache& operator=(RawURLCache&&) = delete;
+        ~RawURLCache() = delete;
+
+    public:
+        //loads not expired entries from the file and then appends new ones to it. If it is never called, the cache lives only in memory
+        static void Load(const std::filesystem::path& path);
+
+        static std::optional<Entry> Find(const std::string_view& url);
+        static void Insert(const std::string_view& url, std::string rawURL, AudioFormatHints formatHints = {});
+        //e.g. the raw url has failed to open(403 or a revoked signature), so it is resolved again instead of being served till it expires
+        static void Erase(const std::string_view& url);
+
+        //returns 0 if the raw url does not have an expire parameter
+        static int64_t ParseExpireTimestamp(const std::string_view& rawURL);
+        //whether the raw url expires too soon to be played
+        static bool HasRawURLExpired(const std::string_view& rawURL);
+
+        static Stats GetStats();
+
+    public:
+        //a track has to be played before the raw url expires
+        static constexpr std::chrono::seconds EXPIRE_MARGIN{ 30 * 60 };
+        //it is unknown how long raw urls without the expire parameter live
+        static constexpr std::chrono::seconds DEFAULT_LIFETIME{ 60 * 60 };
+    };
+}
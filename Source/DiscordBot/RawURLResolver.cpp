@@ -0,0 +1,204 @@
+#include "RawURLResolver.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+
+#include <GuelderConsoleLog.hpp>
+
+#include "../Utils.hpp"
+#include "Yt_DlpManager.hpp"
+
+namespace Orchestra
+{
+    struct RawURLResolverState
+    {
+        std::filesystem::path yt_dlpExecutablePath;
+        RawURLResolver::OnResolved onResolved;
+
+        std::deque<RawURLResolver::Request> pendingRequests;
+        std::vector<size_t> resolvingUniqueIndices;
+        //whether it is in s_QueuedStates
+        bool isQueued = false;
+
+        //stopped by the destructor of the resolver, so the requests being resolved are cancelled
+        std::stop_source stopSource;
+
+        //held while onResolved is called, so the destructor of the resolver doesn't return while it runs
+        std::mutex callbackMutex;
+        bool isDestroyed = false;
+    };
+}
+//private
+namespace Orchestra
+{
+    namespace
+    {
+        //guards the states and the threads below
+        std::mutex s_Mutex;
+        std::condition_variable_any s_RequestsCondition;
+
+        //the resolvers which have pending requests, each one resolves a request and goes to the back, so a long queue of one guild doesn't hold up the others
+        std::deque<std::shared_ptr<RawURLResolverState>> s_QueuedStates;
+
+        size_t s_ThreadsCount = 0;
+        size_t s_IdleThreadsCount = 0;
+
+        struct ResolvingThread
+        {
+            bool hasExited = false;
+            //declared last, so it is joined before hasExited is destroyed
+            std::jthread thread;
+        };
+
+        //declared last, so the threads are joined before the rest is destroyed
+        std::list<ResolvingThread> s_Threads;
+
+        void ResolveRequests(std::stop_token stopToken, bool& hasExited)
+        {
+            std::unique_lock lock{ s_Mutex };
+
+            while(true)
+            {
+                s_IdleThreadsCount++;
+
+                const bool hasRequests = s_RequestsCondition.wait_for(lock, stopToken, RawURLResolver::IDLE_THREAD_TIMEOUT, [] { return !s_QueuedStates.empty(); });
+
+                s_IdleThreadsCount--;
+
+                if(!hasRequests || stopToken.stop_requested())
+                {
+                    s_ThreadsCount--;
+                    hasExited = true;
+                    return;
+                }
+
+                const std::shared_ptr<RawURLResolverState> state = std::move(s_QueuedStates.front());
+                s_QueuedStates.pop_front();
+
+                //its requests may have been cancelled
+                if(state->pendingRequests.empty())
+                {
+                    state->isQueued = false;
+                    continue;
+                }
+
+                RawURLResolver::Request request = std::move(state->pendingRequests.front());
+                state->pendingRequests.pop_front();
+
+                if(state->pendingRequests.empty())
+                    state->isQueued = false;
+                else
+                    s_QueuedStates.push_back(state);
+
+                state->resolvingUniqueIndices.push_back(request.uniqueIndex);
+
+                const std::filesystem::path yt_dlpExecutablePath = state->yt_dlpExecutablePath;
+                const RawURLResolver::OnResolved onResolved = state->onResolved;
+
+                lock.unlock();
+
+                try
+                {
+                    //a long one, but the cache may already have it. The commands go to the workers first
+                    std::string rawURL = Yt_DlpManager::GetRawURLFromURL(yt_dlpExecutablePath, request.URL, state->stopSource.get_token(), Yt_DlpWorkerPool::Priority::Background);
+
+                    std::lock_guard callbackLock{ state->callbackMutex };
+
+                    if(!state->isDestroyed && onResolved)
+                        onResolved(request.uniqueIndex, std::move(rawURL));
+                }
+                catch(const OrchestraException& e)
+                {
+                    if(!state->stopSource.stop_requested())
+                        GE_LOG(Orchestra, Warning, "Failed to resolve raw url of ", request.URL, ": ", e.GetFullMessage());
+                }
+                catch(const std::exception& e)
+                {
+                    GE_LOG(Orchestra, Warning, "Failed to resolve raw url of ", request.URL, ": ", e.what());
+                }
+
+                lock.lock();
+
+                std::erase(state->resolvingUniqueIndices, request.uniqueIndex);
+            }
+        }
+        //must be called under s_Mutex
+        void LaunchThreads(size_t requestsCount)
+        {
+            //the exited ones have already returned or are about to
+            s_Threads.remove_if([](const ResolvingThread& thread) { return thread.hasExited; });
+
+            const size_t busyThreadsCount = s_ThreadsCount - s_IdleThreadsCount;
+            const size_t neededThreadsCount = std::min(RawURLResolver::CONCURRENCY, busyThreadsCount + requestsCount);
+
+            for(; s_ThreadsCount < neededThreadsCount; s_ThreadsCount++)
+            {
+                ResolvingThread& thread = s_Threads.emplace_back();
+                thread.thread = std::jthread{ [&hasExited = thread.hasExited](std::stop_token stopToken) { ResolveRequests(stopToken, hasExited); } };
+            }
+        }
+    }
+}
+namespace Orchestra
+{
+    RawURLResolver::RawURLResolver()
+        : m_State(std::make_shared<RawURLResolverState>()) {}
+    RawURLResolver::~RawURLResolver()
+    {
+        Cancel();
+
+        m_State->stopSource.request_stop();
+
+        std::lock_guard callbackLock{ m_State->callbackMutex };
+        m_State->isDestroyed = true;
+    }
+
+    void RawURLResolver::Resolve(const std::filesystem::path& yt_dlpExecutablePath, std::vector<Request> requests, OnResolved onResolved)
+    {
+        {
+            std::lock_guard lock{ s_Mutex };
+
+            m_State->yt_dlpExecutablePath = yt_dlpExecutablePath;
+            m_State->onResolved = std::move(onResolved);
+
+            m_State->pendingRequests.clear();
+
+            for(auto& request : requests)
+                if(!request.URL.empty() && std::ranges::find(m_State->resolvingUniqueIndices, request.uniqueIndex) == m_State->resolvingUniqueIndices.end())
+                    m_State->pendingRequests.push_back(std::move(request));
+
+            if(m_State->pendingRequests.empty())
+                return;
+
+            if(!m_State->isQueued)
+            {
+                s_QueuedStates.push_back(m_State);
+                m_State->isQueued = true;
+            }
+
+            LaunchThreads(m_State->pendingRequests.size());
+        }
+
+        s_RequestsCondition.notify_all();
+    }
+    void RawURLResolver::Cancel()
+    {
+        std::lock_guard lock{ s_Mutex };
+
+        m_State->pendingRequests.clear();
+    }
+}
+//getters, setters
+namespace Orchestra
+{
+    size_t RawURLResolver::GetPendingRequestsCount() const
+    {
+        std::lock_guard lock{ s_Mutex };
+        return m_State->pendingRequests.size();
+    }
+}
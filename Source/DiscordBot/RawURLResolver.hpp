@@ -0,0 +1,57 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Orchestra
+{
+    struct RawURLResolverState;
+
+    //resolves raw urls of upcoming tracks on background threads, which are shared by all resolvers, not more than CONCURRENCY at a time.
+    //requests of a resolver are started in the order they were given, so the closest tracks in the queue are resolved first, and resolvers take turns
+    class RawURLResolver
+    {
+    public:
+        struct Request
+        {
+            size_t uniqueIndex;
+            std::string URL;
+        };
+        //called from a resolving thread
+        using OnResolved = std::function<void(size_t uniqueIndex, std::string rawURL)>;
+
+    public:
+        RawURLResolver();
+        //cancels the requests which are being resolved and waits only for onResolved, which is being called
+        ~RawURLResolver();
+
+        RawURLResolver(const RawURLResolver&) = delete;
+        RawURLResolver(RawURLResolver&&) = delete;
+        RawURLResolver& operator=(const RawURLResolver&) = delete;
+        RawURLResolver& operator=(RawURLResolver&&) = delete;
+
+        //replaces not started requests, the ones which are already being resolved are skipped
+        void Resolve(const std::filesystem::path& yt_dlpExecutablePath, std::vector<Request> requests, OnResolved onResolved);
+        //drops not started requests, the ones which are being resolved still call onResolved
+        void Cancel();
+
+    public:
+        size_t GetPendingRequestsCount() const;
+
+    public:
+        //how many requests of all resolvers are resolved at a time
+        static constexpr size_t CONCURRENCY = 3;
+        //a resolving thread exits after it has been idle for this long, so idle bots do not have threads
+        static constexpr std::chrono::seconds IDLE_THREAD_TIMEOUT{ 30 };
+        //how many tracks after the current one are resolved
+        static constexpr size_t RESOLVED_AHEAD_TRACKS_COUNT = 8;
+
+    private:
+        //it is shared with the resolving threads, so they don't touch the resolver after its destruction
+        std::shared_ptr<RawURLResolverState> m_State;
+    };
+}
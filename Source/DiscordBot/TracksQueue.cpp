@@ -5,6 +5,9 @@
 #include <string_view>
 #include <random>
 #include <algorithm>
+#include <memory>
+#include <utility>
+#include <optional>
 
 #include "Yt_DlpManager.hpp"
 
@@ -17,17 +20,42 @@ namespace Orchestra
     TracksQueue::TracksQueue(std::filesystem::path yt_dlpExecutablePath)
         : m_Yt_DlpManager(std::move(yt_dlpExecutablePath)) {}
 
+    TracksQueue::TracksQueue(const TracksQueue& other)
+    {
+        CopyFrom(other);
+    }
+    TracksQueue& TracksQueue::operator=(const TracksQueue& other)
+    {
+        CopyFrom(other);
+
+        return *this;
+    }
+    TracksQueue::TracksQueue(TracksQueue&& other) noexcept
+    {
+        MoveFrom(std::move(other));
+    }
+    TracksQueue& TracksQueue::operator=(TracksQueue&& other) noexcept
+    {
+        MoveFrom(std::move(other));
+
+        return *this;
+    }
+
     void TracksQueue::FetchURL(const std::filesystem::path& yt_dlpExecutablePath, const std::string_view& url, std::mt19937 randomEngine, bool doShuffle, float speed, size_t repeat, size_t insertIndex, bool lookForRawURLOfOneTrack)
     {
         m_Yt_DlpManager.FetchURL(yt_dlpExecutablePath, url);
 
-        AdjustInsertIndex(insertIndex);
-
         if(m_Yt_DlpManager.IsPlaylist())
         {
-            size_t playlistSize = m_Yt_DlpManager.GetPlaylistSize();
+            //the tracks of a playlist are parsed from the json, which has been already got
+            const ChangePublisher changePublisher{ *this };
+
+            AdjustInsertIndex(insertIndex);
+
+            const size_t playlistSize = m_Yt_DlpManager.GetPlaylistSize();
 
-            m_Tracks.reserve(m_Tracks.size() + playlistSize);
+            //the tracks inserted into a playlist become its part
+            const bool isThisPlaylistInnerPlaylist = FindPlaylistIndex(insertIndex).has_value();
 
             std::vector<int> indices;
             indices.resize(playlistSize);
@@ -38,40 +66,21 @@ namespace Orchestra
             if(doShuffle)
                 std::ranges::shuffle(indices, randomEngine);
 
-            size_t exceptionCounter = 0;
+            size_t insertedTracksCount = 0;
             for(size_t i = 0; i < indices.size(); i++)
                 try
                 {
-                    InsertTrackInfo(insertIndex + (i - exceptionCounter), m_Yt_DlpManager.GetTrackInfo(yt_dlpExecutablePath, indices[i], false), speed, repeat);
+                    InsertTrackInfo(insertIndex + insertedTracksCount, m_Yt_DlpManager.GetTrackInfo(yt_dlpExecutablePath, indices[i], false), speed, repeat);
+                    insertedTracksCount++;
                 }
                 catch(const std::exception& exception)
                 {
-                    exceptionCounter += 2;
                     GE_LOG(Orchestra, Warning, "Exception occured during getting track infos from a playlist, skipping the track. Exception: ", exception.what());
                 }
 
-            playlistSize -= exceptionCounter;
-
-            bool isThisPlaylistInnerPlaylist = false;
-
-            //it is almost the same as AdjustPlaylistInfosIndicesAfterInsertion, but isThisPlaylistInnerPlaylist = true;
-            for(auto&& playlistInfo : m_PlaylistInfos)
-                if(insertIndex < playlistInfo.beginIndex)
-                {
-                    playlistInfo.beginIndex += playlistSize;
-                    playlistInfo.endIndex += playlistSize;
-                }
-                else if(insertIndex >= playlistInfo.beginIndex && insertIndex <= playlistInfo.endIndex)
-                {
-                    isThisPlaylistInnerPlaylist = true;
-
-                    if(insertIndex == playlistInfo.beginIndex)
-                        playlistInfo.beginIndex += playlistSize;
-
-                    playlistInfo.endIndex += playlistSize;
-                }
+            UpdatePlaylistInfosIndices();
 
-            if(!isThisPlaylistInnerPlaylist)
+            if(!isThisPlaylistInnerPlaylist && insertedTracksCount > 0)
             {
                 std::string playlistTitle;
 
@@ -81,14 +90,21 @@ namespace Orchestra
                 }
                 catch(...) {}
 
-                m_PlaylistInfos.emplace_back(std::move(playlistTitle), insertIndex, playlistSize - 1 + insertIndex, 1, s_CurrentUniquePlaylistIndex++);
+                InsertPlaylistInfo(std::move(playlistTitle), insertIndex, insertIndex + insertedTracksCount - 1, 1, s_CurrentUniquePlaylistIndex++);
             }
         }
         else
         {
-            InsertTrackInfo(insertIndex, m_Yt_DlpManager.GetTrackInfo(yt_dlpExecutablePath, 0, lookForRawURLOfOneTrack), speed, repeat);
+            //can call yt-dlp
+            TrackInfo trackInfo = m_Yt_DlpManager.GetTrackInfo(yt_dlpExecutablePath, 0, lookForRawURLOfOneTrack);
 
-            AdjustPlaylistInfosIndicesAfterInsertion(insertIndex, 1);
+            const ChangePublisher changePublisher{ *this };
+
+            AdjustInsertIndex(insertIndex);
+
+            InsertTrackInfo(insertIndex, std::move(trackInfo), speed, repeat);
+
+            UpdatePlaylistInfosIndices();
         }
     }
     void TracksQueue::FetchURL(const std::string_view& url, std::mt19937 randomEngine, bool doShuffle, float speed, size_t repeat, size_t insertIndex, bool lookForRawURL)
@@ -98,13 +114,18 @@ namespace Orchestra
 
     void TracksQueue::FetchSearch(const std::filesystem::path& yt_dlpExecutablePath, const std::string_view& input, SearchEngine searchEngine, float speed, size_t repeat, size_t insertIndex, bool lookForRawURL)
     {
-        AdjustInsertIndex(insertIndex);
-
         m_Yt_DlpManager.FetchSearch(yt_dlpExecutablePath, input, searchEngine);
 
-        InsertTrackInfo(insertIndex, m_Yt_DlpManager.GetTrackInfo(yt_dlpExecutablePath, 0, lookForRawURL), speed, repeat);
+        //can call yt-dlp
+        TrackInfo trackInfo = m_Yt_DlpManager.GetTrackInfo(yt_dlpExecutablePath, 0, lookForRawURL);
+
+        const ChangePublisher changePublisher{ *this };
 
-        AdjustPlaylistInfosIndicesAfterInsertion(insertIndex, 1);
+        AdjustInsertIndex(insertIndex);
+
+        InsertTrackInfo(insertIndex, std::move(trackInfo), speed, repeat);
+
+        UpdatePlaylistInfosIndices();
     }
     void TracksQueue::FetchSearch(const std::string_view& input, SearchEngine searchEngine, float speed, size_t repeat, size_t insertIndex, bool lookForRawURL)
     {
@@ -114,20 +135,26 @@ namespace Orchestra
     //fills rawURL, NOT URL
     void TracksQueue::FetchRaw(std::string url, float speed, size_t repeat, size_t insertIndex)
     {
+        const ChangePublisher changePublisher{ *this };
+
         using namespace GuelderConsoleLog;
 
         AdjustInsertIndex(insertIndex);
 
         InsertTrackInfo(insertIndex, { .rawURL = url, .title = std::move(url) }, speed, repeat);
 
-        AdjustPlaylistInfosIndicesAfterInsertion(insertIndex, 1);
+        UpdatePlaylistInfosIndices();
     }
 
     const TrackInfo& TracksQueue::GetRawTrackURL(const std::filesystem::path& yt_dlpExecutablePath, size_t index)
     {
-        TrackInfo& trackInfo = m_Tracks[index];
+        std::string rawURL = Yt_DlpManager::GetRawURLFromURL(yt_dlpExecutablePath, GetTrackInfo(index).URL);
+
+        const ChangePublisher changePublisher{ *this };
 
-        trackInfo.rawURL = Yt_DlpManager::GetRawURLFromURL(yt_dlpExecutablePath, trackInfo.URL);
+        TrackInfo& trackInfo = AccessTrackInfo(index);
+
+        trackInfo.rawURL = std::move(rawURL);
 
         return trackInfo;
     }
@@ -138,211 +165,361 @@ namespace Orchestra
 
     void TracksQueue::DeleteTrack(size_t index)
     {
-        m_Tracks.erase(m_Tracks.begin() + index);
-
-        for(size_t i = 0; i < m_PlaylistInfos.size();)
-        {
-            PlaylistInfo& playlistInfo = m_PlaylistInfos[i];
-
-            if(index < playlistInfo.beginIndex)
-            {
-                playlistInfo.beginIndex--;
-                playlistInfo.endIndex--;
-            }
-            else if(index <= playlistInfo.endIndex)
-                playlistInfo.endIndex--;
+        const ChangePublisher changePublisher{ *this };
 
-            if(playlistInfo.beginIndex == playlistInfo.endIndex)
-            {
-                m_PlaylistInfos.erase(m_PlaylistInfos.begin() + i);
-                break;
-            }
-
-            i++;
-        }
+        EraseTracks(index, index);
     }
     void TracksQueue::DeleteTracks(size_t from, size_t to)
     {
-        m_Tracks.erase(m_Tracks.begin() + from, m_Tracks.begin() + to + 1);
-
-        const size_t sizeDeleted = to - from + 1;
+        const ChangePublisher changePublisher{ *this };
 
-        for(size_t i = 0; i < m_PlaylistInfos.size();)
-        {
-            PlaylistInfo& playlistInfo = m_PlaylistInfos[i];
-
-            const bool capturesFullRangeOfPlaylist = from <= playlistInfo.beginIndex && to >= playlistInfo.endIndex;
-            bool eraseCurrentPlaylist = false;
-
-            if(capturesFullRangeOfPlaylist)
-                eraseCurrentPlaylist = true;
-            else
-            {
-                if(from < playlistInfo.beginIndex)
-                {
-                    playlistInfo.beginIndex = (sizeDeleted <= playlistInfo.beginIndex ? playlistInfo.beginIndex - sizeDeleted : 0);
-                    playlistInfo.endIndex -= sizeDeleted;
-                }
-                else if(from == playlistInfo.beginIndex)
-                {
-                    playlistInfo.beginIndex = from;
-                    playlistInfo.endIndex -= sizeDeleted;
-                }
-                else if(from > playlistInfo.beginIndex)
-                {
-                    if(from < playlistInfo.endIndex)
-                        playlistInfo.endIndex = from - 1;//as we have deleted this element, so 1 should be here
-                    else if(from == playlistInfo.endIndex)
-                        playlistInfo.endIndex--;
-                }
-
-                eraseCurrentPlaylist = playlistInfo.beginIndex == playlistInfo.endIndex;
-            }
-
-            if(eraseCurrentPlaylist)
-            {
-                m_PlaylistInfos.erase(m_PlaylistInfos.begin() + i);
-                continue;
-            }
-
-            //do not touch this, look at "continue" above
-            i++;
-        }
+        EraseTracks(from, to);
     }
 
     void TracksQueue::TransferTrack(size_t from, size_t to)
     {
+        const ChangePublisher changePublisher{ *this };
+
         //probably it is better to add that tracks that are not present in some playlist do not enter that playlist, but I'm too lazy for this shit
-        Transfer(m_Tracks, from, to);
+        m_Tracks.Move(from, to);
+
+        AnchorPlaylistInfos();
     }
 
     void TracksQueue::Reverse(size_t from, size_t to)
     {
-        std::reverse(m_Tracks.begin() + from, m_Tracks.begin() + to + 1);
+        const ChangePublisher changePublisher{ *this };
+
+        m_Tracks.Reverse(from, to + 1);
+
+        AnchorPlaylistInfos();
     }
 
     void TracksQueue::Clear()
     {
-        m_Tracks.clear();
-        ClearPlaylists();
+        const ChangePublisher changePublisher{ *this };
+
+        m_Tracks.Clear();
+        m_TracksByUniqueIndex.clear();
+        m_PlaylistInfos.clear();
         m_Yt_DlpManager.Reset();
     }
 
     //TODO: use speed
     void TracksQueue::AddPlaylist(size_t start, size_t end, float speed, size_t repeat, std::string name)
     {
-        //check if intersects
-        bool add = true;
-        for(size_t i = 0; i < m_PlaylistInfos.size(); i += add)
-        {
-            add = true;
-            PlaylistInfo& playlist = m_PlaylistInfos[i];
+        const ChangePublisher changePublisher{ *this };
 
-            if(start <= playlist.beginIndex && end >= playlist.beginIndex || start >= playlist.beginIndex && start < playlist.endIndex)
-            {
-                m_PlaylistInfos.erase(m_PlaylistInfos.begin() + i);
+        O_ASSERT(start <= end && end < m_Tracks.GetSize(), "Cannot add a playlist from ", start, " to ", end, '.');
 
-                add = false;
-            }
-        }
+        //the playlists never intersect
+        std::erase_if(m_PlaylistInfos, [start, end](const PlaylistInfo& playlist) { return start <= playlist.endIndex && end >= playlist.beginIndex; });
 
         //but if there is current track, ...
-        for(size_t i = start; i < end + 1; i++)
-            m_Tracks[i].speed = speed;
+        m_Tracks.ForEach(start, end + 1, [speed](Tracks::Node& node)
+            {
+                node.value.info.speed = speed;
+                node.value.published.reset();
+            });
 
-        m_PlaylistInfos.emplace_back(std::move(name), start, end, repeat);
+        InsertPlaylistInfo(std::move(name), start, end, repeat, s_CurrentUniquePlaylistIndex++);
     }
 
     void TracksQueue::DeletePlaylist(size_t index)
     {
+        const ChangePublisher changePublisher{ *this };
+
         m_PlaylistInfos.erase(m_PlaylistInfos.begin() + index);
     }
 
     void TracksQueue::ClearPlaylists()
     {
+        const ChangePublisher changePublisher{ *this };
+
         m_PlaylistInfos.clear();
     }
 
     //idk
     void TracksQueue::Shuffle(std::mt19937& randomEngine, size_t from, size_t to, size_t indexToSetFirst)
     {
+        const ChangePublisher changePublisher{ *this };
+
         if(indexToSetFirst == std::numeric_limits<size_t>::max())
-            std::shuffle(m_Tracks.begin() + from, m_Tracks.begin() + to, randomEngine);
+            m_Tracks.Shuffle(from, to, randomEngine);
         else
         {
-            TransferTrack(indexToSetFirst, from);
-            std::shuffle(m_Tracks.begin() + from + 1, m_Tracks.begin() + to, randomEngine);
+            m_Tracks.Move(indexToSetFirst, from);
+            m_Tracks.Shuffle(from + 1, to, randomEngine);
         }
+
+        AnchorPlaylistInfos();
     }
 
 }
 //getters, setters
 namespace Orchestra
 {
-    const std::vector<TrackInfo>& TracksQueue::GetTrackInfos() const { return m_Tracks; }
-    const TrackInfo& TracksQueue::GetTrackInfo(size_t index) const { return m_Tracks[index]; }
+    std::shared_ptr<const TracksQueueSnapshot> TracksQueue::GetSnapshot() const
+    {
+        static const auto emptySnapshot = std::make_shared<const TracksQueueSnapshot>();
+
+        auto snapshot = m_Snapshot.load();
+
+        return snapshot ? snapshot : emptySnapshot;
+    }
+
+    const TrackInfo& TracksQueue::GetTrackInfo(size_t index) const { return m_Tracks[index].info; }
+    std::optional<size_t> TracksQueue::FindTrackIndex(size_t uniqueIndex) const
+    {
+        const auto found = m_TracksByUniqueIndex.find(uniqueIndex);
+
+        if(found == m_TracksByUniqueIndex.end())
+            return std::nullopt;
+
+        return m_Tracks.GetIndex(found->second);
+    }
     const std::vector<PlaylistInfo>& TracksQueue::GetPlaylistInfos() const { return m_PlaylistInfos; }
     const PlaylistInfo& TracksQueue::GetPlaylistInfo(size_t index) const { return m_PlaylistInfos[index]; }
-    size_t TracksQueue::GetTracksSize() const { return m_Tracks.size(); }
+    std::optional<size_t> TracksQueue::FindPlaylistIndex(size_t trackIndex) const
+    {
+        //the first one which begins after the track, so only the one before it can contain the track
+        const auto found = std::ranges::upper_bound(m_PlaylistInfos, trackIndex, {}, &PlaylistInfo::beginIndex);
+
+        if(found == m_PlaylistInfos.begin() || trackIndex > std::prev(found)->endIndex)
+            return std::nullopt;
+
+        return std::prev(found) - m_PlaylistInfos.begin();
+    }
+    size_t TracksQueue::GetTracksSize() const { return m_Tracks.GetSize(); }
 
     size_t TracksQueue::GetPlaylistsSize() const { return m_PlaylistInfos.size(); }
 
-    void TracksQueue::SetTrackTitle(size_t index, std::string title) { m_Tracks[index].title = std::move(title); }
-    void TracksQueue::SetTrackDuration(size_t index, float duration) { m_Tracks[index].duration = duration; }
-    void TracksQueue::SetTrackSpeed(size_t index, float speed) { m_Tracks[index].speed = speed; }
-    void TracksQueue::SetTrackRepeatCount(size_t index, size_t repeatCount) { m_Tracks[index].repeat = repeatCount; }
-    void TracksQueue::SetTrackRawURL(size_t index, std::string rawURL) { m_Tracks[index].rawURL = std::move(rawURL); }
+    void TracksQueue::SetTrackTitle(size_t index, std::string title)
+    {
+        const ChangePublisher changePublisher{ *this };
+
+        AccessTrackInfo(index).title = std::move(title);
+    }
+    void TracksQueue::SetTrackDuration(size_t index, float duration)
+    {
+        const ChangePublisher changePublisher{ *this };
+
+        AccessTrackInfo(index).duration = duration;
+    }
+    void TracksQueue::SetTrackSpeed(size_t index, float speed)
+    {
+        const ChangePublisher changePublisher{ *this };
+
+        AccessTrackInfo(index).speed = speed;
+    }
+    void TracksQueue::SetTrackRepeatCount(size_t index, size_t repeatCount)
+    {
+        const ChangePublisher changePublisher{ *this };
 
-    void TracksQueue::SetPlaylistTitle(size_t index, std::string title) { m_PlaylistInfos[index].title = std::move(title); }
-    void TracksQueue::SetPlaylistRepeatCount(size_t index, size_t repeatCount) { m_PlaylistInfos[index].repeat = repeatCount; }
+        AccessTrackInfo(index).repeat = repeatCount;
+    }
+    void TracksQueue::SetTracksSpeed(size_t from, size_t to, float speed)
+    {
+        const ChangePublisher changePublisher{ *this };
+
+        m_Tracks.ForEach(from, to + 1, [speed](Tracks::Node& node)
+            {
+                node.value.info.speed = speed;
+                node.value.published.reset();
+            });
+    }
+    void TracksQueue::SetTracksRepeatCount(size_t from, size_t to, size_t repeatCount)
+    {
+        const ChangePublisher changePublisher{ *this };
+
+        m_Tracks.ForEach(from, to + 1, [repeatCount](Tracks::Node& node)
+            {
+                node.value.info.repeat = repeatCount;
+                node.value.published.reset();
+            });
+    }
+    void TracksQueue::SetTrackRawURL(size_t index, std::string rawURL, AudioFormatHints formatHints)
+    {
+        const ChangePublisher changePublisher{ *this };
+
+        TrackInfo& trackInfo = AccessTrackInfo(index);
+
+        //the old hints are kept only if the raw url is the same and nothing new is known about it
+        if(trackInfo.rawURL != rawURL || !formatHints.IsEmpty())
+            trackInfo.formatHints = std::move(formatHints);
+
+        trackInfo.rawURL = std::move(rawURL);
+    }
+
+    void TracksQueue::SetPlaylistTitle(size_t index, std::string title)
+    {
+        const ChangePublisher changePublisher{ *this };
+
+        m_PlaylistInfos[index].title = std::move(title);
+    }
+    void TracksQueue::SetPlaylistRepeatCount(size_t index, size_t repeatCount)
+    {
+        const ChangePublisher changePublisher{ *this };
+
+        m_PlaylistInfos[index].repeat = repeatCount;
+    }
 
     size_t TracksQueue::GetLastIndexWithCheck() const
     {
-        if(m_Tracks.empty())
+        if(m_Tracks.IsEmpty())
             return 0;
         else
             return GetLastIndex();
     }
-    size_t TracksQueue::GetLastIndex() const { return m_Tracks.size() - 1; }
+    size_t TracksQueue::GetLastIndex() const { return m_Tracks.GetSize() - 1; }
 }
 //private stuff
 namespace Orchestra
 {
+    TracksQueue::ChangePublisher::ChangePublisher(TracksQueue& tracksQueue)
+        : m_TracksQueue(tracksQueue) {}
+    TracksQueue::ChangePublisher::~ChangePublisher()
+    {
+        try
+        {
+            m_TracksQueue.m_Snapshot.store(m_TracksQueue.MakeSnapshot());
+        }
+        catch(const std::exception& e)
+        {
+            GE_LOG(Orchestra, Warning, "Failed to publish a snapshot of the tracks queue, the readers see the previous one: ", e.what());
+        }
+    }
+
+    std::shared_ptr<const TracksQueueSnapshot> TracksQueue::MakeSnapshot()
+    {
+        std::vector<std::shared_ptr<const TrackInfo>> tracks;
+        tracks.reserve(m_Tracks.GetSize());
+
+        //only the changed tracks are copied
+        m_Tracks.ForEach([&tracks](Tracks::Node& node)
+            {
+                if(!node.value.published)
+                    node.value.published = std::make_shared<const TrackInfo>(node.value.info);
+
+                tracks.push_back(node.value.published);
+            });
+
+        return std::make_shared<const TracksQueueSnapshot>(std::move(tracks), m_PlaylistInfos);
+    }
+
+    void TracksQueue::CopyFrom(const TracksQueue& other)
+    {
+        m_Yt_DlpManager = other.m_Yt_DlpManager;
+        m_Tracks = other.m_Tracks;
+        m_PlaylistInfos = other.m_PlaylistInfos;
+
+        //the copied nodes are other ones
+        m_TracksByUniqueIndex.clear();
+        m_TracksByUniqueIndex.reserve(m_Tracks.GetSize());
+        m_Tracks.ForEach([this](Tracks::Node& node) { m_TracksByUniqueIndex.emplace(node.value.info.uniqueIndex, &node); });
+
+        //the snapshot is immutable, so it is shared
+        m_Snapshot.store(other.m_Snapshot.load());
+    }
+    void TracksQueue::MoveFrom(TracksQueue&& other) noexcept
+    {
+        m_Yt_DlpManager = std::move(other.m_Yt_DlpManager);
+        m_Tracks = std::move(other.m_Tracks);
+        m_TracksByUniqueIndex = std::move(other.m_TracksByUniqueIndex);
+        m_PlaylistInfos = std::move(other.m_PlaylistInfos);
+        m_Snapshot.store(other.m_Snapshot.exchange(nullptr));
+    }
+
     void TracksQueue::AdjustInsertIndex(size_t& insertIndex) const
     {
-        if(!m_Tracks.empty())
+        if(!m_Tracks.IsEmpty())
         {
             if(insertIndex == std::numeric_limits<size_t>::max())
-                insertIndex = m_Tracks.size();
+                insertIndex = m_Tracks.GetSize();
 
-            O_ASSERT(insertIndex <= m_Tracks.size(), "Cannot insert tracks with index that is bigger than the last index of m_Tracks.");
+            O_ASSERT(insertIndex <= m_Tracks.GetSize(), "Cannot insert tracks with index that is bigger than the last index of m_Tracks.");
         }
         else
             insertIndex = 0;
     }
-    void TracksQueue::AdjustPlaylistInfosIndicesAfterInsertion(size_t insertIndex, size_t addingTracksSize)
+    void TracksQueue::InsertTrackInfo(size_t insertIndex, TrackInfo trackInfo, float speed, size_t repeat)
     {
-        for(auto&& playlistInfo : m_PlaylistInfos)
-            if(insertIndex < playlistInfo.beginIndex)
-            {
-                playlistInfo.beginIndex += addingTracksSize;
-                playlistInfo.endIndex += addingTracksSize;
-            }
-            else if(insertIndex >= playlistInfo.beginIndex && insertIndex <= playlistInfo.endIndex)
+        trackInfo.speed = speed;
+        trackInfo.repeat = repeat;
+        trackInfo.uniqueIndex = s_CurrentUniqueTrackIndex++;
+
+        const size_t uniqueIndex = trackInfo.uniqueIndex;
+
+        m_TracksByUniqueIndex.emplace(uniqueIndex, m_Tracks.Insert(insertIndex, { std::move(trackInfo) }));
+    }
+    void TracksQueue::EraseTracks(size_t from, size_t to)
+    {
+        O_ASSERT(from <= to && to < m_Tracks.GetSize(), "Cannot delete tracks from ", from, " to ", to, '.');
+
+        //the bounds, which are deleted, move to the closest tracks left in their playlists
+        for(PlaylistInfo& playlistInfo : m_PlaylistInfos)
+        {
+            if(from <= playlistInfo.beginIndex && playlistInfo.beginIndex <= to && to < playlistInfo.endIndex)
+                playlistInfo.beginTrackUniqueIndex = m_Tracks[to + 1].info.uniqueIndex;
+            if(from <= playlistInfo.endIndex && playlistInfo.endIndex <= to && from > playlistInfo.beginIndex)
+                playlistInfo.endTrackUniqueIndex = m_Tracks[from - 1].info.uniqueIndex;
+        }
+
+        m_Tracks.ForEach(from, to + 1, [this](const Tracks::Node& node) { m_TracksByUniqueIndex.erase(node.value.info.uniqueIndex); });
+        m_Tracks.Erase(from, to + 1);
+
+        //the ones which have been deleted entirely or have a single track left
+        std::erase_if(m_PlaylistInfos, [this](const PlaylistInfo& playlistInfo)
             {
-                if(insertIndex == playlistInfo.beginIndex)
-                    playlistInfo.beginIndex += addingTracksSize;
+                return playlistInfo.beginTrackUniqueIndex == playlistInfo.endTrackUniqueIndex ||
+                    !m_TracksByUniqueIndex.contains(playlistInfo.beginTrackUniqueIndex) || !m_TracksByUniqueIndex.contains(playlistInfo.endTrackUniqueIndex);
+            });
 
-                playlistInfo.endIndex += addingTracksSize;
-            }
+        UpdatePlaylistInfosIndices();
     }
+    TrackInfo& TracksQueue::AccessTrackInfo(size_t index)
+    {
+        QueuedTrack& track = m_Tracks[index];
 
-    void TracksQueue::InsertTrackInfo(size_t insertIndex, TrackInfo trackInfo, float speed, size_t repeat)
+        track.published.reset();
+
+        return track.info;
+    }
+
+    void TracksQueue::InsertPlaylistInfo(std::string title, size_t beginIndex, size_t endIndex, size_t repeat, size_t uniqueIndex)
     {
-        trackInfo.speed = speed;
-        trackInfo.repeat = repeat;
-        trackInfo.uniqueIndex = s_CurrentUniqueTrackIndex++;
+        const auto position = std::ranges::upper_bound(m_PlaylistInfos, beginIndex, {}, &PlaylistInfo::beginIndex);
 
-        m_Tracks.insert(m_Tracks.begin() + insertIndex, std::move(trackInfo));
+        m_PlaylistInfos.insert(position, PlaylistInfo{ std::move(title), beginIndex, endIndex, repeat, uniqueIndex, m_Tracks[beginIndex].info.uniqueIndex, m_Tracks[endIndex].info.uniqueIndex });
+    }
+    void TracksQueue::UpdatePlaylistInfosIndices()
+    {
+        for(PlaylistInfo& playlistInfo : m_PlaylistInfos)
+        {
+            playlistInfo.beginIndex = m_Tracks.GetIndex(m_TracksByUniqueIndex.at(playlistInfo.beginTrackUniqueIndex));
+            playlistInfo.endIndex = m_Tracks.GetIndex(m_TracksByUniqueIndex.at(playlistInfo.endTrackUniqueIndex));
+        }
+    }
+    void TracksQueue::AnchorPlaylistInfos()
+    {
+        for(PlaylistInfo& playlistInfo : m_PlaylistInfos)
+        {
+            playlistInfo.beginTrackUniqueIndex = m_Tracks[playlistInfo.beginIndex].info.uniqueIndex;
+            playlistInfo.endTrackUniqueIndex = m_Tracks[playlistInfo.endIndex].info.uniqueIndex;
+        }
     }
+}
+//TracksQueueSnapshot
+namespace Orchestra
+{
+    TracksQueueSnapshot::TracksQueueSnapshot(std::vector<std::shared_ptr<const TrackInfo>> tracks, std::vector<PlaylistInfo> playlistInfos)
+        : m_Tracks(std::move(tracks)), m_PlaylistInfos(std::move(playlistInfos)) {}
+
+    size_t TracksQueueSnapshot::GetTracksSize() const { return m_Tracks.size(); }
+    size_t TracksQueueSnapshot::GetPlaylistsSize() const { return m_PlaylistInfos.size(); }
+
+    const TrackInfo& TracksQueueSnapshot::GetTrackInfo(size_t index) const { return *m_Tracks[index]; }
+
+    const std::vector<PlaylistInfo>& TracksQueueSnapshot::GetPlaylistInfos() const { return m_PlaylistInfos; }
+    const PlaylistInfo& TracksQueueSnapshot::GetPlaylistInfo(size_t index) const { return m_PlaylistInfos[index]; }
 }
\ No newline at end of file
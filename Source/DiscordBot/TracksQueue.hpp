@@ -2,12 +2,17 @@
 
 #define NOMINMAX
 
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <unordered_map>
 #include <vector>
 #include <string>
 #include <string_view>
 #include <random>
 
 #include "Yt_DlpManager.hpp"
+#include "ImplicitTreap.hpp"
 
 namespace Orchestra
 {
@@ -18,7 +23,36 @@ namespace Orchestra
         size_t endIndex;
         size_t repeat;
         size_t uniqueIndex;
+        //the unique indices of the first and the last tracks, so the indices above follow them when tracks are inserted or deleted before them
+        size_t beginTrackUniqueIndex;
+        size_t endTrackUniqueIndex;
     };
+    //an immutable copy of the tracks and the playlists of a TracksQueue, which is read without locking the queue
+    class TracksQueueSnapshot
+    {
+    public:
+        TracksQueueSnapshot() = default;
+        TracksQueueSnapshot(std::vector<std::shared_ptr<const TrackInfo>> tracks, std::vector<PlaylistInfo> playlistInfos);
+
+    public:
+        size_t GetTracksSize() const;
+        size_t GetPlaylistsSize() const;
+
+        const TrackInfo& GetTrackInfo(size_t index) const;
+
+        const std::vector<PlaylistInfo>& GetPlaylistInfos() const;
+        const PlaylistInfo& GetPlaylistInfo(size_t index) const;
+
+    private:
+        //the tracks, which haven't been changed, are shared with the previous snapshots
+        std::vector<std::shared_ptr<const TrackInfo>> m_Tracks;
+        std::vector<PlaylistInfo> m_PlaylistInfos;
+    };
+
+    //the readers, which only show the queue, take a snapshot of it, so they never wait for the ones which hold it(e.g. the playback while yt-dlp works).
+    //every change publishes a new snapshot, sharing the tracks which haven't been changed, so taking one is only an atomic load.
+    //the tracks are in an implicit treap, so inserting, deleting and transferring one is O(log n) even in a queue of thousands, as is getting one by its index or by its unique index.
+    //the playlists are sorted by their beginIndex and never intersect
     class TracksQueue
     {
     public:
@@ -26,10 +60,10 @@ namespace Orchestra
         TracksQueue(std::filesystem::path yt_dlpExecutablePath);
         ~TracksQueue() = default;
 
-        TracksQueue(const TracksQueue& other) = default;
-        TracksQueue& operator=(const TracksQueue& other) = default;
-        TracksQueue(TracksQueue&& other) noexcept = default;
-        TracksQueue& operator=(TracksQueue&& other) noexcept = default;
+        TracksQueue(const TracksQueue& other);
+        TracksQueue& operator=(const TracksQueue& other);
+        TracksQueue(TracksQueue&& other) noexcept;
+        TracksQueue& operator=(TracksQueue&& other) noexcept;
 
         void FetchURL(const std::filesystem::path& yt_dlpExecutablePath, const std::string_view& url, std::mt19937 randomEngine = {}, bool doShuffle = false, float speed = 1.f, size_t repeat = 1, size_t insertIndex = std::numeric_limits<size_t>::max(), bool lookForRawURLOfOneTrack = false);
         void FetchURL(const std::string_view& url, std::mt19937 randomEngine = {}, bool doShuffle = false, float speed = 1.f, size_t repeat = 1, size_t insertIndex = std::numeric_limits<size_t>::max(), bool lookForRawURL = false);
@@ -61,36 +95,93 @@ namespace Orchestra
         size_t GetTracksSize() const;
         size_t GetPlaylistsSize() const;
 
-        const std::vector<TrackInfo>& GetTrackInfos() const;
+        //the reference lives till the track is deleted
         const TrackInfo& GetTrackInfo(size_t index) const;
+        //the current index of the track, std::nullopt if it has been deleted
+        std::optional<size_t> FindTrackIndex(size_t uniqueIndex) const;
 
         const std::vector<PlaylistInfo>& GetPlaylistInfos() const;
         const PlaylistInfo& GetPlaylistInfo(size_t index) const;
+        //the index of the playlist which contains the track, std::nullopt if it is in none
+        std::optional<size_t> FindPlaylistIndex(size_t trackIndex) const;
 
         void SetTrackTitle(size_t index, std::string title);
         void SetTrackDuration(size_t index, float duration);
         void SetTrackSpeed(size_t index, float speed);
         void SetTrackRepeatCount(size_t index, size_t repeatCount);
-        void SetTrackRawURL(size_t index, std::string rawURL);
+        //both are inclusive, so a range is published as one change
+        void SetTracksSpeed(size_t from, size_t to, float speed);
+        void SetTracksRepeatCount(size_t from, size_t to, size_t repeatCount);
+        //the hints describe the raw url, the ones of the previous raw url are dropped
+        void SetTrackRawURL(size_t index, std::string rawURL, AudioFormatHints formatHints = {});
 
         void SetPlaylistTitle(size_t index, std::string title);
         void SetPlaylistRepeatCount(size_t index, size_t repeatCount);
 
+        //the state after the last change, it can be called without locking the queue and the returned snapshot stays the same
+        std::shared_ptr<const TracksQueueSnapshot> GetSnapshot() const;
+
     private:
+        struct QueuedTrack
+        {
+            TrackInfo info;
+            //the copy which the last snapshot has, it is reset when the track is changed
+            std::shared_ptr<const TrackInfo> published;
+        };
+        using Tracks = ImplicitTreap<QueuedTrack>;
+
+        //publishes a new snapshot when the change is over, even if it throws halfway, so a change made of several steps is seen as one
+        class ChangePublisher
+        {
+        public:
+            explicit ChangePublisher(TracksQueue& tracksQueue);
+            ~ChangePublisher();
+
+            ChangePublisher(const ChangePublisher&) = delete;
+            ChangePublisher(ChangePublisher&&) = delete;
+            ChangePublisher& operator=(const ChangePublisher&) = delete;
+            ChangePublisher& operator=(ChangePublisher&&) = delete;
+
+        private:
+            TracksQueue& m_TracksQueue;
+        };
+
+    private:
+        //fills the published copies of the changed tracks
+        std::shared_ptr<const TracksQueueSnapshot> MakeSnapshot();
+
+        void CopyFrom(const TracksQueue& other);
+        void MoveFrom(TracksQueue&& other) noexcept;
+
         size_t GetLastIndexWithCheck() const;
         size_t GetLastIndex() const;
 
         void AdjustInsertIndex(size_t& insertIndex) const;
-        void AdjustPlaylistInfosIndicesAfterInsertion(size_t insertIndex, size_t addingTracksSize);
 
         void InsertTrackInfo(size_t insertIndex, TrackInfo trackInfo, float speed = 1.f, size_t repeat = 1);
+        //both are inclusive
+        void EraseTracks(size_t from, size_t to);
+        //resets the published copy of the track, so it must be used for every change of one
+        TrackInfo& AccessTrackInfo(size_t index);
+
+        //keeps the playlists sorted
+        void InsertPlaylistInfo(std::string title, size_t beginIndex, size_t endIndex, size_t repeat, size_t uniqueIndex);
+        //the playlists follow their tracks, so after the tracks have been inserted or deleted only the indices are updated
+        void UpdatePlaylistInfosIndices();
+        //the playlists stay where they were when the tracks have been moved inside the queue, so the tracks at those indices become their bounds
+        void AnchorPlaylistInfos();
 
     private:
         static size_t s_CurrentUniqueTrackIndex;
         static size_t s_CurrentUniquePlaylistIndex;
 
         Yt_DlpManager m_Yt_DlpManager;
-        std::vector<TrackInfo> m_Tracks;
+        Tracks m_Tracks;
+        //the unique index of a track to its node, which knows its current index
+        std::unordered_map<size_t, Tracks::Node*> m_TracksByUniqueIndex;
         std::vector<PlaylistInfo> m_PlaylistInfos;
+
+        //nullptr till the first change
+        std::atomic<std::shared_ptr<const TracksQueueSnapshot>> m_Snapshot;
     };
 }
\ No newline at end of file
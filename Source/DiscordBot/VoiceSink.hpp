@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace Orchestra
+{
+    //where Player sends its audio to, the subset of dpp::discord_voice_client which the playback uses.
+    //besides discord's voice client(DiscordVoiceSink) it can be a headless one, so many players can be run offline
+    class VoiceSink
+    {
+    public:
+        VoiceSink() = default;
+        virtual ~VoiceSink() = default;
+
+        VoiceSink(const VoiceSink&) = delete;
+        VoiceSink(VoiceSink&&) = delete;
+        VoiceSink& operator=(const VoiceSink&) = delete;
+        VoiceSink& operator=(VoiceSink&&) = delete;
+
+        //48kHz stereo s16 samples, size is in bytes
+        virtual void SendAudioRaw(uint16_t* audio, size_t size) = 0;
+        //a single opus packet of 48kHz stereo audio
+        virtual void SendAudioOpus(uint8_t* packet, size_t size) = 0;
+        //drops the audio which hasn't been played yet
+        virtual void StopAudio() = 0;
+
+    public:
+        //how many seconds of the sent audio haven't been played yet
+        virtual float GetSecondsRemaining() = 0;
+        virtual uint64_t GetGuildID() const = 0;
+    };
+}
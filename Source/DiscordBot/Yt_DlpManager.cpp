@@ -10,7 +10,27 @@
 
 #include "GuelderResourcesManager.hpp"
 #include "../Utils.hpp"
+#include "RawURLCache.hpp"
+#include "Yt_DlpWorkerPool.hpp"
 
+//private
+namespace Orchestra
+{
+    namespace
+    {
+        AudioFormatHints RetrieveAudioFormatHints(const JSONValue& format)
+        {
+            AudioFormatHints formatHints;
+
+            formatHints.container = GetFromJSONOr<const char*>(format, "ext", "");
+            formatHints.codec = GetFromJSONOr<const char*>(format, "acodec", "");
+            formatHints.sampleRate = GetFromJSONOr<int>(format, "asr", 0);
+            formatHints.channelsCount = GetFromJSONOr<int>(format, "audio_channels", 0);
+
+            return formatHints;
+        }
+    }
+}
 namespace Orchestra
 {
     bool TrackInfo::HasURL() const
@@ -137,7 +157,20 @@ namespace Orchestra
             TrackInfo trackInfo = RetrieveBasicTrackInfo(*itTrack, m_IsPlaylist);
 
             if(lookForRawURL)
-                trackInfo.rawURL = RetrieveFullTrackInfo(RetrieveJSONFromYt_dlp(yt_dlpExecutablePath, trackInfo.URL, false), false).rawURL;
+            {
+                if(auto cached = RawURLCache::Find(trackInfo.URL))
+                {
+                    trackInfo.rawURL = std::move(cached->rawURL);
+                    trackInfo.formatHints = std::move(cached->formatHints);
+                }
+                else
+                {
+                    TrackInfo fullTrackInfo = RetrieveFullTrackInfo(RetrieveJSONFromYt_dlp(yt_dlpExecutablePath, trackInfo.URL, false), false);
+
+                    trackInfo.rawURL = std::move(fullTrackInfo.rawURL);
+                    trackInfo.formatHints = std::move(fullTrackInfo.formatHints);
+                }
+            }
 
             return trackInfo;
         }
@@ -195,14 +228,30 @@ namespace Orchestra
         return itEntries->value.GetArray();
     }
 
-    std::string Yt_DlpManager::GetRawURLFromURL(const std::filesystem::path& yt_dlpExecutablePath, const std::string_view& url)
+    std::string Yt_DlpManager::GetRawURLFromURL(const std::filesystem::path& yt_dlpExecutablePath, const std::string_view& url, std::stop_token stopToken, Yt_DlpWorkerPool::Priority priority)
     {
+        if(auto cached = RawURLCache::Find(url))
+            return std::move(cached->rawURL);
+
+        if(Yt_DlpWorkerPool::IsRunning())
+        {
+            std::string rawURL = Yt_DlpWorkerPool::RequestRawURL(url, std::move(stopToken), priority);
+
+            RawURLCache::Insert(url, rawURL);
+
+            return rawURL;
+        }
+
         const std::string pipeCommand = GuelderConsoleLog::Logger::Format(yt_dlpExecutablePath.string(), " -f bestaudio --get-url \"", url, '\"');
 
+        const auto timer = Yt_DlpWorkerPool::MeasureCall("rawURL", false);
+
         auto expected = GuelderResourcesManager::ResourcesManager::ExecuteCommand(pipeCommand, 1);
 
         O_ASSERT(expected.has_value() && !expected.value().empty(), "Failed to retrieve raw audio URL from yt-dlp");
 
+        RawURLCache::Insert(url, expected.value()[0]);
+
         return expected.value()[0];
     }
     std::string Yt_DlpManager::GetRawURLFromURL(const std::string_view& url) const
@@ -234,8 +283,13 @@ namespace Orchestra
 
     std::string Yt_DlpManager::GetRawURLFromSearch(const std::filesystem::path& yt_dlpExecutablePath, const std::string_view& input, SearchEngine searchEngine)
     {
+        if(Yt_DlpWorkerPool::IsRunning())
+            return Yt_DlpWorkerPool::RequestRawURL(GuelderConsoleLog::Logger::Format(SearchEngineToString(searchEngine), "search:", input));
+
         const std::string pipeCommand = GuelderConsoleLog::Logger::Format(yt_dlpExecutablePath.string(), " -f bestaudio --get-url \"", SearchEngineToString(searchEngine), "search:", input, "\"");
 
+        const auto timer = Yt_DlpWorkerPool::MeasureCall("rawURL", false);
+
         auto expected = GuelderResourcesManager::ResourcesManager::ExecuteCommand<wchar_t, char>(GuelderResourcesManager::StringToWString(pipeCommand), 1);
 
         O_ASSERT(expected.has_value() && !expected.value().empty(), "Failed to retrieve raw audio URL from yt-dlp");
@@ -286,6 +340,9 @@ namespace Orchestra
                 {
                     TrackInfo out = RetrieveBasicTrackInfo(rawJSON, isPlaylist);
                     out.rawURL = GetFromJSON<const char*>(format, "url");
+                    out.formatHints = RetrieveAudioFormatHints(format);
+
+                    RawURLCache::Insert(out.URL, out.rawURL, out.formatHints);
 
                     return out;
                 }
@@ -300,6 +357,17 @@ namespace Orchestra
 
         JSON JSON;
 
+        if(Yt_DlpWorkerPool::IsRunning())
+        {
+            const std::string output = useSearch ? Yt_DlpWorkerPool::RequestJSON(Logger::Format(SearchEngineToString(searchEngine), "search:", input)) : Yt_DlpWorkerPool::RequestFlatJSON(input);
+
+            JSON.Parse(output.c_str());
+
+            O_ASSERT(!JSON.HasParseError(), "Failed to parse JSON at offset ", JSON.GetErrorOffset());
+
+            return JSON;
+        }
+
         std::string pipeCommand;
 
         if(useSearch)//this should be changed somehow
@@ -309,6 +377,8 @@ namespace Orchestra
 
         //GE_LOG(Orchestra, Warning, pipeCommand);
 
+        const auto timer = Yt_DlpWorkerPool::MeasureCall(useSearch ? "JSON" : "flatJSON", false);
+
         auto expected = GuelderResourcesManager::ResourcesManager::ExecuteCommand<wchar_t, char>(GuelderResourcesManager::StringToWString(pipeCommand), 1);
 
         O_ASSERT(expected.has_value() && !expected.value().empty(), "Failed to retrieve JSON from yt-dlp");
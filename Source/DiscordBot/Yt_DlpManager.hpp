@@ -4,12 +4,15 @@
 #include <filesystem>
 #include <string>
 #include <string_view>
+#include <stop_token>
 
 #include <rapidjson/document.h>
 #include <rapidjson/encodings.h>
 
 #include "GuelderResourcesManager.hpp"
 #include "../Utils.hpp"
+#include "../FFmpeg/AudioFormatHints.hpp"
+#include "Yt_DlpWorkerPool.hpp"
 
 namespace Orchestra
 {
@@ -28,6 +31,17 @@ namespace Orchestra
 
         return itFound->value.template Get<T>();
     }
+    //returns defaultValue if there is no such member or it is of another type, e.g. yt-dlp writes null for what it doesn't know
+    template<typename T>
+    T GetFromJSONOr(const rapidjson::Document::ValueType& JSON, const std::string_view& item, T defaultValue)
+    {
+        const auto itFound = JSON.FindMember(item.data());
+
+        if(itFound == JSON.MemberEnd() || !itFound->value.template Is<T>())
+            return defaultValue;
+
+        return itFound->value.template Get<T>();
+    }
 
     struct TrackInfo
     {
@@ -39,6 +53,8 @@ namespace Orchestra
         size_t uniqueIndex;
         size_t repeat;
         float speed;
+        //describe rawURL, so they are empty if it has been got without yt-dlp's json
+        AudioFormatHints formatHints;
 
         bool HasURL() const;
     };
@@ -92,7 +108,8 @@ namespace Orchestra
         const rapidjson::GenericArray<false, rapidjson::GenericValue<rapidjson::UTF8<>>>& GetPlaylist() const;
 
     public:
-        static std::string GetRawURLFromURL(const std::filesystem::path& yt_dlpExecutablePath, const std::string_view& url);
+        //only a request to Yt_DlpWorkerPool can be cancelled with stopToken, yt-dlp executable is waited for. The priority is of the request to Yt_DlpWorkerPool
+        static std::string GetRawURLFromURL(const std::filesystem::path& yt_dlpExecutablePath, const std::string_view& url, std::stop_token stopToken = {}, Yt_DlpWorkerPool::Priority priority = Yt_DlpWorkerPool::Priority::Interactive);
         std::string GetRawURLFromURL(const std::string_view& url) const;
 
 #ifdef WIN32
@@ -0,0 +1,298 @@
+#include "Yt_DlpWorkerPool.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <GuelderConsoleLog.hpp>
+
+#include "../Utils.hpp"
+#include "../Workers/ChildProcess.hpp"
+
+//private
+namespace Orchestra
+{
+    namespace
+    {
+        std::string s_WorkerCommand;
+
+        std::vector<ChildProcess> s_Workers;
+        std::vector<size_t> s_IdleWorkersIndices;
+
+        std::mutex s_Mutex;
+        std::condition_variable_any s_WorkerReleasedCondition;
+
+        //requests of a priority are served in the order of their tickets
+        struct Tickets
+        {
+            uint64_t next = 0;
+            //a cancelled request removes its ticket, so it doesn't hold up the next ones
+            std::deque<uint64_t> waiting;
+        };
+
+        Tickets s_InteractiveTickets;
+        Tickets s_BackgroundTickets;
+
+        bool s_IsRunning = false;
+
+        bool LaunchWorker(ChildProcess& worker)
+        {
+            try
+            {
+                worker = ChildProcess{ s_WorkerCommand };
+            }
+            catch(const OrchestraException& e)
+            {
+                GE_LOG(Orchestra, Warning, "Failed to launch yt-dlp worker: ", e.GetFullMessage());
+                return false;
+            }
+
+            return true;
+        }
+        bool WaitForWorkerReady(ChildProcess& worker, const std::stop_token& stopToken = {})
+        {
+            //killing the worker unblocks ReadLine
+            std::stop_callback terminateOnStop{ stopToken, [&worker] { worker.Terminate(); } };
+
+            const auto line = worker.ReadLine();
+
+            return !stopToken.stop_requested() && line.has_value() && line.value() == "ready";
+        }
+        //std::nullopt if the worker has exited or has been killed by stopToken
+        std::optional<std::string> SendRequest(ChildProcess& worker, const std::string_view& request, const std::stop_token& stopToken)
+        {
+            std::stop_callback terminateOnStop{ stopToken, [&worker] { worker.Terminate(); } };
+
+            if(stopToken.stop_requested() || !worker.WriteLine(request))
+                return std::nullopt;
+
+            return worker.ReadLine();
+        }
+
+        std::string EscapeJSONString(const std::string_view& str)
+        {
+            std::string out;
+            out.reserve(str.size() + 2);
+
+            for(const char c : str)
+            {
+                switch(c)
+                {
+                case '"':
+                    out += "\\\"";
+                    break;
+                case '\\':
+                    out += "\\\\";
+                    break;
+                case '\n':
+                    out += "\\n";
+                    break;
+                case '\r':
+                    out += "\\r";
+                    break;
+                case '\t':
+                    out += "\\t";
+                    break;
+                default:
+                    if(static_cast<unsigned char>(c) < 0x20)
+                        out += GuelderConsoleLog::Logger::Format("\\u00", "0123456789abcdef"[c >> 4], "0123456789abcdef"[c & 0xF]);
+                    else
+                        out += c;
+                    break;
+                }
+            }
+
+            return out;
+        }
+
+        //std::nullopt if stopToken is requested while waiting
+        std::optional<size_t> AcquireWorker(Yt_DlpWorkerPool::Priority priority, const std::stop_token& stopToken)
+        {
+            std::unique_lock lock{ s_Mutex };
+
+            const bool isBackground = priority == Yt_DlpWorkerPool::Priority::Background;
+            Tickets& tickets = isBackground ? s_BackgroundTickets : s_InteractiveTickets;
+
+            const uint64_t ticket = tickets.next++;
+            tickets.waiting.push_back(ticket);
+
+            const bool isAcquired = s_WorkerReleasedCondition.wait(lock, stopToken, [&ticket, &tickets, isBackground]
+                {
+                    return ticket == tickets.waiting.front() && !s_IdleWorkersIndices.empty() && (!isBackground || s_InteractiveTickets.waiting.empty());
+                });
+
+            std::optional<size_t> index;
+
+            if(isAcquired)
+            {
+                tickets.waiting.pop_front();
+
+                index = s_IdleWorkersIndices.back();
+                s_IdleWorkersIndices.pop_back();
+            }
+            else
+                tickets.waiting.erase(std::ranges::find(tickets.waiting, ticket));
+
+            lock.unlock();
+            //the next ticket may be waiting for another idle worker, or for this one to be cancelled
+            s_WorkerReleasedCondition.notify_all();
+
+            return index;
+        }
+        void ReleaseWorker(size_t index)
+        {
+            {
+                std::lock_guard lock{ s_Mutex };
+                s_IdleWorkersIndices.push_back(index);
+            }
+
+            s_WorkerReleasedCondition.notify_all();
+        }
+    }
+}
+namespace Orchestra
+{
+    void Yt_DlpWorkerPool::Launch(std::string workerCommand, size_t workersCount)
+    {
+        std::lock_guard lock{ s_Mutex };
+
+        O_ASSERT(!s_IsRunning, "The yt-dlp worker pool has already been launched.");
+
+        if(workersCount == 0)
+            return;
+
+        s_WorkerCommand = std::move(workerCommand);
+        s_Workers.resize(workersCount);
+
+        //all workers start up simultaneously and then they are waited for
+        for(auto& worker : s_Workers)
+            if(!LaunchWorker(worker))
+                break;
+
+        for(size_t i = 0; i < s_Workers.size(); i++)
+            if(s_Workers[i].IsLaunched() && WaitForWorkerReady(s_Workers[i]))
+                s_IdleWorkersIndices.push_back(i);
+
+        if(s_IdleWorkersIndices.empty())
+        {
+            GE_LOG(Orchestra, Warning, "None of yt-dlp workers launched with \"", s_WorkerCommand, "\" became ready, using yt-dlp executable instead.");
+
+            s_Workers.clear();
+            return;
+        }
+
+        s_IsRunning = true;
+
+        GE_LOG(Orchestra, Info, "Launched ", s_IdleWorkersIndices.size(), " yt-dlp workers out of ", workersCount, '.');
+    }
+
+    std::string Yt_DlpWorkerPool::Request(const std::string_view& command, const std::string_view& input, std::stop_token stopToken, Priority priority)
+    {
+        O_ASSERT(IsRunning(), "The yt-dlp worker pool is not running.");
+
+        const auto timer = MeasureCall(command, true);
+
+        const auto acquiredIndex = AcquireWorker(priority, stopToken);
+
+        O_ASSERT(acquiredIndex.has_value(), "The yt-dlp request \"", command, "\" for ", input, " was cancelled while waiting for a free worker.");
+
+        const size_t index = acquiredIndex.value();
+        ChildProcess& worker = s_Workers[index];
+
+        const std::string request = GuelderConsoleLog::Logger::Format("{\"command\": \"", EscapeJSONString(command), "\", \"input\": \"", EscapeJSONString(input), "\"}");
+
+        std::optional<std::string> response;
+
+        //a worker which was idle may have died since its last request, then the request is retried once by a relaunched one
+        bool canRetry = worker.IsLaunched();
+
+        while(true)
+        {
+            //a worker is relaunched lazily, after it died or was killed by a cancellation
+            if(worker.IsLaunched() || (LaunchWorker(worker) && WaitForWorkerReady(worker, stopToken)))
+                response = SendRequest(worker, request, stopToken);
+
+            if(response.has_value() || stopToken.stop_requested() || !canRetry)
+                break;
+
+            GE_LOG(Orchestra, Warning, "The idle yt-dlp worker has exited, relaunching it to handle \"", command, "\" for ", input, '.');
+
+            worker = ChildProcess{};
+            canRetry = false;
+        }
+
+        //the process is not usable anymore, it may also have been killed by stopToken right after it responded
+        if(!response.has_value() || stopToken.stop_requested())
+            worker = ChildProcess{};
+
+        if(!response.has_value())
+        {
+            ReleaseWorker(index);
+
+            O_ASSERT(!stopToken.stop_requested(), "The yt-dlp request \"", command, "\" for ", input, " was cancelled.");
+            O_THROW("The yt-dlp worker exited while handling \"", command, "\" for ", input, '.');
+        }
+
+        ReleaseWorker(index);
+
+        constexpr std::string_view okPrefix = "ok ";
+        constexpr std::string_view errorPrefix = "error ";
+
+        if(response.value().starts_with(okPrefix))
+            return response.value().substr(okPrefix.size());
+
+        if(response.value().starts_with(errorPrefix))
+            O_THROW("yt-dlp failed to handle \"", command, "\" for ", input, ": ", std::string_view{ response.value() }.substr(errorPrefix.size()));
+
+        O_THROW("The yt-dlp worker returned an invalid response to \"", command, "\" for ", input, '.');
+    }
+
+    std::string Yt_DlpWorkerPool::RequestFlatJSON(const std::string_view& url, std::stop_token stopToken)
+    {
+        return Request("flatJSON", url, std::move(stopToken));
+    }
+    std::string Yt_DlpWorkerPool::RequestJSON(const std::string_view& input, std::stop_token stopToken)
+    {
+        return Request("JSON", input, std::move(stopToken));
+    }
+    std::string Yt_DlpWorkerPool::RequestRawURL(const std::string_view& input, std::stop_token stopToken, Priority priority)
+    {
+        return Request("rawURL", input, std::move(stopToken), priority);
+    }
+
+    Metrics::ScopedTimer Yt_DlpWorkerPool::MeasureCall(const std::string_view& command, bool byWorker)
+    {
+        static const std::vector<double> bounds{ .25, .5, 1., 2., 4., 8., 16., 32. };
+
+        const Metrics::Labels labels{ { "command", std::string{ command } }, { "runner", byWorker ? "worker" : "executable" } };
+
+        return Metrics::ScopedTimer{
+            Metrics::GetHistogram("orchestra_yt_dlp_call_seconds", "How long the successful calls of yt-dlp take, including the wait for a free worker.", bounds, labels),
+            &Metrics::GetCounter("orchestra_yt_dlp_failures_total", "The calls of yt-dlp which have failed or have been cancelled.", labels) };
+    }
+}
+//getters, setters
+namespace Orchestra
+{
+    bool Yt_DlpWorkerPool::IsRunning()
+    {
+        std::lock_guard lock{ s_Mutex };
+        return s_IsRunning;
+    }
+    size_t Yt_DlpWorkerPool::GetWorkersCount()
+    {
+        std::lock_guard lock{ s_Mutex };
+        return s_Workers.size();
+    }
+    size_t Yt_DlpWorkerPool::GetQueuedRequestsCount()
+    {
+        std::lock_guard lock{ s_Mutex };
+        return s_InteractiveTickets.waiting.size() + s_BackgroundTickets.waiting.size();
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stop_token>
+#include <string>
+#include <string_view>
+
+#include "../Diagnostics/Metrics.hpp"
+
+namespace Orchestra
+{
+    //persistent yt-dlp processes(Resources/Yt_DlpWorker.py), so a request does not pay python startup and extractors import.
+    //a worker reads one JSON request per line: {"command": "...", "input": "..."},
+    //and writes "ready" once on startup and then one response per line: "ok <result>" or "error <message>"
+    class Yt_DlpWorkerPool
+    {
+    public:
+        //a background request(e.g. resolving the tracks ahead) waits while there are interactive ones waiting, so it doesn't delay a command
+        enum class Priority
+        {
+            Interactive,
+            Background
+        };
+
+    public:
+        Yt_DlpWorkerPool() = delete;
+        Yt_DlpWorkerPool(const Yt_DlpWorkerPool&) = delete;
+        Yt_DlpWorkerPool(Yt_DlpWorkerPool&&) = delete;
+        Yt_DlpWorkerPool& operator=(const Yt_DlpWorkerPool&) = delete;
+        Yt_DlpWorkerPool& operator=(Yt_DlpWorkerPool&&) = delete;
+        ~Yt_DlpWorkerPool() = delete;
+
+    public:
+        //if the first worker does not say it is ready, the pool stays not running and callers use yt-dlp executable
+        static void Launch(std::string workerCommand, size_t workersCount);
+
+        //if all workers are busy, waits for one in the order of calls of the same priority.
+        //when stopToken is requested, the worker is killed and relaunched, so a long request can be cancelled.
+        //if the worker has died while idle, it is relaunched and the request is retried once
+        static std::string Request(const std::string_view& command, const std::string_view& input, std::stop_token stopToken = {}, Priority priority = Priority::Interactive);
+
+        //the same as yt-dlp --dump-single-json --flat-playlist
+        static std::string RequestFlatJSON(const std::string_view& url, std::stop_token stopToken = {});
+        //the same as yt-dlp --dump-single-json
+        static std::string RequestJSON(const std::string_view& input, std::stop_token stopToken = {});
+        //the same as yt-dlp -f bestaudio --get-url, for a search returns the url of the first result
+        static std::string RequestRawURL(const std::string_view& input, std::stop_token stopToken = {}, Priority priority = Priority::Interactive);
+
+        //observes how long a call of yt-dlp takes, or counts it as a failed one if it throws. byWorker tells whether it is handled by a worker or by yt-dlp executable
+        static Metrics::ScopedTimer MeasureCall(const std::string_view& command, bool byWorker);
+
+    public:
+        static bool IsRunning();
+        static size_t GetWorkersCount();
+        //how many requests of both priorities are waiting for a free worker
+        static size_t GetQueuedRequestsCount();
+    };
+}
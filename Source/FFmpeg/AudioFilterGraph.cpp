@@ -0,0 +1,360 @@
+#define NOMINMAX
+#include "AudioFilterGraph.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <GuelderConsoleLog.hpp>
+
+extern "C"
+{
+#include <libavutil/channel_layout.h>
+#include <libavutil/frame.h>
+#include <libavfilter/avfilter.h>
+#include <libavfilter/buffersrc.h>
+#include <libavfilter/buffersink.h>
+}
+
+#include "../Utils.hpp"
+
+namespace Orchestra
+{
+    AudioFilterGraph::AudioFilterGraph(int sampleRate, int channelsCount, float speed, bool preservePitch, bool useNativeEqualizer)
+        : m_FilterGraph(nullptr, FFmpegUniquePtrManager::FreeAVFilterGraph),
+        m_Frame(av_frame_alloc(), FFmpegUniquePtrManager::FreeAVFrame),
+        m_FilteredFrame(av_frame_alloc(), FFmpegUniquePtrManager::FreeAVFrame),
+        m_SampleRate(sampleRate),
+        m_ChannelsCount(channelsCount),
+        m_Speed(speed),
+        m_PreservePitch(preservePitch),
+        m_UseNativeEqualizer(useNativeEqualizer),
+        m_IsBypassing(false),
+        m_NextPTS(0),
+        m_BassBoostDecibels(0.f),
+        m_BassBoostFrequency(0.f),
+        m_BassBoostBandwidth(0.f),
+        m_EqualizerArgs("0"),
+        m_HasEqualizerGains(false),
+        m_NativeEqualizer(sampleRate, channelsCount)
+    {
+        O_ASSERT(m_Frame && m_FilteredFrame, "Failed to allocate frames");
+
+        ResetGraph();
+    }
+
+    AudioFilterGraph::AudioFilterGraph(const AudioFilterGraph& other)
+        : AudioFilterGraph(other.m_SampleRate, other.m_ChannelsCount, other.m_Speed, other.m_PreservePitch, other.m_UseNativeEqualizer)
+    {
+        m_BassBoostDecibels = other.m_BassBoostDecibels;
+        m_BassBoostFrequency = other.m_BassBoostFrequency;
+        m_BassBoostBandwidth = other.m_BassBoostBandwidth;
+        m_EqualizerArgs = other.m_EqualizerArgs;
+        m_HasEqualizerGains = other.m_HasEqualizerGains;
+        m_NativeEqualizer = other.m_NativeEqualizer;
+        m_NativeEqualizer.ClearState();
+
+        ApplySettings();
+    }
+    AudioFilterGraph& AudioFilterGraph::operator=(const AudioFilterGraph& other)
+    {
+        m_SampleRate = other.m_SampleRate;
+        m_ChannelsCount = other.m_ChannelsCount;
+        m_Speed = other.m_Speed;
+        m_PreservePitch = other.m_PreservePitch;
+        m_UseNativeEqualizer = other.m_UseNativeEqualizer;
+
+        m_BassBoostDecibels = other.m_BassBoostDecibels;
+        m_BassBoostFrequency = other.m_BassBoostFrequency;
+        m_BassBoostBandwidth = other.m_BassBoostBandwidth;
+        m_EqualizerArgs = other.m_EqualizerArgs;
+        m_HasEqualizerGains = other.m_HasEqualizerGains;
+        m_NativeEqualizer = other.m_NativeEqualizer;
+        m_NativeEqualizer.ClearState();
+
+        ResetGraph();
+
+        return *this;
+    }
+
+    void AudioFilterGraph::Process(std::span<const uint8_t> in, std::vector<uint8_t>& out)
+    {
+        const int bytesPerInSample = m_ChannelsCount * av_get_bytes_per_sample(SAMPLE_FORMAT);
+        const int bytesPerOutSample = OUT_CHANNELS_COUNT * av_get_bytes_per_sample(SAMPLE_FORMAT);
+
+        if(IsNeutral())
+        {
+            //the audio which stayed in the graph is dropped, it is a few milliseconds at most
+            m_IsBypassing = true;
+
+            const size_t size = in.size() / bytesPerInSample * bytesPerInSample;
+            const size_t offset = out.size();
+
+            out.resize(offset + size);
+            std::memcpy(out.data() + offset, in.data(), size);
+
+            return;
+        }
+
+        //the graph hasn't seen the bypassed audio, so its timestamps and the filters' history are started anew
+        if(m_IsBypassing)
+        {
+            m_NativeEqualizer.ClearState();
+            ResetGraph();
+        }
+
+        AVFrame* frame = m_Frame.get();
+
+        //av_buffersrc_add_frame takes the frame's buffer, so every call needs a new one
+        frame->format = SAMPLE_FORMAT;
+        frame->sample_rate = m_SampleRate;
+        frame->nb_samples = static_cast<int>(in.size() / bytesPerInSample);
+        frame->pts = m_NextPTS;
+        av_channel_layout_default(&frame->ch_layout, m_ChannelsCount);
+
+        if(!frame->nb_samples)
+            return;
+
+        O_ASSERT(av_frame_get_buffer(frame, 0) >= 0, "Failed to allocate a buffer for the filtered frame");
+
+        std::memcpy(frame->data[0], in.data(), static_cast<size_t>(frame->nb_samples) * bytesPerInSample);
+
+        if(m_UseNativeEqualizer)
+            m_NativeEqualizer.Process({ reinterpret_cast<int16_t*>(frame->data[0]), static_cast<size_t>(frame->nb_samples) * m_ChannelsCount });
+
+        m_NextPTS += frame->nb_samples;
+
+        O_ASSERT(av_buffersrc_add_frame(m_Filters.bufferSource, frame) >= 0, "Failed to apply filter to the frame");
+
+        int result;
+
+        while((result = av_buffersink_get_frame(m_Filters.bufferSink, m_FilteredFrame.get())) >= 0)
+        {
+            const size_t filteredSize = static_cast<size_t>(m_FilteredFrame->nb_samples) * bytesPerOutSample;
+            const size_t offset = out.size();
+
+            out.resize(offset + filteredSize);
+            std::memcpy(out.data() + offset, m_FilteredFrame->data[0], filteredSize);
+
+            //returns the buffer to the sink's pool, the frame itself stays allocated for the next call
+            av_frame_unref(m_FilteredFrame.get());
+        }
+
+        O_ASSERT(result == AVERROR(EAGAIN) || result == AVERROR_EOF, "Failed to receive a frame from filter sink");
+    }
+
+    void AudioFilterGraph::Reset(int sampleRate, int channelsCount)
+    {
+        m_SampleRate = sampleRate;
+        m_ChannelsCount = channelsCount;
+
+        m_NativeEqualizer.Reset(sampleRate, channelsCount);
+
+        ResetGraph();
+    }
+
+    void AudioFilterGraph::ResetGraph()
+    {
+        using namespace GuelderConsoleLog;
+
+        m_FilterGraph.reset(avfilter_graph_alloc());
+        O_ASSERT(m_FilterGraph, "Failed to allocate filter graph");
+
+        m_NextPTS = 0;
+        m_IsBypassing = false;
+
+        AVChannelLayout channelLayout;
+        av_channel_layout_default(&channelLayout, m_ChannelsCount);
+
+        const std::string args = Logger::Format("time_base=1/", m_SampleRate, ":sample_rate=", m_SampleRate, ":sample_fmt=", av_get_sample_fmt_name(SAMPLE_FORMAT), ":channel_layout=", channelLayout.u.mask);
+
+        m_Filters.bufferSource = CreateFilterContext("abuffer", nullptr, "in", args);
+        AVFilterContext* lastFilter = m_Filters.bufferSource;
+
+        //m_NativeEqualizer is applied before the audio gets to the graph
+        if(m_UseNativeEqualizer)
+        {
+            m_Filters.bass = nullptr;
+            m_Filters.equalizer = nullptr;
+        }
+        else
+        {
+            m_Filters.bass = CreateFilterContext("bass", m_Filters.bufferSource);
+            m_Filters.equalizer = CreateFilterContext("firequalizer", m_Filters.bass);
+
+            lastFilter = m_Filters.equalizer;
+        }
+
+        //atempo is not free even with tempo 1, so it is there only when it is needed
+        if(IsPitchPreserved())
+        {
+            m_Filters.firstTempo = CreateFilterContext("atempo", lastFilter, "atempo0", GetTempoArgs());
+            m_Filters.secondTempo = CreateFilterContext("atempo", m_Filters.firstTempo, "atempo1", GetTempoArgs());
+
+            lastFilter = m_Filters.secondTempo;
+        }
+        else
+        {
+            m_Filters.firstTempo = nullptr;
+            m_Filters.secondTempo = nullptr;
+        }
+
+        m_Filters.resampler = CreateFilterContext("aresample", lastFilter, "aresample", Logger::Format(GetResampledSampleRate()));
+        m_Filters.format = CreateFilterContext("aformat", m_Filters.resampler, "aformat", Logger::Format("sample_fmts=", av_get_sample_fmt_name(SAMPLE_FORMAT), ":channel_layouts=stereo"));
+        m_Filters.bufferSink = CreateFilterContext("abuffersink", m_Filters.format, "out");
+
+        O_ASSERT(avfilter_graph_config(m_FilterGraph.get(), nullptr) >= 0, "Failed to configure filter graph");
+
+        ApplySettings();
+    }
+    void AudioFilterGraph::ApplySettings() const
+    {
+        using namespace GuelderConsoleLog;
+
+        if(m_UseNativeEqualizer)
+            return;
+
+        O_ASSERT(avfilter_graph_send_command(m_FilterGraph.get(), "bass", "g", Logger::Format(m_BassBoostDecibels).c_str(), nullptr, 0, 0) >= 0, "Failed to set \"g\" parameter to \"bass\" filter");
+        O_ASSERT(avfilter_graph_send_command(m_FilterGraph.get(), "bass", "f", Logger::Format(m_BassBoostFrequency).c_str(), nullptr, 0, 0) >= 0, "Failed to set \"f\" parameter to \"bass\" filter");
+        O_ASSERT(avfilter_graph_send_command(m_FilterGraph.get(), "bass", "w", Logger::Format(m_BassBoostBandwidth).c_str(), nullptr, 0, 0) >= 0, "Failed to set \"w\" parameter to \"bass\" filter");
+
+        O_ASSERT(avfilter_graph_send_command(m_FilterGraph.get(), "firequalizer", "gain_entry", m_EqualizerArgs.c_str(), nullptr, 0, 0) >= 0, "Failed to set \"gain\" parameter to \"equalizer\" filter");
+    }
+
+    std::string AudioFilterGraph::GetTempoArgs() const
+    {
+        return GuelderConsoleLog::Logger::Format(std::sqrt(m_Speed));
+    }
+    int AudioFilterGraph::GetResampledSampleRate() const
+    {
+        return IsPitchPreserved() ? m_SampleRate : static_cast<int>(std::lround(m_SampleRate / m_Speed));
+    }
+
+    AVFilterContext* AudioFilterGraph::CreateFilterContext(const std::string_view& filterNameToFind, AVFilterContext* link, const std::string_view& customName, const std::string_view& args) const
+    {
+        const AVFilter* filter = avfilter_get_by_name(filterNameToFind.data());
+        O_ASSERT(filter, "Failed to find filter with ", filterNameToFind);
+        AVFilterContext* filterContext = nullptr;
+
+        O_ASSERT(avfilter_graph_create_filter(&filterContext, filter, customName.empty() ? filterNameToFind.data() : customName.data(), args.data(), nullptr, m_FilterGraph.get()) >= 0, "Failed to create filter with ", filterNameToFind);
+
+        if(link)
+            O_ASSERT(!avfilter_link(link, 0, filterContext, 0), "Failed to link filter with ", filterNameToFind);
+
+        return filterContext;
+    }
+}
+//getters, setters
+namespace Orchestra
+{
+    void AudioFilterGraph::SetBassBoost(float decibelsBoost, float frequencyToAdjust, float bandwidth)
+    {
+        m_BassBoostDecibels = decibelsBoost;
+        m_BassBoostFrequency = frequencyToAdjust;
+        m_BassBoostBandwidth = bandwidth;
+
+        m_NativeEqualizer.SetBassBoost(decibelsBoost, frequencyToAdjust, bandwidth);
+
+        ApplySettings();
+    }
+    void AudioFilterGraph::SetEqualizer(const std::map<float, float>& frequencies)
+    {
+        using namespace GuelderConsoleLog;
+
+        m_HasEqualizerGains = std::ranges::any_of(frequencies, [](const auto& frequency) { return frequency.second != 0.f; });
+
+        if(frequencies.empty())
+            m_EqualizerArgs = '0';
+        else
+        {
+            auto it = frequencies.begin();
+
+            m_EqualizerArgs = Logger::Format("entry(", it->first, ", ", it->second, ")");
+
+            ++it;
+
+            for(; it != frequencies.end(); ++it)
+                m_EqualizerArgs += Logger::Format(";entry(", it->first, ", ", it->second, ')');
+        }
+
+        m_NativeEqualizer.SetEqualizer(frequencies);
+
+        ApplySettings();
+    }
+    void AudioFilterGraph::SetSpeed(float speed)
+    {
+        O_ASSERT(speed > 0.f, "Invalid speed ", speed);
+
+        if(speed == m_Speed)
+            return;
+
+        const bool wasPitchPreserved = IsPitchPreserved();
+
+        m_Speed = speed;
+
+        //from or to resampling
+        if(!wasPitchPreserved || !IsPitchPreserved())
+        {
+            ResetGraph();
+
+            return;
+        }
+
+        const std::string args = GetTempoArgs();
+
+        O_ASSERT(avfilter_graph_send_command(m_FilterGraph.get(), "atempo0", "tempo", args.c_str(), nullptr, 0, 0) >= 0, "Failed to set \"tempo\" parameter to \"atempo\" filter");
+        O_ASSERT(avfilter_graph_send_command(m_FilterGraph.get(), "atempo1", "tempo", args.c_str(), nullptr, 0, 0) >= 0, "Failed to set \"tempo\" parameter to \"atempo\" filter");
+    }
+    void AudioFilterGraph::SetPreservePitch(bool preservePitch)
+    {
+        if(preservePitch == m_PreservePitch)
+            return;
+
+        m_PreservePitch = preservePitch;
+
+        ResetGraph();
+    }
+    void AudioFilterGraph::SetUseNativeEqualizer(bool useNativeEqualizer)
+    {
+        if(useNativeEqualizer == m_UseNativeEqualizer)
+            return;
+
+        m_UseNativeEqualizer = useNativeEqualizer;
+        m_NativeEqualizer.ClearState();
+
+        ResetGraph();
+    }
+
+    int AudioFilterGraph::GetSampleRate() const noexcept
+    {
+        return m_SampleRate;
+    }
+    int AudioFilterGraph::GetChannelsCount() const noexcept
+    {
+        return m_ChannelsCount;
+    }
+    float AudioFilterGraph::GetSpeed() const noexcept
+    {
+        return m_Speed;
+    }
+    bool AudioFilterGraph::GetPreservePitch() const noexcept
+    {
+        return m_PreservePitch;
+    }
+    bool AudioFilterGraph::GetUseNativeEqualizer() const noexcept
+    {
+        return m_UseNativeEqualizer;
+    }
+
+    bool AudioFilterGraph::HasNoEffects() const noexcept
+    {
+        return m_BassBoostDecibels == 0.f && !m_HasEqualizerGains && m_Speed == 1.f;
+    }
+    bool AudioFilterGraph::IsNeutral() const noexcept
+    {
+        return HasNoEffects() && m_ChannelsCount == OUT_CHANNELS_COUNT;
+    }
+    bool AudioFilterGraph::IsPitchPreserved() const noexcept
+    {
+        return m_PreservePitch && m_Speed >= MIN_PITCH_PRESERVING_SPEED && m_Speed <= MAX_PITCH_PRESERVING_SPEED;
+    }
+}
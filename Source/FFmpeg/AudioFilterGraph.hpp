@@ -0,0 +1,121 @@
+#pragma once
+
+#include <map>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+extern "C"
+{
+#include <libavutil/samplefmt.h>
+}
+
+#include "FFmpegUniquePtrManager.hpp"
+#include "../DSP/BiquadEqualizer.hpp"
+
+namespace Orchestra
+{
+    //applies bass boost, equalizer and speed to packed PCM right before it is sent, so changing them doesn't require decoding the audio again.
+    //bass boost and equalizer are done either by libavfilter's bass and firequalizer or by BiquadEqualizer, which is much cheaper and isn't run at all when it is flat
+    class AudioFilterGraph
+    {
+    public:
+        static constexpr AVSampleFormat SAMPLE_FORMAT = AV_SAMPLE_FMT_S16;
+        //the output is always stereo, as the voice client expects it
+        static constexpr int OUT_CHANNELS_COUNT = 2;
+        //two atempo filters are chained, each of them is limited to [0.5, 100]. The other speeds are resampled even with preserved pitch
+        static constexpr float MIN_PITCH_PRESERVING_SPEED = .25f;
+        static constexpr float MAX_PITCH_PRESERVING_SPEED = 100.f;
+    public:
+        AudioFilterGraph(int sampleRate = 48000, int channelsCount = OUT_CHANNELS_COUNT, float speed = 1.f, bool preservePitch = false, bool useNativeEqualizer = false);
+        ~AudioFilterGraph() = default;
+
+        //the audio which stays in the filters is not copied
+        AudioFilterGraph(const AudioFilterGraph& other);
+        AudioFilterGraph& operator=(const AudioFilterGraph& other);
+        AudioFilterGraph(AudioFilterGraph&& other) noexcept = default;
+        AudioFilterGraph& operator=(AudioFilterGraph&& other) noexcept = default;
+
+        //filters in and appends the result to out, some of the audio can stay in the filters till the next call.
+        //while IsNeutral, in is appended as it is and the graph isn't touched, it is rebuilt once something is enabled again
+        void Process(std::span<const uint8_t> in, std::vector<uint8_t>& out);
+
+        //rebuilds the graph, the audio which stays in the filters is dropped
+        void Reset(int sampleRate, int channelsCount);
+
+    public:
+        void SetBassBoost(float decibelsBoost = 0.f, float frequencyToAdjust = 0.f, float bandwidth = 0.f);
+        void SetEqualizer(const std::map<float, float>& frequencies);
+        //with preserved pitch it is changed right in the running atempo filters, otherwise(or if atempo can't do the old or the new speed) the audio is resampled, but is still played with the input sample rate, which changes the pitch too and rebuilds the graph
+        void SetSpeed(float speed);
+        //rebuilds the graph, it is kept for the next speeds even if the current one can't preserve the pitch
+        void SetPreservePitch(bool preservePitch);
+        //rebuilds the graph without bass and firequalizer filters if true
+        void SetUseNativeEqualizer(bool useNativeEqualizer);
+
+        int GetSampleRate() const noexcept;
+        int GetChannelsCount() const noexcept;
+        float GetSpeed() const noexcept;
+        bool GetPreservePitch() const noexcept;
+        bool GetUseNativeEqualizer() const noexcept;
+
+        //no bass boost, all equalizer gains are 0 and the speed is 1
+        bool HasNoEffects() const noexcept;
+        //HasNoEffects and the input is already in the output format, so the graph would only copy it
+        bool IsNeutral() const noexcept;
+
+    private:
+        //m_PreservePitch and the speed is in [MIN_PITCH_PRESERVING_SPEED, MAX_PITCH_PRESERVING_SPEED]
+        bool IsPitchPreserved() const noexcept;
+
+        void ResetGraph();
+        void ApplySettings() const;
+
+        //the tempo of each of the chained atempo filters
+        std::string GetTempoArgs() const;
+        //the sample rate the audio is resampled to when the pitch isn't preserved
+        int GetResampledSampleRate() const;
+
+        AVFilterContext* CreateFilterContext(const std::string_view& filterNameToFind, AVFilterContext* link = nullptr, const std::string_view& customName = "", const std::string_view& args = "") const;
+
+    private:
+        FFmpegUniquePtrManager::UniquePtrAVFilterGraph m_FilterGraph;
+        FFmpegUniquePtrManager::UniquePtrAVFrame m_Frame;
+        //is reused for every frame received from m_Filters.bufferSink
+        FFmpegUniquePtrManager::UniquePtrAVFrame m_FilteredFrame;
+
+        struct
+        {
+            AVFilterContext* bufferSource;
+            AVFilterContext* bass;
+            AVFilterContext* equalizer;
+            AVFilterContext* firstTempo;
+            AVFilterContext* secondTempo;
+            AVFilterContext* resampler;
+            AVFilterContext* format;
+            AVFilterContext* bufferSink;
+        } m_Filters{ nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr };
+
+        int m_SampleRate;
+        int m_ChannelsCount;
+        float m_Speed;
+        bool m_PreservePitch;
+        bool m_UseNativeEqualizer;
+        //whether the last Process bypassed the graph, so it must be rebuilt before it is used again
+        bool m_IsBypassing;
+        //in samples of m_SampleRate
+        int64_t m_NextPTS;
+
+        //are reapplied every time the graph is rebuilt
+        float m_BassBoostDecibels;
+        float m_BassBoostFrequency;
+        float m_BassBoostBandwidth;
+        std::string m_EqualizerArgs;
+        bool m_HasEqualizerGains;
+
+        //always has the same settings as the libavfilter's filters, so switching between them is seamless
+        BiquadEqualizer m_NativeEqualizer;
+    };
+}
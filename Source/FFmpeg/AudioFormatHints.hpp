@@ -0,0 +1,21 @@
+#pragma once
+
+#include <string>
+
+namespace Orchestra
+{
+    //what is already known about the audio of a url before opening it(e.g. from yt-dlp's json), so Decoder can skip probing it
+    struct AudioFormatHints
+    {
+        //yt-dlp's ext, e.g. "webm" or "m4a"
+        std::string container;
+        //yt-dlp's acodec, e.g. "opus" or "mp4a.40.2"
+        std::string codec;
+        //0 if unknown
+        int sampleRate = 0;
+        //0 if unknown
+        int channelsCount = 0;
+
+        bool IsEmpty() const { return container.empty() || codec.empty(); }
+    };
+}
@@ -4,6 +4,7 @@
 #include <string_view>
 #include <GuelderConsoleLog.hpp>
 #include <map>
+#include <algorithm>
 
 #include "GuelderResourcesManager.hpp"
 
@@ -16,12 +17,10 @@ extern "C"
 #include <libavutil/samplefmt.h>
 #include <libswresample/swresample.h>
 #include <libswscale/swscale.h>
-#include <libavfilter/avfilter.h>
-#include <libavfilter/buffersrc.h>
-#include <libavfilter/buffersink.h>
 }
 
 #include "../Utils.hpp"
+#include "OpusPacket.hpp"
 
 //public
 namespace Orchestra
@@ -32,21 +31,24 @@ namespace Orchestra
         m_SwrContext(nullptr, FFmpegUniquePtrManager::FreeSwrContext),
         m_Packet(nullptr, FFmpegUniquePtrManager::FreeAVPacket),
         m_Frame(nullptr, FFmpegUniquePtrManager::FreeAVFrame),
-        m_FilterGraph(nullptr, FFmpegUniquePtrManager::FreeAVFilterGraph),
         m_MaxBufferSize(0),
+        m_MaxOutBufferSize(0),
         m_AudioStreamIndex(std::numeric_limits<uint32_t>::max()),
         m_OutSampleFormat(AV_SAMPLE_FMT_NONE),
-        m_OutSampleRate(0) {}
-    Decoder::Decoder(const std::string_view& url, int outSampleRate, AVSampleFormat outSampleFormat)
-        : m_FormatContext(nullptr, FFmpegUniquePtrManager::FreeFormatContext),
+        m_OutSampleRate(0),
+        m_InitialSeekIndexEntriesCount(0) {}
+    Decoder::Decoder(const std::string_view& url, int outSampleRate, AVSampleFormat outSampleFormat, SharedSource::DownloadedCallback onDownloaded, std::stop_token stopToken, const AudioFormatHints& formatHints)
+        : m_InterruptState(std::make_shared<InterruptState>(std::move(stopToken), std::chrono::steady_clock::now() + OPEN_TIMEOUT)),
+        m_FormatContext(nullptr, FFmpegUniquePtrManager::FreeFormatContext),
         m_CodecContext(nullptr, FFmpegUniquePtrManager::FreeAVCodecContext),
         m_SwrContext(nullptr, FFmpegUniquePtrManager::FreeSwrContext),
         m_Packet(nullptr, FFmpegUniquePtrManager::FreeAVPacket),
         m_Frame(nullptr, FFmpegUniquePtrManager::FreeAVFrame),
-        m_FilterGraph(nullptr, FFmpegUniquePtrManager::FreeAVFilterGraph),
+        m_MaxOutBufferSize(0),
         m_AudioStreamIndex(std::numeric_limits<uint32_t>::max()),
         m_OutSampleFormat(outSampleFormat),
-        m_OutSampleRate(outSampleRate)
+        m_OutSampleRate(outSampleRate),
+        m_InitialSeekIndexEntriesCount(0)
     {
         av_log_set_level(AV_LOG_WARNING);
 
@@ -65,16 +67,67 @@ namespace Orchestra
 
         O_ASSERT(f, "Failed to initialize format context");
 
+        f->interrupt_callback = { InterruptCallback, m_InterruptState.get() };
+
+        if(auto sharedSource = SharedSource::Acquire(url, std::move(onDownloaded), f->interrupt_callback))
+        {
+            if(sharedSource->IsShared())
+            {
+                m_SharedSourceReader = std::make_shared<SharedSource::Reader>(std::move(sharedSource), m_InterruptState->stopToken);
+                f->pb = m_SharedSourceReader->GetIOContext();
+            }
+            else
+            {
+                //the url is already opened, so avformat_open_input doesn't open it again
+                m_UnsharedSource = std::move(sharedSource);
+                f->pb = m_UnsharedSource->GetIOContext();
+            }
+        }
+
         //WTF?! why when I use m_FormatContext as ptr it crashes, but when a default ptr it works fine!!????
         //auto ptr = m_FormatContext.get();
         auto ptr = f;
-        O_ASSERT(avformat_open_input(&ptr, url.data(), nullptr, &options) == 0, "Failed to open url: ", url);
 
-        O_ASSERT((avformat_find_stream_info(ptr, nullptr)) >= 0, "Failed to retrieve stream info");
+        const auto openBeginning = std::chrono::steady_clock::now();
+
+        //frees f on failure
+        const int openResult = avformat_open_input(&ptr, url.data(), nullptr, &options);
+
+        m_OpenTimings.open = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - openBeginning);
+
+        av_dict_free(&options);
+
+        O_ASSERT(openResult == 0, "Failed to open url: ", url, m_InterruptState->stopToken.stop_requested() ? ", it has been cancelled" : openResult == AVERROR_EXIT ? " in time" : "");
 
         m_FormatContext.reset(f);
         f = nullptr;
 
+        //after the reset, so the opened context is freed if the stop has come right after opening
+        O_ASSERT(!m_InterruptState->stopToken.stop_requested(), "Opening of ", url, " has been cancelled");
+
+        //probing reads and decodes the beginning of the stream, which is the longest part of opening a remote url
+        m_OpenTimings.hasSkippedProbing = MatchesFormatHints(formatHints);
+
+        if(!m_OpenTimings.hasSkippedProbing)
+        {
+            const auto probeBeginning = std::chrono::steady_clock::now();
+
+            const int findStreamInfoResult = avformat_find_stream_info(m_FormatContext.get(), nullptr);
+
+            m_OpenTimings.probe = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - probeBeginning);
+
+            O_ASSERT(!m_InterruptState->stopToken.stop_requested(), "Opening of ", url, " has been cancelled");
+            O_ASSERT(findStreamInfoResult >= 0, "Failed to retrieve stream info", findStreamInfoResult == AVERROR_EXIT ? " in time" : "");
+        }
+
+        if(m_OpenTimings.hasSkippedProbing)
+            GE_LOG(Orchestra, Info, "Opened the audio in ", std::chrono::duration<float, std::milli>(m_OpenTimings.open).count(), "ms, probing has been skipped thanks to the format hints.");
+        else
+            GE_LOG(Orchestra, Info, "Opened the audio in ", std::chrono::duration<float, std::milli>(m_OpenTimings.open).count(), "ms, probed it in ", std::chrono::duration<float, std::milli>(m_OpenTimings.probe).count(), "ms.");
+
+        //only the stop token aborts the reads of an opened url, a paused track can wait for reconnecting as long as it wants
+        m_InterruptState->deadline = std::chrono::steady_clock::time_point::max();
+
         m_AudioStreamIndex = FindStreamIndex(AVMEDIA_TYPE_AUDIO);
 
         const AVCodecParameters* codecParameters = m_FormatContext->streams[m_AudioStreamIndex]->codecpar;
@@ -85,104 +138,118 @@ namespace Orchestra
         O_ASSERT(avcodec_parameters_to_context(m_CodecContext.get(), codecParameters) >= 0, "Failed to copy codec parameters to codec context");
         O_ASSERT(avcodec_open2(m_CodecContext.get(), codec, nullptr) >= 0, "Failed to open codec through avcodec_open2");
 
-        m_SwrContext = FFmpegUniquePtrManager::UniquePtrSwrContext(swr_alloc(), FFmpegUniquePtrManager::FreeSwrContext);
-
-        av_opt_set_chlayout(m_SwrContext.get(), "in_chlayout", &m_CodecContext->ch_layout, 0);
-        av_opt_set_chlayout(m_SwrContext.get(), "out_chlayout", &m_CodecContext->ch_layout, 0);
-        av_opt_set_int(m_SwrContext.get(), "in_sample_rate", m_CodecContext->sample_rate, 0);
-        av_opt_set_int(m_SwrContext.get(), "out_sample_rate", m_OutSampleRate, 0);
-        av_opt_set_sample_fmt(m_SwrContext.get(), "in_sample_fmt", m_CodecContext->sample_fmt, 0);
-        av_opt_set_sample_fmt(m_SwrContext.get(), "out_sample_fmt", m_OutSampleFormat, 0);
-
-        O_ASSERT(swr_init(m_SwrContext.get()) >= 0, "Failed to initialize swrContext");
-
         m_Packet = FFmpegUniquePtrManager::UniquePtrAVPacket(av_packet_alloc(), FFmpegUniquePtrManager::FreeAVPacket);
         m_Frame = FFmpegUniquePtrManager::UniquePtrAVFrame(av_frame_alloc(), FFmpegUniquePtrManager::FreeAVFrame);
 
+        O_ASSERT(m_Packet && m_Frame, "Failed to allocate a packet or a frame");
+
         m_MaxBufferSize = av_samples_get_buffer_size(nullptr, m_CodecContext->ch_layout.nb_channels, m_CodecContext->frame_size, m_CodecContext->sample_fmt, 0);
         if(m_MaxBufferSize < 0)
             m_MaxBufferSize = 1024;
 
-        ResetGraph();
+        ResetSwrContext();
     }
     Decoder::Decoder(const Decoder& other)
-        : m_FormatContext(CloneUniquePtr(other.m_FormatContext)),
+        : m_InterruptState(other.m_InterruptState),
+        m_SharedSourceReader(other.m_SharedSourceReader),
+        m_UnsharedSource(other.m_UnsharedSource),
+        m_FormatContext(CloneUniquePtr(other.m_FormatContext)),
         m_CodecContext(CloneUniquePtr(other.m_CodecContext)),
         m_SwrContext(DuplicateSwrContext(other.m_SwrContext.get()), FFmpegUniquePtrManager::FreeSwrContext),
         m_Packet(CloneUniquePtr(other.m_Packet)),
         m_Frame(CloneUniquePtr(other.m_Frame)),
-        m_FilterGraph(CloneUniquePtr(other.m_FilterGraph)),
-        m_Filters(other.m_Filters),
         m_MaxBufferSize(other.m_MaxBufferSize),
+        m_MaxOutBufferSize(other.m_MaxOutBufferSize),
         m_AudioStreamIndex(other.m_AudioStreamIndex),
         m_OutSampleFormat(other.m_OutSampleFormat),
-        m_OutSampleRate(other.m_OutSampleRate)
+        m_OutSampleRate(other.m_OutSampleRate),
+        m_OpenTimings(other.m_OpenTimings),
+        m_SeekIndexPath(other.m_SeekIndexPath),
+        m_InitialSeekIndexEntriesCount(other.m_InitialSeekIndexEntriesCount)
     {}
     Decoder& Decoder::operator=(const Decoder& other)
     {
+        m_UnsharedSource = other.m_UnsharedSource;
+        m_InterruptState = other.m_InterruptState;
+        m_SharedSourceReader = other.m_SharedSourceReader;
         *m_FormatContext = *other.m_FormatContext;
         *m_CodecContext = *other.m_CodecContext;
         *m_Packet = *other.m_Packet;
         *m_Frame = *other.m_Frame;
-        *m_FilterGraph = *other.m_FilterGraph;
-        m_Filters = other.m_Filters;
 
         CopySwrParams(other.m_SwrContext.get(), m_SwrContext.get());
 
         m_MaxBufferSize = other.m_MaxBufferSize;
+        m_MaxOutBufferSize = other.m_MaxOutBufferSize;
         m_AudioStreamIndex = other.m_AudioStreamIndex;
         m_OutSampleFormat = other.m_OutSampleFormat;
         m_OutSampleRate = other.m_OutSampleRate;
+        m_SeekIndexPath = other.m_SeekIndexPath;
+        m_InitialSeekIndexEntriesCount = other.m_InitialSeekIndexEntriesCount;
+        m_OpenTimings = other.m_OpenTimings;
 
         return *this;
     }
-
-    std::vector<uint8_t> Decoder::DecodeAudioFrame() const
+    Decoder& Decoder::operator=(Decoder&& other) noexcept
     {
-        O_ASSERT(avcodec_send_packet(m_CodecContext.get(), m_Packet.get()) >= 0, "Failed to send a packet to the decoder");
-
-        std::vector<uint8_t> out;
-        out.reserve(m_MaxBufferSize);
+        m_FormatContext = std::move(other.m_FormatContext);
+        //before m_InterruptState, which the previous one may use
+        m_UnsharedSource = std::move(other.m_UnsharedSource);
+        m_InterruptState = std::move(other.m_InterruptState);
+        m_SharedSourceReader = std::move(other.m_SharedSourceReader);
+        m_CodecContext = std::move(other.m_CodecContext);
+        m_SwrContext = std::move(other.m_SwrContext);
+        m_Packet = std::move(other.m_Packet);
+        m_Frame = std::move(other.m_Frame);
 
-        if(avcodec_receive_frame(m_CodecContext.get(), m_Frame.get()) == 0)
-        {
-            FFmpegUniquePtrManager::UniquePtrAVFrame allocatedFrame = FFmpegUniquePtrManager::UniquePtrAVFrame(nullptr, FFmpegUniquePtrManager::FreeAVFrame);
+        m_MaxBufferSize = other.m_MaxBufferSize;
+        m_MaxOutBufferSize = other.m_MaxOutBufferSize;
+        m_AudioStreamIndex = other.m_AudioStreamIndex;
+        m_OutSampleFormat = other.m_OutSampleFormat;
+        m_OutSampleRate = other.m_OutSampleRate;
+        m_SeekIndexPath = std::move(other.m_SeekIndexPath);
+        m_InitialSeekIndexEntriesCount = other.m_InitialSeekIndexEntriesCount;
+        m_OpenTimings = other.m_OpenTimings;
 
-            AVFrame* frame = nullptr;
+        return *this;
+    }
 
-            //if(m_FilterGraph)
-            {
-                O_ASSERT(av_buffersrc_add_frame(m_Filters.bufferSource, m_Frame.get()) >= 0, "Failed to apply filter to the frame");
+    size_t Decoder::DecodeAudioFrame(std::span<uint8_t> out) const
+    {
+        O_ASSERT(!av_sample_fmt_is_planar(m_OutSampleFormat), "Cannot decode into a single buffer with a planar sample format ", av_get_sample_fmt_name(m_OutSampleFormat));
 
-                allocatedFrame.reset(av_frame_alloc());
+        //only the first call is timed
+        const auto beginning = m_OpenTimings.firstFrame ? std::chrono::steady_clock::time_point{} : std::chrono::steady_clock::now();
 
-                frame = allocatedFrame.get();
+        O_ASSERT(avcodec_send_packet(m_CodecContext.get(), m_Packet.get()) >= 0, "Failed to send a packet to the decoder");
 
-                O_ASSERT(frame != nullptr, "Failed to initialize a frame, during filter process.");
+        size_t convertedSize = 0;
 
-                O_ASSERT(av_buffersink_get_frame(m_Filters.bufferSink, frame) >= 0, "Failed to receive a frame from filter sink");
-            }
-            //else
-                //frame = m_Frame.get();
+        if(avcodec_receive_frame(m_CodecContext.get(), m_Frame.get()) == 0)
+        {
+            AVFrame* frame = m_Frame.get();
 
-            const int64_t outNumberOfSamples = av_rescale_rnd(swr_get_delay(m_SwrContext.get(), m_CodecContext->sample_rate) + frame->nb_samples, m_OutSampleRate, m_CodecContext->sample_rate, AV_ROUND_UP);
+            const int bytesPerOutSample = m_CodecContext->ch_layout.nb_channels * av_get_bytes_per_sample(m_OutSampleFormat);
 
-            uint8_t* outputBuffer;
-            /*int bufferSize = */av_samples_alloc(&outputBuffer, nullptr, m_CodecContext->ch_layout.nb_channels, outNumberOfSamples, m_OutSampleFormat, 1);
+            //the output is packed, so swr can write right into the caller's buffer without any intermediate one
+            uint8_t* outputBuffer = out.data();
+            const int outNumberOfSamples = static_cast<int>(out.size() / bytesPerOutSample);
 
             int convertedSamples = 0;
-            O_ASSERT((convertedSamples = swr_convert(m_SwrContext.get(), &outputBuffer, outNumberOfSamples, const_cast<const uint8_t**>(frame->data), frame->nb_samples)) > 0, "Failed to convert samples");
+            O_ASSERT((convertedSamples = swr_convert(m_SwrContext.get(), &outputBuffer, outNumberOfSamples, const_cast<const uint8_t**>(frame->data), frame->nb_samples)) >= 0, "Failed to convert samples");
 
-            const size_t convertedSize = static_cast<size_t>(convertedSamples) * m_CodecContext->ch_layout.nb_channels * av_get_bytes_per_sample(m_OutSampleFormat);
+            convertedSize = static_cast<size_t>(convertedSamples) * bytesPerOutSample;
 
-            out.insert(out.begin(), outputBuffer, outputBuffer + convertedSize);
-
-            av_free(outputBuffer);
+            //the frame itself stays allocated for the next call
+            av_frame_unref(frame);
         }
 
         av_packet_unref(m_Packet.get());
 
-        return out;
+        if(!m_OpenTimings.firstFrame)
+            m_OpenTimings.firstFrame = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - beginning);
+
+        return convertedSize;
     }
 
     void Decoder::SkipToTimestamp(int64_t timestamp) const
@@ -206,24 +273,6 @@ namespace Orchestra
         SkipTimestamp(seconds / GetTimestampToSecondsRatio());
     }
 
-    void Decoder::ResetGraph()
-    {
-        m_FilterGraph.reset(avfilter_graph_alloc());
-
-        //sourceBuffer
-        std::string args;
-        args = GuelderConsoleLog::Logger::Format("time_base=", m_FormatContext->streams[m_AudioStreamIndex]->time_base.num, '/', m_FormatContext->streams[m_AudioStreamIndex]->time_base.den, ":sample_rate=", m_CodecContext->sample_rate, ":sample_fmt=", av_get_sample_fmt_name(m_CodecContext->sample_fmt), ":channel_layout=", m_CodecContext->ch_layout.u.mask);
-
-        m_Filters.bufferSource = CreateFilterContext("abuffer", nullptr, "in", args);
-        m_Filters.bass = CreateFilterContext("bass", m_Filters.bufferSource);
-        m_Filters.equalizer = CreateFilterContext("firequalizer", m_Filters.bass);
-        //m_Filters.limiter = CreateFilterContext("
-        //alimiter", m_Filters.equalizer, "alimiter", "0.9");
-        m_Filters.bufferSink = CreateFilterContext("abuffersink", m_Filters.equalizer, "out");
-
-        O_ASSERT(avfilter_graph_config(m_FilterGraph.get(), nullptr) >= 0, "Failed to configure filter graph");
-    }
-
     uint32_t Decoder::FindStreamIndex(AVMediaType mediaType) const
     {
         if(m_AudioStreamIndex == std::numeric_limits<uint32_t>::max())
@@ -238,69 +287,90 @@ namespace Orchestra
 
     bool Decoder::AreThereFramesToProcess() const
     {
-        return (av_read_frame(m_FormatContext.get(), m_Packet.get()) == 0);
+        return ReadFrame() == 0;
+    }
+    bool Decoder::ReadAudioPacket() const
+    {
+        av_packet_unref(m_Packet.get());
+
+        while(ReadFrame() == 0)
+        {
+            if(m_Packet->stream_index == static_cast<int>(m_AudioStreamIndex))
+                return true;
+
+            av_packet_unref(m_Packet.get());
+        }
+
+        return false;
+    }
+    bool Decoder::CanPassthroughOpus() const
+    {
+        const AVCodecParameters* codecParameters = GetStream()->codecpar;
+
+        return codecParameters->codec_id == AV_CODEC_ID_OPUS && codecParameters->sample_rate == DEFAULT_SAMPLE_RATE && codecParameters->ch_layout.nb_channels == 2;
     }
     void Decoder::Reset()
     {
         m_FormatContext.reset();
+        m_UnsharedSource.reset();
+        m_InterruptState.reset();
+        m_SharedSourceReader.reset();
         m_CodecContext.reset();
         m_SwrContext.reset();
         m_Packet.reset();
         m_Frame.reset();
-        m_FilterGraph.reset();
-        m_Filters.bufferSource = nullptr;
-        m_Filters.bass = nullptr;
-        m_Filters.bufferSink = nullptr;
 
         m_MaxBufferSize = 0;
+        m_MaxOutBufferSize = 0;
         m_AudioStreamIndex = std::numeric_limits<uint32_t>::max();
         m_OutSampleFormat = AV_SAMPLE_FMT_NONE;
         m_OutSampleRate = 0;
+        m_SeekIndexPath.clear();
+        m_InitialSeekIndexEntriesCount = 0;
+        m_OpenTimings = {};
     }
     bool Decoder::IsReady() const
     {
         return m_FormatContext && m_CodecContext && m_SwrContext && m_MaxBufferSize > 0 && m_AudioStreamIndex != std::numeric_limits<uint32_t>::max() && m_OutSampleFormat != AV_SAMPLE_FMT_NONE;
     }
-}
-//getters, setters
-namespace Orchestra
-{
-    void Decoder::SetBassBoost(float decibelsBoost, float frequencyToAdjust, float bandwidth) const
+    bool Decoder::IsShared() const noexcept
     {
-        using namespace GuelderConsoleLog;
-
-        O_ASSERT(avfilter_graph_send_command(m_FilterGraph.get(), "bass", "g", Logger::Format(decibelsBoost).c_str(), nullptr, 0, 0) >= 0, "Failed to set \"g\" parameter to \"bass\" filter");
-        O_ASSERT(avfilter_graph_send_command(m_FilterGraph.get(), "bass", "f", Logger::Format(frequencyToAdjust).c_str(), nullptr, 0, 0) >= 0, "Failed to set \"f\" parameter to \"bass\" filter");
-        O_ASSERT(avfilter_graph_send_command(m_FilterGraph.get(), "bass", "w", Logger::Format(bandwidth).c_str(), nullptr, 0, 0) >= 0, "Failed to set \"w\" parameter to \"bass\" filter");
+        return m_SharedSourceReader != nullptr;
     }
 
-    void Decoder::SetEqualizer(const std::string_view& args) const
+    void Decoder::SetSeekIndexPath(std::filesystem::path path)
     {
-        O_ASSERT(avfilter_graph_send_command(m_FilterGraph.get(), "firequalizer", "gain_entry", args.data(), nullptr, 0, 0) >= 0, "Failed to set \"gain\" parameter to \"equalizer\" filter");
-    }
-    void Decoder::SetEqualizer(const std::map<float, float>& frequencies) const
-    {
-        using namespace GuelderConsoleLog;
+        m_SeekIndexPath = std::move(path);
 
-        std::string args;
+        AVStream* stream = GetStream();
 
-        if(frequencies.empty())
-            args = '0';
-        else
-        {
-            auto it = frequencies.begin();
+        if(!m_SeekIndexPath.empty())
+            if(const SeekIndex seekIndex = SeekIndex::Load(m_SeekIndexPath); !seekIndex.IsEmpty())
+            {
+                seekIndex.ApplyTo(stream);
+                GE_LOG(Orchestra, Info, "Loaded a seek index of ", seekIndex.GetEntriesCount(), " entries.");
+            }
+
+        m_InitialSeekIndexEntriesCount = static_cast<size_t>(avformat_index_get_entries_count(stream));
+    }
+    bool Decoder::SaveSeekIndex() const
+    {
+        if(m_SeekIndexPath.empty() || !m_FormatContext)
+            return false;
 
-            args += Logger::Format("entry(", it->first, ", ", it->second, ")");
+        const SeekIndex seekIndex = SeekIndex::FromStream(GetStream());
 
-            ++it;
+        if(seekIndex.GetEntriesCount() <= m_InitialSeekIndexEntriesCount)
+            return false;
 
-            for(; it != frequencies.end(); ++it)
-                args += Logger::Format(";entry(", it->first, ", ", it->second, ')');
-        }
+        seekIndex.Save(m_SeekIndexPath);
 
-        SetEqualizer(args);
+        return true;
     }
-
+}
+//getters, setters
+namespace Orchestra
+{
     int Decoder::GetInitialSampleRate() const
     {
         return m_CodecContext->sample_rate;
@@ -314,35 +384,13 @@ namespace Orchestra
     {
         m_OutSampleFormat = sampleFormat;
 
-        m_SwrContext.reset();
-
-        m_SwrContext = FFmpegUniquePtrManager::UniquePtrSwrContext(swr_alloc(), FFmpegUniquePtrManager::FreeSwrContext);
-
-        av_opt_set_chlayout(m_SwrContext.get(), "in_chlayout", &m_CodecContext->ch_layout, 0);
-        av_opt_set_chlayout(m_SwrContext.get(), "out_chlayout", &m_CodecContext->ch_layout, 0);
-        av_opt_set_int(m_SwrContext.get(), "in_sample_rate", m_CodecContext->sample_rate, 0);
-        av_opt_set_int(m_SwrContext.get(), "out_sample_rate", m_OutSampleRate, 0);
-        av_opt_set_sample_fmt(m_SwrContext.get(), "in_sample_fmt", m_CodecContext->sample_fmt, 0);
-        av_opt_set_sample_fmt(m_SwrContext.get(), "out_sample_fmt", m_OutSampleFormat, 0);
-
-        O_ASSERT(swr_init(m_SwrContext.get()) >= 0, "Failed to initialize swrContext");
+        ResetSwrContext();
     }
     void Decoder::SetOutSampleRate(int sampleRate)
     {
         m_OutSampleRate = sampleRate;
 
-        m_SwrContext.reset();
-
-        m_SwrContext = FFmpegUniquePtrManager::UniquePtrSwrContext(swr_alloc(), FFmpegUniquePtrManager::FreeSwrContext);
-
-        av_opt_set_chlayout(m_SwrContext.get(), "in_chlayout", &m_CodecContext->ch_layout, 0);
-        av_opt_set_chlayout(m_SwrContext.get(), "out_chlayout", &m_CodecContext->ch_layout, 0);
-        av_opt_set_int(m_SwrContext.get(), "in_sample_rate", m_CodecContext->sample_rate, 0);
-        av_opt_set_int(m_SwrContext.get(), "out_sample_rate", m_OutSampleRate, 0);
-        av_opt_set_sample_fmt(m_SwrContext.get(), "in_sample_fmt", m_CodecContext->sample_fmt, 0);
-        av_opt_set_sample_fmt(m_SwrContext.get(), "out_sample_fmt", m_OutSampleFormat, 0);
-
-        O_ASSERT(swr_init(m_SwrContext.get()) >= 0, "Failed to initialize swrContext");
+        ResetSwrContext();
     }
 
     AVSampleFormat Decoder::GetOutSampleFormat() const
@@ -368,12 +416,29 @@ namespace Orchestra
     {
         return m_MaxBufferSize;
     }
+    int Decoder::GetMaxOutBufferSize() const
+    {
+        return m_MaxOutBufferSize;
+    }
 
     int64_t Decoder::GetCurrentTimestamp() const
     {
         return m_Frame->pts;
     }
 
+    std::span<uint8_t> Decoder::GetPacketData() const
+    {
+        return { m_Packet->data, static_cast<size_t>(m_Packet->size) };
+    }
+    float Decoder::GetPacketDurationSeconds() const
+    {
+        if(m_Packet->duration > 0)
+            return static_cast<float>(m_Packet->duration * GetTimestampToSecondsRatio());
+
+        //some demuxers leave the duration unset, so it is taken from the opus TOC byte
+        return GetOpusPacketSeconds(GetPacketData());
+    }
+
     int Decoder::GetBytesPerSample() const
     {
         return av_get_bytes_per_sample(m_OutSampleFormat);
@@ -388,6 +453,15 @@ namespace Orchestra
         return av_q2d(GetStream()->time_base);
     }
 
+    const Decoder::OpenTimings& Decoder::GetOpenTimings() const noexcept
+    {
+        return m_OpenTimings;
+    }
+    const std::filesystem::path& Decoder::GetSeekIndexPath() const noexcept
+    {
+        return m_SeekIndexPath;
+    }
+
     std::string Decoder::GetTitle() const
     {
         const AVDictionaryEntry* tag = av_dict_get(m_FormatContext->metadata, "title", nullptr, 0);
@@ -401,6 +475,13 @@ namespace Orchestra
 //private
 namespace Orchestra
 {
+    int Decoder::InterruptCallback(void* opaque)
+    {
+        const InterruptState& state = *static_cast<const InterruptState*>(opaque);
+
+        return state.stopToken.stop_requested() || std::chrono::steady_clock::now() > state.deadline ? 1 : 0;
+    }
+
     void Decoder::CopySwrParams(SwrContext* from, SwrContext* to)
     {
         //copy swr
@@ -443,17 +524,75 @@ namespace Orchestra
         return m_FormatContext->streams[FindStreamIndex(AVMEDIA_TYPE_AUDIO)];
     }
 
-    AVFilterContext* Decoder::CreateFilterContext(const std::string_view& filterNameToFind, AVFilterContext* link, const std::string_view& customName, const std::string_view& args) const
+    bool Decoder::MatchesFormatHints(const AudioFormatHints& formatHints) const
     {
-        const AVFilter* filter = avfilter_get_by_name(filterNameToFind.data());
-        O_ASSERT(filter, "Failed to find filter with ", filterNameToFind);
-        AVFilterContext* filterContext = nullptr;
+        if(formatHints.IsEmpty() || !av_match_name(formatHints.container.c_str(), m_FormatContext->iformat->name))
+            return false;
+        //the duration is estimated by probing otherwise
+        if(m_FormatContext->duration == AV_NOPTS_VALUE || m_FormatContext->duration <= 0)
+            return false;
+
+        const std::span<AVStream*> streams{ m_FormatContext->streams, m_FormatContext->nb_streams };
+
+        //e.g. mp3 or mpegts streams are found only by probing
+        const auto foundStream = std::ranges::find_if(streams, [](const AVStream* stream) { return stream->codecpar->codec_type == AVMEDIA_TYPE_AUDIO; });
+
+        if(foundStream == streams.end())
+            return false;
+
+        const AVCodecParameters* codecParameters = (*foundStream)->codecpar;
+
+        //yt-dlp names aac by its mp4 object type
+        const AVCodecDescriptor* codecDescriptor = avcodec_descriptor_get_by_name(formatHints.codec.starts_with("mp4a") ? "aac" : formatHints.codec.c_str());
+
+        if(!codecDescriptor || codecDescriptor->id != codecParameters->codec_id)
+            return false;
+        if(codecParameters->sample_rate <= 0 || (formatHints.sampleRate && formatHints.sampleRate != codecParameters->sample_rate))
+            return false;
+        if(codecParameters->ch_layout.nb_channels <= 0 || (formatHints.channelsCount && formatHints.channelsCount != codecParameters->ch_layout.nb_channels))
+            return false;
+
+        return true;
+    }
+    int Decoder::ReadFrame() const
+    {
+        if(m_OpenTimings.firstPacket)
+            return av_read_frame(m_FormatContext.get(), m_Packet.get());
+
+        const auto beginning = std::chrono::steady_clock::now();
+
+        const int result = av_read_frame(m_FormatContext.get(), m_Packet.get());
 
-        O_ASSERT(avfilter_graph_create_filter(&filterContext, filter, customName.empty() ? filterNameToFind.data() : customName.data(), args.data(), nullptr, m_FilterGraph.get()) >= 0, "Failed to create filter with ", filterNameToFind);
+        m_OpenTimings.firstPacket = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - beginning);
 
-        if(link)
-            O_ASSERT(!avfilter_link(link, 0, filterContext, 0), "Failed to link filter with ", filterNameToFind);
+        GE_LOG(Orchestra, Info, "Read the first packet in ", std::chrono::duration<float, std::milli>(*m_OpenTimings.firstPacket).count(), "ms.");
 
-        return filterContext;
+        return result;
     }
+
+    void Decoder::ResetSwrContext()
+    {
+        //some codecs(e.g. vorbis or flac) do not have a fixed frame size, so this one is a guess which is big enough for most of them
+        constexpr int MAX_VARIABLE_FRAME_SIZE = 8192;
+
+        m_SwrContext.reset();
+
+        m_SwrContext = FFmpegUniquePtrManager::UniquePtrSwrContext(swr_alloc(), FFmpegUniquePtrManager::FreeSwrContext);
+
+        av_opt_set_chlayout(m_SwrContext.get(), "in_chlayout", &m_CodecContext->ch_layout, 0);
+        av_opt_set_chlayout(m_SwrContext.get(), "out_chlayout", &m_CodecContext->ch_layout, 0);
+        av_opt_set_int(m_SwrContext.get(), "in_sample_rate", m_CodecContext->sample_rate, 0);
+        av_opt_set_int(m_SwrContext.get(), "out_sample_rate", m_OutSampleRate, 0);
+        av_opt_set_sample_fmt(m_SwrContext.get(), "in_sample_fmt", m_CodecContext->sample_fmt, 0);
+        av_opt_set_sample_fmt(m_SwrContext.get(), "out_sample_fmt", m_OutSampleFormat, 0);
+
+        O_ASSERT(swr_init(m_SwrContext.get()) >= 0, "Failed to initialize swrContext");
+
+        const int maxInSamples = m_CodecContext->frame_size > 0 ? m_CodecContext->frame_size : MAX_VARIABLE_FRAME_SIZE;
+
+        m_MaxOutBufferSize = av_samples_get_buffer_size(nullptr, m_CodecContext->ch_layout.nb_channels, swr_get_out_samples(m_SwrContext.get(), maxInSamples), m_OutSampleFormat, 1);
+
+        O_ASSERT(m_MaxOutBufferSize > 0, "Failed to calculate the max size of output buffer");
+    }
+
 }
\ No newline at end of file
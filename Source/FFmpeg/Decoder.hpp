@@ -1,9 +1,14 @@
 #pragma once
 
+#include <chrono>
+#include <filesystem>
 #include <map>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stop_token>
 #include <string>
 #include <string_view>
-#include <vector>
 
 extern "C"
 {
@@ -12,6 +17,9 @@ extern "C"
 }
 
 #include "FFmpegUniquePtrManager.hpp"
+#include "SharedSource.hpp"
+#include "SeekIndex.hpp"
+#include "AudioFormatHints.hpp"
 
 namespace Orchestra
 {
@@ -20,41 +28,64 @@ namespace Orchestra
     public:
         static constexpr int DEFAULT_SAMPLE_RATE = 48000;
         static constexpr AVSampleFormat DEFAULT_OUT_SAMPLE_FORMAT = AV_SAMPLE_FMT_S16;
+        //opening and probing a url which takes longer is aborted, a dead url would otherwise keep reconnecting for ages
+        static constexpr std::chrono::seconds OPEN_TIMEOUT{ 20 };
+
+        struct OpenTimings
+        {
+            //avformat_open_input, which also reads the header
+            std::chrono::microseconds open{ 0 };
+            //avformat_find_stream_info, 0 if it has been skipped
+            std::chrono::microseconds probe{ 0 };
+            //how long the first read of a packet took, nullopt till then
+            std::optional<std::chrono::microseconds> firstPacket;
+            //how long the first DecodeAudioFrame call took, nullopt till then
+            std::optional<std::chrono::microseconds> firstFrame;
+            bool hasSkippedProbing = false;
+        };
     public:
         Decoder();
-        Decoder(const std::string_view& url, int outSampleRate = DEFAULT_SAMPLE_RATE, AVSampleFormat outSampleFormat = DEFAULT_OUT_SAMPLE_FORMAT);
+        //remote urls are read through SharedSource if it is possible, so the same url is downloaded only once, then onDownloaded is called with the whole file.
+        //stopping the token aborts the opening right away, as well as any later read which waits for the network, then it throws or reading returns false.
+        //probing(avformat_find_stream_info) is skipped if what the header says matches formatHints
+        Decoder(const std::string_view& url, int outSampleRate = DEFAULT_SAMPLE_RATE, AVSampleFormat outSampleFormat = DEFAULT_OUT_SAMPLE_FORMAT, SharedSource::DownloadedCallback onDownloaded = {}, std::stop_token stopToken = {}, const AudioFormatHints& formatHints = {});
         ~Decoder() = default;
 
         Decoder(const Decoder& other);
         Decoder& operator=(const Decoder& other);
         Decoder(Decoder&& other) noexcept = default;
-        Decoder& operator=(Decoder&& other) noexcept = default;
+        //the format context is replaced before the reader it reads through
+        Decoder& operator=(Decoder&& other) noexcept;
 
-        std::vector<uint8_t> DecodeAudioFrame() const;
+        //decodes the current packet straight into out, returns the number of written bytes. out should be at least GetMaxOutBufferSize() bytes, otherwise the rest stays buffered in m_SwrContext until the next call
+        size_t DecodeAudioFrame(std::span<uint8_t> out) const;
 
         void SkipToTimestamp(int64_t timestamp) const;
         void SkipTimestamp(int64_t timestamp) const;
         void SkipToSeconds(float seconds) const;
         void SkipSeconds(float seconds) const;
 
-        void ResetGraph();
-
         uint32_t FindStreamIndex(AVMediaType mediaType) const;
 
         bool AreThereFramesToProcess() const;
+        //reads the next packet of the audio stream without decoding it, returns false at the end of the stream. The packet stays valid till the next call
+        bool ReadAudioPacket() const;
+
+        //whether the audio stream is opus with discord's sample rate and channels, so its packets can be sent as they are
+        bool CanPassthroughOpus() const;
 
         void Reset();
         bool IsReady() const;
+        //whether the audio is read from a SharedSource
+        bool IsShared() const noexcept;
+
+        //gives the demuxer the seek index from the file if there is one, SaveSeekIndex writes there what the demuxer has indexed since then. An empty path turns it off
+        void SetSeekIndexPath(std::filesystem::path path);
+        //returns whether the index was written, which is only if the demuxer has indexed more than there was in the file
+        bool SaveSeekIndex() const;
 
         //getters, setters
     public:
-        void SetBassBoost( float decibelsBoost = 0.f,  float frequencyToAdjust = 0.f, float bandwidth = 0.f) const;
-
-        void SetEqualizer(const std::string_view& args) const;
-        void SetEqualizer(const std::map<float, float>& frequencies) const;
-
-        void SetLimiter(float limit);
-
         int GetInitialSampleRate() const;
         AVSampleFormat GetInitialSampleFormat() const;
 
@@ -70,44 +101,70 @@ namespace Orchestra
         float GetTotalDurationSeconds() const;
 
         int GetMaxBufferSize() const;
+        //the max amount of bytes that a single DecodeAudioFrame call can write
+        int GetMaxOutBufferSize() const;
 
         int64_t GetCurrentTimestamp() const;
+        std::span<uint8_t> GetPacketData() const;
+        float GetPacketDurationSeconds() const;
         int GetBytesPerSample() const;
         int GetChannelsCount() const;
 
         double GetTimestampToSecondsRatio() const;
 
+        const OpenTimings& GetOpenTimings() const noexcept;
+        const std::filesystem::path& GetSeekIndexPath() const noexcept;
+
         //metadata
         std::string GetTitle() const;
     private:
+        //is pointed to by the format context's interrupt callback
+        struct InterruptState
+        {
+            std::stop_token stopToken;
+            //is max once the url has been opened
+            std::chrono::steady_clock::time_point deadline;
+        };
+
+    private:
+        static int InterruptCallback(void* opaque);
+
         static void CopySwrParams(SwrContext* from, SwrContext* to);
         static SwrContext* DuplicateSwrContext(SwrContext* from);
 
         AVStream* GetStream() const;
 
-        AVFilterContext* CreateFilterContext(const std::string_view& filterNameToFind, AVFilterContext* link = nullptr, const std::string_view& customName = "", const std::string_view& args = "") const;
+        //whether the header has given everything which probing would find and it is what the hints say
+        bool MatchesFormatHints(const AudioFormatHints& formatHints) const;
+        //av_read_frame, which also measures the first read
+        int ReadFrame() const;
+
+        void ResetSwrContext();
 
     private:
+        //are declared before m_FormatContext, so they are destroyed after it. Copies of a decoder share them, as they share the format context's io
+        std::shared_ptr<InterruptState> m_InterruptState;
+        std::shared_ptr<SharedSource::Reader> m_SharedSourceReader;
+        //a source which SharedSource has opened, but hasn't shared(e.g. a live stream), it is read right through its io. Its interrupt callback uses m_InterruptState
+        std::shared_ptr<SharedSource> m_UnsharedSource;
         FFmpegUniquePtrManager::UniquePtrAVFormatContext m_FormatContext;
         FFmpegUniquePtrManager::UniquePtrAVCodecContext m_CodecContext;
         FFmpegUniquePtrManager::UniquePtrSwrContext m_SwrContext;
         FFmpegUniquePtrManager::UniquePtrAVPacket m_Packet;
         FFmpegUniquePtrManager::UniquePtrAVFrame m_Frame;
 
-        FFmpegUniquePtrManager::UniquePtrAVFilterGraph m_FilterGraph;
-        struct
-        {
-            AVFilterContext* bufferSource;
-            AVFilterContext* bass;
-            AVFilterContext* equalizer;
-            AVFilterContext* limiter;
-            AVFilterContext* bufferSink;
-        } m_Filters { nullptr, nullptr, nullptr, nullptr, nullptr };
-
         int m_MaxBufferSize;
+        int m_MaxOutBufferSize;
 
         uint32_t m_AudioStreamIndex;
         AVSampleFormat m_OutSampleFormat;
         int m_OutSampleRate;
+
+        //the first packet is read by a const method
+        mutable OpenTimings m_OpenTimings;
+
+        std::filesystem::path m_SeekIndexPath;
+        //the entries of the stream's index right after SetSeekIndexPath, including the ones of the file itself(e.g. webm cues)
+        size_t m_InitialSeekIndexEntriesCount;
     };
 }
\ No newline at end of file
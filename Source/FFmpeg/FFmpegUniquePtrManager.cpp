@@ -27,4 +27,15 @@ namespace Orchestra
     {
         avfilter_graph_free(&filterGraph);
     }
+    void FFmpegUniquePtrManager::FreeAVIOContext(AVIOContext* ioContext)
+    {
+        avio_closep(&ioContext);
+    }
+    void FFmpegUniquePtrManager::FreeCustomAVIOContext(AVIOContext* ioContext)
+    {
+        if(ioContext)
+            av_freep(&ioContext->buffer);
+
+        avio_context_free(&ioContext);
+    }
 }
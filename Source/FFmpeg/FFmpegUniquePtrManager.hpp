@@ -30,6 +30,7 @@ namespace Orchestra
         using UniquePtrAVFrame = std::unique_ptr<AVFrame, void(*)(AVFrame*)>;
         using UniquePtrAVFilter = std::unique_ptr<AVFilter, void(*)(AVFilter*)>;
         using UniquePtrAVFilterGraph = std::unique_ptr<AVFilterGraph, void(*)(AVFilterGraph*)>;
+        using UniquePtrAVIOContext = std::unique_ptr<AVIOContext, void(*)(AVIOContext*)>;
 
         static void FreeFormatContext(AVFormatContext* formatContext);
         static void FreeAVCodecContext(AVCodecContext* codecContext);
@@ -37,5 +38,9 @@ namespace Orchestra
         static void FreeAVPacket(AVPacket* packet);
         static void FreeAVFrame(AVFrame* frame);
         static void FreeAVFilterGraph(AVFilterGraph* filterGraph);
+        //for the ones opened with avio_open2
+        static void FreeAVIOContext(AVIOContext* ioContext);
+        //for the ones allocated with avio_alloc_context, also frees their buffer
+        static void FreeCustomAVIOContext(AVIOContext* ioContext);
     };
 }
\ No newline at end of file
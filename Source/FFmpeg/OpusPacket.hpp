@@ -0,0 +1,48 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+
+namespace Orchestra
+{
+    //the duration of an opus packet from its TOC byte(RFC 6716), 0 if it is malformed
+    inline float GetOpusPacketSeconds(std::span<const uint8_t> packet)
+    {
+        if(packet.empty())
+            return 0.f;
+
+        const uint8_t config = packet[0] >> 3;
+
+        float frameSeconds;
+
+        //SILK, hybrid and CELT modes
+        if(config < 12)
+            frameSeconds = std::array{ .01f, .02f, .04f, .06f }[config & 3];
+        else if(config < 16)
+            frameSeconds = (config & 1) ? .02f : .01f;
+        else
+            frameSeconds = std::array{ .0025f, .005f, .01f, .02f }[config & 3];
+
+        int framesCount;
+
+        switch(packet[0] & 3)
+        {
+        case 0:
+            framesCount = 1;
+            break;
+        case 1:
+        case 2:
+            framesCount = 2;
+            break;
+        default:
+            if(packet.size() < 2)
+                return 0.f;
+
+            framesCount = packet[1] & 0x3F;
+            break;
+        }
+
+        return frameSeconds * static_cast<float>(framesCount);
+    }
+}
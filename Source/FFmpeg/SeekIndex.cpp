@@ -0,0 +1,130 @@
+#include "SeekIndex.hpp"
+
+#include <fstream>
+#include <system_error>
+
+extern "C"
+{
+#include <libavformat/avformat.h>
+}
+
+#include "../Utils.hpp"
+
+//private
+namespace Orchestra
+{
+    namespace
+    {
+        struct SeekIndexFileHeader
+        {
+            uint32_t magic;
+            uint32_t version;
+            int32_t timeBaseNumerator;
+            int32_t timeBaseDenominator;
+            uint64_t entriesCount;
+        };
+
+        //an hour of audio with an entry per 20ms opus packet is about 180000, so anything bigger is a broken file
+        constexpr uint64_t MAX_ENTRIES_COUNT = 1ull << 24;
+    }
+}
+namespace Orchestra
+{
+    SeekIndex SeekIndex::FromStream(AVStream* stream)
+    {
+        SeekIndex seekIndex;
+        seekIndex.m_TimeBase = stream->time_base;
+
+        const int entriesCount = avformat_index_get_entries_count(stream);
+        seekIndex.m_Entries.reserve(static_cast<size_t>(entriesCount));
+
+        for(int i = 0; i < entriesCount; i++)
+            if(const AVIndexEntry* entry = avformat_index_get_entry(stream, i); entry && (entry->flags & AVINDEX_KEYFRAME))
+                seekIndex.m_Entries.emplace_back(entry->pos, entry->timestamp);
+
+        return seekIndex;
+    }
+    SeekIndex SeekIndex::Load(const std::filesystem::path& path)
+    {
+        std::ifstream file{ path, std::ios::binary };
+
+        if(!file)
+            return {};
+
+        SeekIndexFileHeader header{};
+
+        if(!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+            return {};
+
+        if(header.magic != FILE_MAGIC || header.version != FILE_VERSION || header.timeBaseDenominator <= 0 || header.entriesCount > MAX_ENTRIES_COUNT)
+            return {};
+
+        SeekIndex seekIndex;
+        seekIndex.m_TimeBase = { header.timeBaseNumerator, header.timeBaseDenominator };
+        seekIndex.m_Entries.resize(static_cast<size_t>(header.entriesCount));
+
+        if(!file.read(reinterpret_cast<char*>(seekIndex.m_Entries.data()), static_cast<std::streamsize>(seekIndex.m_Entries.size() * sizeof(Entry))))
+            return {};
+
+        return seekIndex;
+    }
+
+    void SeekIndex::Save(const std::filesystem::path& path) const
+    {
+        std::filesystem::path temporaryPath = path;
+        temporaryPath += ".tmp";
+
+        {
+            std::ofstream file{ temporaryPath, std::ios::binary | std::ios::trunc };
+
+            const SeekIndexFileHeader header{ FILE_MAGIC, FILE_VERSION, m_TimeBase.num, m_TimeBase.den, m_Entries.size() };
+
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(m_Entries.data()), static_cast<std::streamsize>(m_Entries.size() * sizeof(Entry)));
+
+            if(!file)
+            {
+                file.close();
+
+                std::error_code error;
+                std::filesystem::remove(temporaryPath, error);
+
+                O_THROW("Failed to write the seek index ", path.string());
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(temporaryPath, path, error);
+
+        if(error)
+        {
+            std::filesystem::remove(temporaryPath, error);
+
+            O_THROW("Failed to move the seek index to ", path.string());
+        }
+    }
+    void SeekIndex::ApplyTo(AVStream* stream) const
+    {
+        if(av_cmp_q(stream->time_base, m_TimeBase) != 0)
+            return;
+
+        for(const Entry& entry : m_Entries)
+            av_add_index_entry(stream, entry.position, entry.timestamp, 0, 0, AVINDEX_KEYFRAME);
+    }
+}
+//getters, setters
+namespace Orchestra
+{
+    const std::vector<SeekIndex::Entry>& SeekIndex::GetEntries() const noexcept
+    {
+        return m_Entries;
+    }
+    size_t SeekIndex::GetEntriesCount() const noexcept
+    {
+        return m_Entries.size();
+    }
+    bool SeekIndex::IsEmpty() const noexcept
+    {
+        return m_Entries.empty();
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <filesystem>
+#include <vector>
+#include <cstdint>
+
+extern "C"
+{
+#include <libavutil/rational.h>
+}
+
+struct AVStream;
+
+namespace Orchestra
+{
+    //the keyframe entries which a demuxer collects in its stream's index while reading, so they can be kept in a file next to a track and given back to the demuxer when the track is opened again.
+    //without it a demuxer of a file without an index of its own(e.g. webm without cues) has to read everything before the seeked position, with it avformat_seek_file jumps right to it
+    class SeekIndex
+    {
+    public:
+        struct Entry
+        {
+            //in bytes from the beginning of the file
+            int64_t position;
+            //in the stream's time base
+            int64_t timestamp;
+        };
+
+    public:
+        SeekIndex() = default;
+
+        //copies the keyframe entries of the stream's index
+        static SeekIndex FromStream(AVStream* stream);
+        //returns an empty index if there is no file or it is broken
+        static SeekIndex Load(const std::filesystem::path& path);
+
+        //writes to a temporary file first, so a half written one is never loaded
+        void Save(const std::filesystem::path& path) const;
+        //adds the entries to the stream's index, does nothing if the stream's time base differs from the one the entries were made with
+        void ApplyTo(AVStream* stream) const;
+
+    public:
+        const std::vector<Entry>& GetEntries() const noexcept;
+        size_t GetEntriesCount() const noexcept;
+        bool IsEmpty() const noexcept;
+
+    public:
+        static constexpr uint32_t FILE_MAGIC = 0x5849534F;//"OSIX"
+        static constexpr uint32_t FILE_VERSION = 1;
+
+    private:
+        AVRational m_TimeBase{ 0, 1 };
+        //sorted by timestamp, as the stream's index is
+        std::vector<Entry> m_Entries;
+    };
+}
@@ -0,0 +1,395 @@
+#define NOMINMAX
+#include "SharedSource.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+#include <GuelderConsoleLog.hpp>
+
+extern "C"
+{
+#include <libavformat/avio.h>
+#include <libavutil/mem.h>
+}
+
+#include "../Utils.hpp"
+
+//private
+namespace Orchestra
+{
+    namespace
+    {
+        struct SharedSourceEntry
+        {
+            std::shared_ptr<SharedSource> source;
+            std::chrono::steady_clock::time_point lastAcquired;
+        };
+
+        //the key is a raw url, the same webpage url gets the same raw url from RawURLCache, so it is shared as well
+        std::unordered_map<std::string, SharedSourceEntry> s_Sources;
+        std::mutex s_Mutex;
+
+        std::atomic_size_t s_MaxSize = 0;
+
+        uint64_t s_Hits = 0;
+        uint64_t s_Misses = 0;
+        uint64_t s_SavedBytes = 0;
+
+        bool IsRemoteURL(const std::string_view& url)
+        {
+            return url.starts_with("http://") || url.starts_with("https://");
+        }
+    }
+}
+//SharedSource
+namespace Orchestra
+{
+    SharedSource::SharedSource(const std::string_view& url, AVIOInterruptCB interruptCallback)
+        : m_URL(url), m_IOContext(nullptr, FFmpegUniquePtrManager::FreeAVIOContext), m_IsShared(false), m_Size(0), m_DownloadedSize(0), m_HasFinished(false), m_HasFailed(false), m_IsCancelled(false),
+        m_InterruptCallback(interruptCallback)
+    {
+        //the same as Decoder's, as an unshared source is read by it
+        AVDictionary* options = nullptr;
+        av_dict_set(&options, "reconnect", "1", 0);
+        av_dict_set(&options, "reconnect_streamed", "1", 0);
+        av_dict_set(&options, "reconnect_delay_max", "4294", 0);
+        av_dict_set(&options, "reconnect_max_retries", "9999", 0);
+        av_dict_set(&options, "reconnect_on_network_error", "1", 0);
+        av_dict_set(&options, "reconnect_on_http_error", "1", 0);
+        av_dict_set(&options, "timeout", "2000000000", 0);
+
+        const AVIOInterruptCB ownInterruptCallback{ InterruptCallback, this };
+
+        AVIOContext* ioContext = nullptr;
+
+        const int result = avio_open2(&ioContext, m_URL.c_str(), AVIO_FLAG_READ, &ownInterruptCallback, &options);
+
+        av_dict_free(&options);
+
+        O_ASSERT(result >= 0, "Failed to open url to share: ", m_URL);
+
+        m_IOContext.reset(ioContext);
+
+        const int64_t size = avio_size(ioContext);
+
+        m_Size = size > 0 ? static_cast<size_t>(size) : 0;
+    }
+    SharedSource::~SharedSource()
+    {
+        m_IsCancelled = true;
+
+        if(m_DownloadThread.joinable())
+        {
+            m_DownloadThread.request_stop();
+            m_DownloadThread.join();
+        }
+    }
+
+    std::shared_ptr<SharedSource> SharedSource::Acquire(const std::string_view& url, DownloadedCallback onDownloaded, AVIOInterruptCB interruptCallback)
+    {
+        const size_t maxSize = s_MaxSize;
+
+        if(!maxSize || !IsRemoteURL(url))
+            return nullptr;
+
+        const std::string key{ url };
+
+        {
+            std::lock_guard lock{ s_Mutex };
+
+            EraseUnusedSources();
+
+            if(const auto found = s_Sources.find(key); found != s_Sources.end())
+            {
+                found->second.lastAcquired = std::chrono::steady_clock::now();
+
+                s_Hits++;
+                s_SavedBytes += found->second.source->GetSize();
+
+                GE_LOG(Orchestra, Info, "Sharing already downloading audio of ", found->second.source->GetSize(), " bytes. Shared sources hits: ", s_Hits, ", misses: ", s_Misses, ", saved bytes: ", s_SavedBytes, '.');
+
+                return found->second.source;
+            }
+        }
+
+        //is opened without the lock, as it can take a while
+        std::shared_ptr<SharedSource> source;
+
+        try
+        {
+            source = std::make_shared<SharedSource>(url, interruptCallback);
+        }
+        catch(const OrchestraException& e)
+        {
+            GE_LOG(Orchestra, Warning, "Failed to open a shared source: ", e.GetFullMessage());
+            return nullptr;
+        }
+
+        //it is already opened, so it is read by the caller alone, not opened again
+        if(!source->GetSize() || source->GetSize() > maxSize)
+            return source;
+
+        std::lock_guard lock{ s_Mutex };
+
+        //another guild could have opened the same url in the meantime
+        auto [it, hasInserted] = s_Sources.try_emplace(key, SharedSourceEntry{ source, std::chrono::steady_clock::now() });
+
+        if(hasInserted)
+        {
+            s_Misses++;
+
+            //the download mustn't be aborted by the guild which has opened it
+            source->m_InterruptCallback = {};
+            source->m_IsShared = true;
+            source->StartDownloading(std::move(onDownloaded));
+        }
+        else
+        {
+            it->second.lastAcquired = std::chrono::steady_clock::now();
+
+            s_Hits++;
+            s_SavedBytes += it->second.source->GetSize();
+        }
+
+        return it->second.source;
+    }
+
+    size_t SharedSource::Read(size_t position, std::span<uint8_t> out, std::stop_token stopToken) const
+    {
+        if(position >= m_Size || out.empty())
+            return 0;
+
+        size_t downloadedSize = m_DownloadedSize.load(std::memory_order_acquire);
+
+        if(downloadedSize <= position)
+        {
+            std::unique_lock lock{ m_ProgressMutex };
+
+            m_ProgressCondition.wait(lock, stopToken, [&] { return m_DownloadedSize.load(std::memory_order_acquire) > position || m_HasFinished; });
+
+            downloadedSize = m_DownloadedSize.load(std::memory_order_acquire);
+
+            if(downloadedSize <= position)
+                return 0;
+        }
+
+        const size_t size = std::min(out.size(), downloadedSize - position);
+
+        std::memcpy(out.data(), m_Data.get() + position, size);
+
+        return size;
+    }
+
+    void SharedSource::StartDownloading(DownloadedCallback onDownloaded)
+    {
+        m_OnDownloaded = std::move(onDownloaded);
+        m_Data = std::make_unique_for_overwrite<uint8_t[]>(m_Size);
+        m_DownloadThread = std::jthread{ [this](std::stop_token stopToken) { Download(std::move(stopToken)); } };
+    }
+    void SharedSource::Download(std::stop_token stopToken)
+    {
+        size_t downloadedSize = 0;
+
+        while(downloadedSize < m_Size && !stopToken.stop_requested())
+        {
+            const int chunkSize = static_cast<int>(std::min(DOWNLOAD_CHUNK_SIZE, m_Size - downloadedSize));
+            const int readSize = avio_read(m_IOContext.get(), m_Data.get() + downloadedSize, chunkSize);
+
+            if(readSize <= 0)
+                break;
+
+            downloadedSize += static_cast<size_t>(readSize);
+
+            {
+                std::lock_guard lock{ m_ProgressMutex };
+                m_DownloadedSize.store(downloadedSize, std::memory_order_release);
+            }
+
+            m_ProgressCondition.notify_all();
+        }
+
+        if(downloadedSize < m_Size)
+        {
+            m_HasFailed = true;
+
+            if(!stopToken.stop_requested())
+                GE_LOG(Orchestra, Warning, "Failed to download shared source after ", downloadedSize, " bytes out of ", m_Size, '.');
+        }
+
+        //the connection isn't needed anymore
+        m_IOContext.reset();
+
+        {
+            std::lock_guard lock{ m_ProgressMutex };
+            m_HasFinished = true;
+        }
+
+        m_ProgressCondition.notify_all();
+
+        if(m_HasFailed || !m_OnDownloaded)
+            return;
+
+        try
+        {
+            m_OnDownloaded({ m_Data.get(), m_Size });
+        }
+        catch(const OrchestraException& e)
+        {
+            GE_LOG(Orchestra, Warning, "Failed to handle the downloaded shared source: ", e.GetFullMessage());
+        }
+        catch(const std::exception& e)
+        {
+            GE_LOG(Orchestra, Warning, "Failed to handle the downloaded shared source: ", e.what());
+        }
+    }
+
+    int SharedSource::InterruptCallback(void* opaque)
+    {
+        const SharedSource& source = *static_cast<const SharedSource*>(opaque);
+
+        if(source.m_IsCancelled)
+            return 1;
+
+        return source.m_InterruptCallback.callback ? source.m_InterruptCallback.callback(source.m_InterruptCallback.opaque) : 0;
+    }
+    void SharedSource::EraseUnusedSources()
+    {
+        const auto now = std::chrono::steady_clock::now();
+
+        std::erase_if(s_Sources, [&now](const auto& pair)
+            {
+                const SharedSourceEntry& entry = pair.second;
+
+                if(entry.source.use_count() > 1)
+                    return entry.source->HasFailed();
+
+                return entry.source->HasFailed() || now - entry.lastAcquired > RETENTION;
+            });
+    }
+}
+//Reader
+namespace Orchestra
+{
+    SharedSource::Reader::Reader(std::shared_ptr<SharedSource> source, std::stop_token stopToken)
+        : m_Source(std::move(source)), m_StopToken(std::move(stopToken)), m_Position(0), m_IOContext(nullptr, FFmpegUniquePtrManager::FreeCustomAVIOContext)
+    {
+        O_ASSERT(m_Source, "The shared source is null");
+
+        uint8_t* buffer = static_cast<uint8_t*>(av_malloc(IO_BUFFER_SIZE));
+        O_ASSERT(buffer, "Failed to allocate a buffer for the shared source reader");
+
+        m_IOContext.reset(avio_alloc_context(buffer, IO_BUFFER_SIZE, 0, this, ReadPacket, nullptr, Seek));
+
+        if(!m_IOContext)
+        {
+            av_free(buffer);
+            O_THROW("Failed to allocate an io context for the shared source reader");
+        }
+    }
+
+    int SharedSource::Reader::ReadPacket(void* opaque, uint8_t* buffer, int bufferSize)
+    {
+        Reader& reader = *static_cast<Reader*>(opaque);
+
+        const size_t readSize = reader.m_Source->Read(reader.m_Position, { buffer, static_cast<size_t>(bufferSize) }, reader.m_StopToken);
+
+        if(!readSize)
+        {
+            if(reader.m_StopToken.stop_requested())
+                return AVERROR_EXIT;
+
+            return reader.m_Position < reader.m_Source->GetSize() ? AVERROR(EIO) : AVERROR_EOF;
+        }
+
+        reader.m_Position += readSize;
+
+        return static_cast<int>(readSize);
+    }
+    //seeking ahead of the download is fine, the next read just waits for it
+    int64_t SharedSource::Reader::Seek(void* opaque, int64_t offset, int whence)
+    {
+        Reader& reader = *static_cast<Reader*>(opaque);
+
+        const int64_t size = static_cast<int64_t>(reader.m_Source->GetSize());
+
+        int64_t position;
+
+        switch(whence & ~AVSEEK_FORCE)
+        {
+        case AVSEEK_SIZE:
+            return size;
+        case SEEK_SET:
+            position = offset;
+            break;
+        case SEEK_CUR:
+            position = static_cast<int64_t>(reader.m_Position) + offset;
+            break;
+        case SEEK_END:
+            position = size + offset;
+            break;
+        default:
+            return AVERROR(EINVAL);
+        }
+
+        if(position < 0 || position > size)
+            return AVERROR(EINVAL);
+
+        reader.m_Position = static_cast<size_t>(position);
+
+        return position;
+    }
+}
+//getters, setters
+namespace Orchestra
+{
+    void SharedSource::SetMaxSize(size_t size) noexcept
+    {
+        s_MaxSize = size;
+    }
+    size_t SharedSource::GetMaxSize() noexcept
+    {
+        return s_MaxSize;
+    }
+
+    SharedSource::Stats SharedSource::GetStats()
+    {
+        std::lock_guard lock{ s_Mutex };
+
+        return { s_Hits, s_Misses, s_SavedBytes, s_Sources.size() };
+    }
+
+    const std::string& SharedSource::GetURL() const noexcept
+    {
+        return m_URL;
+    }
+    bool SharedSource::IsShared() const noexcept
+    {
+        return m_IsShared;
+    }
+    AVIOContext* SharedSource::GetIOContext() const noexcept
+    {
+        return m_IsShared ? nullptr : m_IOContext.get();
+    }
+    size_t SharedSource::GetSize() const noexcept
+    {
+        return m_Size;
+    }
+    size_t SharedSource::GetDownloadedSize() const noexcept
+    {
+        return m_DownloadedSize;
+    }
+    bool SharedSource::HasFailed() const noexcept
+    {
+        return m_HasFailed;
+    }
+
+    AVIOContext* SharedSource::Reader::GetIOContext() const noexcept
+    {
+        return m_IOContext.get();
+    }
+    const SharedSource& SharedSource::Reader::GetSource() const noexcept
+    {
+        return *m_Source;
+    }
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <cstdint>
+
+#include "FFmpegUniquePtrManager.hpp"
+
+namespace Orchestra
+{
+    //process-wide store of remote audio, so guilds which play the same raw url at the same time download it only once.
+    //the whole file is downloaded on its own thread into memory, every decoder reads it through its own Reader, so demuxing, decoding and filters stay per guild
+    class SharedSource
+    {
+    public:
+        struct Stats
+        {
+            //Acquire calls which got an already downloading or downloaded source
+            uint64_t hits;
+            uint64_t misses;
+            //the bytes which hits didn't have to download
+            uint64_t savedBytes;
+            size_t size;
+        };
+        //is called on the downloading thread once the whole file has been downloaded
+        using DownloadedCallback = std::function<void(std::span<const uint8_t> data)>;
+
+        //a position in the source, which is used as AVIOContext of a format context
+        class Reader
+        {
+        public:
+            static constexpr int IO_BUFFER_SIZE = 32768;
+
+        public:
+            //stopping the token makes the reads which wait for the download fail right away
+            Reader(std::shared_ptr<SharedSource> source, std::stop_token stopToken = {});
+            ~Reader() = default;
+
+            Reader(const Reader&) = delete;
+            Reader(Reader&&) = delete;
+            Reader& operator=(const Reader&) = delete;
+            Reader& operator=(Reader&&) = delete;
+
+        public:
+            AVIOContext* GetIOContext() const noexcept;
+            const SharedSource& GetSource() const noexcept;
+
+        private:
+            static int ReadPacket(void* opaque, uint8_t* buffer, int bufferSize);
+            static int64_t Seek(void* opaque, int64_t offset, int whence);
+
+        private:
+            std::shared_ptr<SharedSource> m_Source;
+            std::stop_token m_StopToken;
+            size_t m_Position;
+            FFmpegUniquePtrManager::UniquePtrAVIOContext m_IOContext;
+        };
+
+    public:
+        //released sources are kept for a while, so a guild which starts the same track a bit later gets it without downloading
+        static constexpr std::chrono::seconds RETENTION{ 120 };
+        //how much is downloaded at once, readers are woken up after every chunk
+        static constexpr size_t DOWNLOAD_CHUNK_SIZE = 65536;
+
+    public:
+        //opens the url, but doesn't start downloading. The opening is aborted when interruptCallback returns non zero, so are the reads of an unshared source
+        SharedSource(const std::string_view& url, AVIOInterruptCB interruptCallback = {});
+        ~SharedSource();
+
+        SharedSource(const SharedSource&) = delete;
+        SharedSource(SharedSource&&) = delete;
+        SharedSource& operator=(const SharedSource&) = delete;
+        SharedSource& operator=(SharedSource&&) = delete;
+
+        //returns nullptr if sharing is off, the url isn't a remote one or can't be opened, so it has to be opened as usual.
+        //if its size is unknown(e.g. a live stream) or is bigger than GetMaxSize, the source isn't shared and the caller reads its GetIOContext directly instead of opening the url again.
+        //onDownloaded is used only if the source is downloaded by this call, interruptCallback aborts only the opening of a shared source, not the download, which can be shared by other guilds
+        static std::shared_ptr<SharedSource> Acquire(const std::string_view& url, DownloadedCallback onDownloaded = {}, AVIOInterruptCB interruptCallback = {});
+
+        //blocks until there is something to read at position, the download has ended or the token is stopped, returns the number of read bytes, 0 means the end, a failed download or the stop
+        size_t Read(size_t position, std::span<uint8_t> out, std::stop_token stopToken = {}) const;
+
+    public:
+        //0 turns sharing off
+        static void SetMaxSize(size_t size) noexcept;
+        static size_t GetMaxSize() noexcept;
+
+        static Stats GetStats();
+
+        const std::string& GetURL() const noexcept;
+        bool IsShared() const noexcept;
+        //the opened url of an unshared source, nullptr for a shared one, as it is read by the download
+        AVIOContext* GetIOContext() const noexcept;
+        size_t GetSize() const noexcept;
+        size_t GetDownloadedSize() const noexcept;
+        bool HasFailed() const noexcept;
+
+    private:
+        void StartDownloading(DownloadedCallback onDownloaded);
+        void Download(std::stop_token stopToken);
+
+        static int InterruptCallback(void* opaque);
+        //drops the sources which nobody reads and which haven't been acquired for RETENTION, or which have failed
+        static void EraseUnusedSources();
+
+    private:
+        std::string m_URL;
+        FFmpegUniquePtrManager::UniquePtrAVIOContext m_IOContext;
+        bool m_IsShared;
+
+        std::unique_ptr<uint8_t[]> m_Data;
+        size_t m_Size;
+        //the bytes before it are never written again, so they are read without locking
+        std::atomic_size_t m_DownloadedSize;
+        std::atomic_bool m_HasFinished;
+        std::atomic_bool m_HasFailed;
+        std::atomic_bool m_IsCancelled;
+        DownloadedCallback m_OnDownloaded;
+
+        //is used by InterruptCallback while the url is being opened and for the whole life of an unshared source
+        AVIOInterruptCB m_InterruptCallback;
+
+        mutable std::mutex m_ProgressMutex;
+        //is _any, so readers can wait on a stop token
+        mutable std::condition_variable_any m_ProgressCondition;
+
+        //is the last one, so it is joined before the rest is destroyed
+        std::jthread m_DownloadThread;
+    };
+}
@@ -105,6 +105,21 @@ namespace Orchestra
         else
             return std::unique_ptr<T, D>(nullptr, other.get_deleter());
     }
+    //calls the function when it goes out of scope, also when an exception is thrown
+    template<typename FunctionType>
+    class ScopeGuard
+    {
+    public:
+        ScopeGuard(FunctionType function)
+            : m_Function(std::move(function)) {}
+        ~ScopeGuard() { m_Function(); }
+
+        ScopeGuard(const ScopeGuard&) = delete;
+        ScopeGuard& operator=(const ScopeGuard&) = delete;
+
+    private:
+        FunctionType m_Function;
+    };
     inline bool IsValidURL(const std::string& url)
     {
         // Regular expression to match basic URL structure
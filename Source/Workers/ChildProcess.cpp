@@ -0,0 +1,318 @@
+#include "ChildProcess.hpp"
+
+#include <string>
+#include <string_view>
+#include <utility>
+
+#ifdef WIN32
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <csignal>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "../Utils.hpp"
+
+namespace Orchestra
+{
+#ifdef WIN32
+    ChildProcess::ChildProcess(const std::string_view& command)
+    {
+        SECURITY_ATTRIBUTES securityAttributes{ sizeof(SECURITY_ATTRIBUTES), nullptr, TRUE };
+
+        HANDLE childStdinRead;
+        HANDLE childStdoutWrite;
+
+        O_ASSERT(CreatePipe(&childStdinRead, &m_WritePipe, &securityAttributes, 0), "Failed to create stdin pipe for ", command);
+        O_ASSERT(CreatePipe(&m_ReadPipe, &childStdoutWrite, &securityAttributes, 0), "Failed to create stdout pipe for ", command);
+
+        //only the child's ends must be inherited
+        SetHandleInformation(m_WritePipe, HANDLE_FLAG_INHERIT, 0);
+        SetHandleInformation(m_ReadPipe, HANDLE_FLAG_INHERIT, 0);
+
+        STARTUPINFOA startupInfo{};
+        startupInfo.cb = sizeof(STARTUPINFOA);
+        startupInfo.dwFlags = STARTF_USESTDHANDLES;
+        startupInfo.hStdInput = childStdinRead;
+        startupInfo.hStdOutput = childStdoutWrite;
+        startupInfo.hStdError = GetStdHandle(STD_ERROR_HANDLE);
+
+        PROCESS_INFORMATION processInformation{};
+
+        //not through cmd, otherwise TerminateProcess would kill only cmd
+        std::string commandLine{ command };
+
+        const bool isCreated = CreateProcessA(nullptr, commandLine.data(), nullptr, nullptr, TRUE, CREATE_NO_WINDOW, nullptr, nullptr, &startupInfo, &processInformation);
+
+        CloseHandle(childStdinRead);
+        CloseHandle(childStdoutWrite);
+
+        if(!isCreated)
+        {
+            Close();
+            O_THROW("Failed to launch ", command);
+        }
+
+        CloseHandle(processInformation.hThread);
+        m_ProcessHandle = processInformation.hProcess;
+    }
+
+    bool ChildProcess::WriteLine(const std::string_view& line)
+    {
+        std::string data{ line };
+        data += '\n';
+
+        size_t written = 0;
+
+        while(written < data.size())
+        {
+            DWORD writtenNow = 0;
+
+            if(!WriteFile(m_WritePipe, data.data() + written, static_cast<DWORD>(data.size() - written), &writtenNow, nullptr))
+                return false;
+
+            written += writtenNow;
+        }
+
+        return true;
+    }
+    std::optional<std::string> ChildProcess::ReadLine()
+    {
+        char chunk[65536];
+
+        size_t searchFrom = 0;
+
+        while(true)
+        {
+            const size_t lineEnd = m_ReadBuffer.find('\n', searchFrom);
+
+            if(lineEnd != std::string::npos)
+            {
+                std::string line = m_ReadBuffer.substr(0, lineEnd);
+                m_ReadBuffer.erase(0, lineEnd + 1);
+
+                if(!line.empty() && line.back() == '\r')
+                    line.pop_back();
+
+                return line;
+            }
+
+            searchFrom = m_ReadBuffer.size();
+
+            DWORD read = 0;
+
+            if(!ReadFile(m_ReadPipe, chunk, sizeof(chunk), &read, nullptr) || read == 0)
+                return std::nullopt;
+
+            m_ReadBuffer.append(chunk, read);
+        }
+    }
+
+    void ChildProcess::Terminate()
+    {
+        if(m_ProcessHandle)
+            TerminateProcess(m_ProcessHandle, 1);
+    }
+
+    void ChildProcess::Close()
+    {
+        if(m_WritePipe)
+            CloseHandle(m_WritePipe);
+        if(m_ReadPipe)
+            CloseHandle(m_ReadPipe);
+
+        if(m_ProcessHandle)
+        {
+            TerminateProcess(m_ProcessHandle, 1);
+            WaitForSingleObject(m_ProcessHandle, INFINITE);
+            CloseHandle(m_ProcessHandle);
+        }
+
+        m_ProcessHandle = nullptr;
+        m_WritePipe = nullptr;
+        m_ReadPipe = nullptr;
+    }
+
+    bool ChildProcess::IsLaunched() const noexcept { return m_ProcessHandle; }
+#else
+    namespace
+    {
+        //close-on-exec, so other children(e.g. the other workers) don't inherit the pipe and keep it open after this process has died
+        bool CreatePipe(int (&pipeEnds)[2])
+        {
+#ifdef __linux__
+            return pipe2(pipeEnds, O_CLOEXEC) == 0;
+#else
+            if(pipe(pipeEnds) != 0)
+                return false;
+
+            fcntl(pipeEnds[0], F_SETFD, FD_CLOEXEC);
+            fcntl(pipeEnds[1], F_SETFD, FD_CLOEXEC);
+
+            return true;
+#endif
+        }
+    }
+
+    ChildProcess::ChildProcess(const std::string_view& command)
+    {
+        //a write to a dead worker must fail, not kill the bot
+        std::signal(SIGPIPE, SIG_IGN);
+
+        int stdinPipe[2];
+        int stdoutPipe[2];
+
+        O_ASSERT(CreatePipe(stdinPipe), "Failed to create stdin pipe for ", command);
+
+        if(!CreatePipe(stdoutPipe))
+        {
+            close(stdinPipe[0]);
+            close(stdinPipe[1]);
+            O_THROW("Failed to create stdout pipe for ", command);
+        }
+
+        //exec, so the shell is replaced and Terminate kills the command itself
+        const std::string commandLine = GuelderConsoleLog::Logger::Format("exec ", command);
+
+        m_ProcessID = fork();
+
+        if(m_ProcessID == 0)
+        {
+            //the duplicates are not close-on-exec
+            dup2(stdinPipe[0], STDIN_FILENO);
+            dup2(stdoutPipe[1], STDOUT_FILENO);
+
+            close(stdinPipe[0]);
+            close(stdinPipe[1]);
+            close(stdoutPipe[0]);
+            close(stdoutPipe[1]);
+
+            execl("/bin/sh", "sh", "-c", commandLine.c_str(), nullptr);
+            _exit(127);
+        }
+
+        close(stdinPipe[0]);
+        close(stdoutPipe[1]);
+
+        m_WritePipe = stdinPipe[1];
+        m_ReadPipe = stdoutPipe[0];
+
+        if(m_ProcessID < 0)
+        {
+            Close();
+            O_THROW("Failed to launch ", command);
+        }
+    }
+
+    bool ChildProcess::WriteLine(const std::string_view& line)
+    {
+        std::string data{ line };
+        data += '\n';
+
+        size_t written = 0;
+
+        while(written < data.size())
+        {
+            const ssize_t writtenNow = write(m_WritePipe, data.data() + written, data.size() - written);
+
+            if(writtenNow <= 0)
+                return false;
+
+            written += writtenNow;
+        }
+
+        return true;
+    }
+    std::optional<std::string> ChildProcess::ReadLine()
+    {
+        char chunk[65536];
+
+        size_t searchFrom = 0;
+
+        while(true)
+        {
+            const size_t lineEnd = m_ReadBuffer.find('\n', searchFrom);
+
+            if(lineEnd != std::string::npos)
+            {
+                std::string line = m_ReadBuffer.substr(0, lineEnd);
+                m_ReadBuffer.erase(0, lineEnd + 1);
+
+                return line;
+            }
+
+            searchFrom = m_ReadBuffer.size();
+
+            const ssize_t readNow = read(m_ReadPipe, chunk, sizeof(chunk));
+
+            if(readNow <= 0)
+                return std::nullopt;
+
+            m_ReadBuffer.append(chunk, readNow);
+        }
+    }
+
+    void ChildProcess::Terminate()
+    {
+        if(m_ProcessID > 0)
+            kill(m_ProcessID, SIGKILL);
+    }
+
+    void ChildProcess::Close()
+    {
+        if(m_WritePipe >= 0)
+            close(m_WritePipe);
+        if(m_ReadPipe >= 0)
+            close(m_ReadPipe);
+
+        if(m_ProcessID > 0)
+        {
+            kill(m_ProcessID, SIGKILL);
+            waitpid(m_ProcessID, nullptr, 0);
+        }
+
+        m_ProcessID = -1;
+        m_WritePipe = -1;
+        m_ReadPipe = -1;
+    }
+
+    bool ChildProcess::IsLaunched() const noexcept { return m_ProcessID > 0; }
+#endif
+
+    ChildProcess::~ChildProcess()
+    {
+        Close();
+    }
+
+    ChildProcess::ChildProcess(ChildProcess&& other) noexcept
+    {
+        MoveFrom(std::move(other));
+    }
+    ChildProcess& ChildProcess::operator=(ChildProcess&& other) noexcept
+    {
+        if(this != &other)
+        {
+            Close();
+            MoveFrom(std::move(other));
+        }
+
+        return *this;
+    }
+
+    void ChildProcess::MoveFrom(ChildProcess&& other) noexcept
+    {
+        m_ReadBuffer = std::move(other.m_ReadBuffer);
+#ifdef WIN32
+        m_ProcessHandle = std::exchange(other.m_ProcessHandle, nullptr);
+        m_WritePipe = std::exchange(other.m_WritePipe, nullptr);
+        m_ReadPipe = std::exchange(other.m_ReadPipe, nullptr);
+#else
+        m_ProcessID = std::exchange(other.m_ProcessID, -1);
+        m_WritePipe = std::exchange(other.m_WritePipe, -1);
+        m_ReadPipe = std::exchange(other.m_ReadPipe, -1);
+#endif
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace Orchestra
+{
+    //a process, which stdin and stdout are connected to pipes, its stderr goes to the console.
+    //WriteLine and ReadLine must be called from one thread at a time, but Terminate can be called from any thread to unblock ReadLine
+    class ChildProcess
+    {
+    public:
+        ChildProcess() = default;
+        //the command is launched through the shell on POSIX and directly on Windows
+        ChildProcess(const std::string_view& command);
+        ~ChildProcess();
+
+        ChildProcess(const ChildProcess&) = delete;
+        ChildProcess& operator=(const ChildProcess&) = delete;
+        ChildProcess(ChildProcess&& other) noexcept;
+        ChildProcess& operator=(ChildProcess&& other) noexcept;
+
+        bool WriteLine(const std::string_view& line);
+        //std::nullopt if the process closed its stdout(e.g. exited)
+        std::optional<std::string> ReadLine();
+
+        void Terminate();
+
+    public:
+        bool IsLaunched() const noexcept;
+
+    private:
+        void Close();
+
+        void MoveFrom(ChildProcess&& other) noexcept;
+
+    private:
+#ifdef WIN32
+        void* m_ProcessHandle = nullptr;
+        void* m_WritePipe = nullptr;
+        void* m_ReadPipe = nullptr;
+#else
+        int m_ProcessID = -1;
+        int m_WritePipe = -1;
+        int m_ReadPipe = -1;
+#endif
+        //what was read after the last returned line
+        std::string m_ReadBuffer;
+    };
+}
@@ -0,0 +1,214 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include <GuelderConsoleLog.hpp>
+
+//private
+namespace Orchestra
+{
+    namespace
+    {
+        constexpr size_t NO_QUEUE = std::numeric_limits<size_t>::max();
+
+        struct CurrentTaskContext
+        {
+            ThreadPool* pool = nullptr;
+            size_t queueIndex = NO_QUEUE;
+        };
+
+        thread_local CurrentTaskContext t_CurrentTaskContext;
+    }
+}
+namespace Orchestra
+{
+    const size_t ThreadPool::DEFAULT_THREADS_COUNT = std::max(std::thread::hardware_concurrency(), 2u);
+
+    ThreadPool::ThreadPool(size_t threadsCount)
+        : m_ThreadsCount(std::max<size_t>(threadsCount, 1)), m_NextQueueIndex(0), m_PendingTasksCount(0)
+    {
+        m_Queues.reserve(m_ThreadsCount);
+
+        for(size_t i = 0; i < m_ThreadsCount; i++)
+            m_Queues.push_back(std::make_unique<TasksQueue>());
+
+        m_Threads.reserve(m_ThreadsCount);
+
+        for(size_t i = 0; i < m_ThreadsCount; i++)
+            m_Threads.emplace_back([this, i](std::stop_token stopToken) { Work(i, stopToken); });
+    }
+    ThreadPool::~ThreadPool()
+    {
+        for(auto& thread : m_Threads)
+            thread.request_stop();
+
+        {
+            std::lock_guard lock{ m_WaitMutex };
+        }
+        m_TaskSubmittedCondition.notify_all();
+
+        //jthreads are joined here
+        m_Threads.clear();
+    }
+
+    void ThreadPool::Submit(Task task)
+    {
+        //a task submitted from a pool thread goes to its own queue, so it is likely to run on the warm thread
+        const size_t queueIndex = (t_CurrentTaskContext.pool == this && t_CurrentTaskContext.queueIndex != NO_QUEUE) ? t_CurrentTaskContext.queueIndex : m_NextQueueIndex++ % m_ThreadsCount;
+
+        {
+            std::lock_guard lock{ m_Queues[queueIndex]->mutex };
+
+            //before the task can be popped and the count decremented
+            m_PendingTasksCount++;
+            m_Queues[queueIndex]->tasks.push_back(std::move(task));
+        }
+
+        //a thread which has just seen no tasks is either waiting already or sees the new count
+        {
+            std::lock_guard lock{ m_WaitMutex };
+        }
+        m_TaskSubmittedCondition.notify_one();
+    }
+    void ThreadPool::Submit(uint64_t lane, Task task)
+    {
+        if(lane == NO_LANE)
+        {
+            Submit(std::move(task));
+            return;
+        }
+
+        {
+            std::lock_guard lock{ m_LanesMutex };
+
+            const auto [itLane, isNew] = m_Lanes.try_emplace(lane);
+
+            itLane->second.tasks.push_back(std::move(task));
+
+            //the running task of the lane will start this one when it finishes
+            if(!isNew)
+                return;
+        }
+
+        Submit([this, lane] { RunLaneTask(lane); });
+    }
+
+    void ThreadPool::Work(size_t queueIndex, std::stop_token stopToken)
+    {
+        t_CurrentTaskContext.pool = this;
+        t_CurrentTaskContext.queueIndex = queueIndex;
+
+        while(!stopToken.stop_requested())
+        {
+            Task task;
+
+            if(!TryPopTask(queueIndex, task))
+            {
+                std::unique_lock lock{ m_WaitMutex };
+
+                m_TaskSubmittedCondition.wait(lock, stopToken, [this] { return m_PendingTasksCount > 0; });
+
+                continue;
+            }
+
+            try
+            {
+                task();
+            }
+            catch(const std::exception& e)
+            {
+                GE_LOG(Orchestra, Error, "A task of the thread pool threw an exception: ", e.what());
+            }
+            catch(...)
+            {
+                GE_LOG(Orchestra, Error, "A task of the thread pool threw an unknown exception.");
+            }
+        }
+    }
+
+    bool ThreadPool::TryPopTask(size_t queueIndex, Task& task)
+    {
+        //own queue first, in the order of submission
+        {
+            TasksQueue& queue = *m_Queues[queueIndex];
+
+            std::lock_guard lock{ queue.mutex };
+
+            if(!queue.tasks.empty())
+            {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+                m_PendingTasksCount--;
+
+                return true;
+            }
+        }
+
+        //stealing from the back of the others
+        for(size_t i = 1; i < m_ThreadsCount; i++)
+        {
+            TasksQueue& queue = *m_Queues[(queueIndex + i) % m_ThreadsCount];
+
+            std::lock_guard lock{ queue.mutex };
+
+            if(!queue.tasks.empty())
+            {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+                m_PendingTasksCount--;
+
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void ThreadPool::RunLaneTask(uint64_t lane)
+    {
+        Task task;
+
+        {
+            std::lock_guard lock{ m_LanesMutex };
+            task = std::move(m_Lanes.at(lane).tasks.front());
+        }
+
+        try
+        {
+            task();
+        }
+        catch(...)
+        {
+            FinishLaneTask(lane);
+
+            throw;
+        }
+
+        FinishLaneTask(lane);
+    }
+    void ThreadPool::FinishLaneTask(uint64_t lane)
+    {
+        {
+            std::lock_guard lock{ m_LanesMutex };
+
+            const auto itLane = m_Lanes.find(lane);
+
+            itLane->second.tasks.pop_front();
+
+            if(itLane->second.tasks.empty())
+            {
+                m_Lanes.erase(itLane);
+                return;
+            }
+        }
+
+        Submit([this, lane] { RunLaneTask(lane); });
+    }
+}
+//getters, setters
+namespace Orchestra
+{
+    size_t ThreadPool::GetThreadsCount() const noexcept { return m_ThreadsCount; }
+    size_t ThreadPool::GetPendingTasksCount() const noexcept { return m_PendingTasksCount; }
+}
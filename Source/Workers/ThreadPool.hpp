@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Orchestra
+{
+    //a fixed number of threads, each of them has its own queue and steals from the others' when it is empty.
+    //tasks submitted to the same lane(e.g. a guild) run one at a time in the order of submission
+    class ThreadPool
+    {
+    public:
+        using Task = std::function<void()>;
+
+    public:
+        explicit ThreadPool(size_t threadsCount = DEFAULT_THREADS_COUNT);
+        //waits for running tasks, not started ones are dropped
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool(ThreadPool&&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+        ThreadPool& operator=(ThreadPool&&) = delete;
+
+        void Submit(Task task);
+        void Submit(uint64_t lane, Task task);
+
+    public:
+        size_t GetThreadsCount() const noexcept;
+        size_t GetPendingTasksCount() const noexcept;
+
+    public:
+        static constexpr uint64_t NO_LANE = std::numeric_limits<uint64_t>::max();
+        static const size_t DEFAULT_THREADS_COUNT;
+
+    private:
+        struct TasksQueue
+        {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+        struct Lane
+        {
+            std::deque<Task> tasks;
+        };
+
+    private:
+        void Work(size_t queueIndex, std::stop_token stopToken);
+
+        bool TryPopTask(size_t queueIndex, Task& task);
+
+        void RunLaneTask(uint64_t lane);
+        //starts the next task of the lane or removes the lane if it is empty
+        void FinishLaneTask(uint64_t lane);
+
+    private:
+        size_t m_ThreadsCount;
+
+        std::vector<std::unique_ptr<TasksQueue>> m_Queues;
+        std::atomic_size_t m_NextQueueIndex;
+
+        std::mutex m_WaitMutex;
+        std::condition_variable_any m_TaskSubmittedCondition;
+        //changed under the mutex of the queue with the task, so it never goes below the number of queued tasks
+        std::atomic_size_t m_PendingTasksCount;
+
+        std::mutex m_LanesMutex;
+        //a lane exists only while its task is running
+        std::unordered_map<uint64_t, Lane> m_Lanes;
+
+        std::vector<std::jthread> m_Threads;
+    };
+}
@@ -2,6 +2,9 @@
 
 #include <functional>
 #include <future>
+#include <memory>
+
+#include "ThreadPool.hpp"
 
 namespace Orchestra
 {
@@ -9,14 +12,14 @@ namespace Orchestra
     struct Worker
     {
     public:
-        Worker(size_t index, std::function<T()> work, std::function<void(const _Exception&)> customExceptionDeleter = []{}, std::function<void(const std::exception&)> exceptionDeleter = []{})
-            : m_Index(index), m_HasWorkBeenStarted(false),
-        m_Work(
+        Worker(size_t index, uint64_t lane, std::function<T()> work, std::function<void(const _Exception&)> customExceptionDeleter = []{}, std::function<void(const std::exception&)> exceptionDeleter = []{})
+            : m_Index(index), m_Lane(lane), m_HasWorkBeenStarted(false),
+        m_Work(std::make_shared<std::packaged_task<T()>>(
             [_work = std::move(work), _customExceptionDeleter = std::move(customExceptionDeleter), _exceptionDeleter = std::move(exceptionDeleter)]
             {
                 try
                 {
-                    _work();
+                    return _work();
                 }
                 catch(const _Exception& e)
                 {
@@ -37,24 +40,22 @@ namespace Orchestra
                     _exceptionDeleter(e);
                     throw e;
                 }
-            }) {}
+            })) {}
         Worker(Worker&&) noexcept = default;
         Worker& operator=(Worker&&) noexcept = default;
 
-        ~Worker()
-        {
-            if(m_Future.valid())
-                m_Future.wait_for(std::chrono::milliseconds(0));
-        }
-
-        void Work()
+        void Work(ThreadPool& threadPool)
         {
             m_HasWorkBeenStarted = true;
-            m_Future = std::async(std::launch::async, m_Work);
+            m_Future = m_Work->get_future();
+
+            //the task is shared, so the worker can be removed while its work is running
+            threadPool.Submit(m_Lane, [work = m_Work] { (*work)(); });
         }
 
         //INDEX IS UNIQUE BUT CAN BE SHARED
         size_t GetIndex() const noexcept { return m_Index; }
+        uint64_t GetLane() const noexcept { return m_Lane; }
         const std::future<T>& GetFuture() const { return m_Future; }
         T GetFutureResult() { return m_Future.get(); }
         //if true, the Worker is invalid and should be removed or moved
@@ -62,9 +63,11 @@ namespace Orchestra
 
     private:
         size_t m_Index;
+        //works of one lane run one after another
+        uint64_t m_Lane;
         bool m_HasWorkBeenStarted;
 
         std::future<T> m_Future;
-        std::function<T()> m_Work;
+        std::shared_ptr<std::packaged_task<T()>> m_Work;
     };
-}
\ No newline at end of file
+}
@@ -1,11 +1,12 @@
 #pragma once
 
 #include <functional>
-#include <vector>
+#include <unordered_map>
 
 #include <GuelderConsoleLog.hpp>
 
 #include "../Utils.hpp"
+#include "ThreadPool.hpp"
 #include "Worker.hpp"
 
 namespace Orchestra
@@ -16,34 +17,35 @@ namespace Orchestra
     public:
         using WorkerType = Worker<T, _Exception>;
     public:
-        explicit WorkersManager(size_t reserve = 0)
-            : m_WorkersCurrentIndex(0)
-        {
-            Reserve(reserve);
-        }
+        explicit WorkersManager(size_t threadsCount = ThreadPool::DEFAULT_THREADS_COUNT)
+            : m_WorkersCurrentIndex(0), m_ThreadPool(threadsCount) {}
 
         void Work()
         {
             std::lock_guard lock{ m_WorkersMutex };
-            std::ranges::for_each(m_Workers, [](WorkerType& w) { if(!w.HasWorkBeenStarted()) w.Work(); });
+            std::ranges::for_each(m_Workers, [this](auto& pair) { if(!pair.second.HasWorkBeenStarted()) pair.second.Work(m_ThreadPool); });
         }
         void Work(size_t index)
         {
             std::lock_guard lock{ m_WorkersMutex };
-            const auto found = std::ranges::find_if(m_Workers, [&index](const WorkerType& worker) { return worker.GetIndex() == index; });
+            const auto found = m_Workers.find(index);
 
             if(found != m_Workers.end())
-                found->Work();
+                found->second.Work(m_ThreadPool);
         }
 
-        //returns worker's id
-        size_t AddWorker(std::function<T()> func, std::function<void(const _Exception&)> exceptionDeleter = [] {}, bool remove = false)
+        //returns worker's id. Workers with the same lane(e.g. a guild id) run one after another, ThreadPool::NO_LANE means no ordering
+        size_t AddWorker(std::function<T()> func, std::function<void(const _Exception&)> exceptionDeleter = [] {}, bool remove = false, uint64_t lane = ThreadPool::NO_LANE)
         {
             std::lock_guard lock{ m_WorkersMutex };
 
-            m_Workers.emplace_back(
-                m_WorkersCurrentIndex,
-                [this, _func = std::move(func), index = m_WorkersCurrentIndex.load(), remove]
+            const size_t index = m_WorkersCurrentIndex;
+
+            m_Workers.try_emplace(
+                index,
+                index,
+                lane,
+                [this, _func = std::move(func), index, remove]
                 {
                     GE_LOG(Orchestra, Info, "Adding worker with index ", index, '.');
                     if constexpr(std::is_same_v<T, void>)
@@ -51,44 +53,40 @@ namespace Orchestra
                         _func();
 
                         if(remove)
-                            RemoveWorkerAsync(index);
+                            RemoveFinishedWorker(index);
                     }
                     else
                     {
                         auto result = _func();
 
                         if(remove)
-                            RemoveWorkerAsync(index);
+                            RemoveFinishedWorker(index);
 
                         return result;
                     }
                 },
-                [this, index = m_WorkersCurrentIndex.load(), remove, _exceptionDeleter = std::move(exceptionDeleter)](const _Exception& e)
+                [this, index, remove, _exceptionDeleter = std::move(exceptionDeleter)](const _Exception& e)
                 {
                     _exceptionDeleter(e);
 
                     if(remove)
-                        RemoveWorkerAsync(index, e);
+                        RemoveFinishedWorker(index, e);
                 },
-                [this, index = m_WorkersCurrentIndex.load(), remove](const std::exception& e)
+                [this, index, remove](const std::exception& e)
                 {
                     if(remove)
-                        RemoveWorkerAsync(index, e);
+                        RemoveFinishedWorker(index, e);
                 }
             );
             ++m_WorkersCurrentIndex;
 
-            return m_WorkersCurrentIndex - 1;
+            return index;
         }
         void RemoveWorker(size_t index)
         {
             std::lock_guard lock{ m_WorkersMutex };
 
-            const auto found = std::ranges::find_if(m_Workers, [&index](const WorkerType& worker) { return worker.GetIndex() == index; });
-
-            if(found != m_Workers.end())
-                m_Workers.erase(found);
-            else
+            if(!m_Workers.erase(index))
                 O_THROW("Failed to find worker with index ", index, '.');
 
             GE_LOG(Orchestra, Info, "Deleted worker with index ", index, ". m_Workers.size() = ", m_Workers.size());
@@ -105,13 +103,14 @@ namespace Orchestra
         {
             std::lock_guard lock{ m_WorkersMutex };
 
-            auto found = std::ranges::find_if(m_Workers, [&index](const WorkerType& worker) { return worker.GetIndex() == index; });
+            const auto found = m_Workers.find(index);
 
-            if(found != m_Workers.end())
-                return *found;
+            O_ASSERT(found != m_Workers.end(), "Failed to find worker with index ", index, '.');
+
+            return found->second;
         }
         //WARNING: it doesn't return the result instantly
-        const std::vector<WorkerType>& GetWorkers() const noexcept
+        const std::unordered_map<size_t, WorkerType>& GetWorkers() const noexcept
         {
             std::lock_guard lock{ m_WorkersMutex };
             return m_Workers;
@@ -125,42 +124,40 @@ namespace Orchestra
         {
             std::lock_guard lock{ m_WorkersMutex };
 
-            auto found = std::ranges::find_if(m_Workers, [&index](const WorkerType& worker) { return worker.GetIndex() == index; });
+            const auto found = m_Workers.find(index);
 
             if(found != m_Workers.end())
-                return found->GetFutureResult();
+                return found->second.GetFutureResult();
             else
                 O_THROW("Failed to find worker with index ", index, '.');
         }
 
+        const ThreadPool& GetThreadPool() const noexcept { return m_ThreadPool; }
+
     private:
+        //it is called from the work itself, which is kept alive by the thread pool until it returns
         template<GuelderConsoleLog::Concepts::IsException _ExceptionType = _Exception>
             requires requires (_ExceptionType e)
         {
             e.what();
         }
-        void RemoveWorkerAsync(size_t index, _ExceptionType exception)
+        void RemoveFinishedWorker(size_t index, const _ExceptionType& exception)
         {
-            std::thread removeThread([this, index, _exception = std::move(exception)]
-                {
-                    RemoveWorker(index);
-                    GE_LOG(Orchestra, Error, "Deleted worker with index ", index, " because an ", typeid(_ExceptionType).name(), " occured: ", _exception.what());
-                });
-            removeThread.detach();
+            RemoveWorker(index);
+            GE_LOG(Orchestra, Error, "Deleted worker with index ", index, " because an ", typeid(_ExceptionType).name(), " occured: ", exception.what());
         }
-        void RemoveWorkerAsync(size_t index)
+        void RemoveFinishedWorker(size_t index)
         {
-            std::thread removeThread([this, index]
-                {
-                    RemoveWorker(index);
-                    GE_LOG(Orchestra, Info, "Deleting worker with index ", index, '.');
-                });
-            removeThread.detach();
+            RemoveWorker(index);
+            GE_LOG(Orchestra, Info, "Deleting worker with index ", index, '.');
         }
 
     private:
         std::atomic<size_t> m_WorkersCurrentIndex;
-        std::vector<WorkerType> m_Workers;
+        std::unordered_map<size_t, WorkerType> m_Workers;
         mutable std::mutex m_WorkersMutex;
+
+        //declared last, so running works, which remove themselves, are finished before the workers are destroyed
+        ThreadPool m_ThreadPool;
     };
-}
\ No newline at end of file
+}
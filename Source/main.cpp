@@ -1,9 +1,18 @@
-﻿#include <dpp/dpp.h>
+﻿#include <optional>
+
+#include <dpp/dpp.h>
 #include <GuelderConsoleLog.hpp>
 #include <GuelderResourcesManager.hpp>
 
 //#include "Utils.hpp"
 #include "DiscordBot/OrchestraDiscordBot.hpp"
+#include "DiscordBot/RawURLCache.hpp"
+#include "DiscordBot/AudioCache.hpp"
+#include "DiscordBot/Yt_DlpWorkerPool.hpp"
+#include "FFmpeg/SharedSource.hpp"
+#include "Diagnostics/PlaybackTracer.hpp"
+#include "Diagnostics/Metrics.hpp"
+#include "Diagnostics/MetricsServer.hpp"
 
 #define NOMINMAX
 
@@ -14,6 +23,34 @@
 using namespace GuelderConsoleLog;
 using namespace Orchestra;
 
+void AddCachesMetricsCollector()
+{
+    Metrics::AddCollector([]
+        {
+            static Metrics::Gauge& audioCacheHitRate = Metrics::GetGauge("orchestra_audio_cache_hit_ratio", "Hits of the on-disk audio cache per lookup.");
+            static Metrics::Gauge& audioCacheSize = Metrics::GetGauge("orchestra_audio_cache_bytes", "The size of the files in the on-disk audio cache.");
+            static Metrics::Gauge& sharedSourceHitRate = Metrics::GetGauge("orchestra_shared_source_hit_ratio", "Acquires of a shared source which is already downloading or downloaded.");
+            static Metrics::Gauge& sharedSourceSavedSize = Metrics::GetGauge("orchestra_shared_source_saved_bytes", "The bytes which the hits of shared sources didn't have to download.");
+            static Metrics::Gauge& rawURLCacheHitRate = Metrics::GetGauge("orchestra_raw_url_cache_hit_ratio", "Hits of the raw url cache per lookup.");
+            static Metrics::Gauge& yt_dlpQueuedRequests = Metrics::GetGauge("orchestra_yt_dlp_queued_requests", "The requests which wait for a free yt-dlp worker.");
+
+            const auto audioCacheStats = AudioCache::GetStats();
+            audioCacheHitRate.SetValue(audioCacheStats.GetHitRate());
+            audioCacheSize.SetValue(static_cast<double>(audioCacheStats.size));
+
+            const auto sharedSourceStats = SharedSource::GetStats();
+            const uint64_t sharedSourceLookups = sharedSourceStats.hits + sharedSourceStats.misses;
+            sharedSourceHitRate.SetValue(sharedSourceLookups ? static_cast<double>(sharedSourceStats.hits) / static_cast<double>(sharedSourceLookups) : 0.);
+            sharedSourceSavedSize.SetValue(static_cast<double>(sharedSourceStats.savedBytes));
+
+            const auto rawURLCacheStats = RawURLCache::GetStats();
+            const uint64_t rawURLCacheLookups = rawURLCacheStats.hits + rawURLCacheStats.misses;
+            rawURLCacheHitRate.SetValue(rawURLCacheLookups ? static_cast<double>(rawURLCacheStats.hits) / static_cast<double>(rawURLCacheLookups) : 0.);
+
+            yt_dlpQueuedRequests.SetValue(static_cast<double>(Yt_DlpWorkerPool::GetQueuedRequestsCount()));
+        });
+}
+
 void BotLogger(const dpp::log_t& log)
 {
     switch(log.severity)
@@ -77,12 +114,71 @@ int main(int argc, char** argv)
             if(!value.empty())
                 historyLogPath = path / resourcesPath / value;
         } catch(...) {}
+        try
+        {
+            auto value = mainConfig.GetVariable("localPathToRawURLCache").GetValue<std::string>();
+
+            if(!value.empty())
+                RawURLCache::Load(path / resourcesPath / value);
+        } catch(const OrchestraException& e)
+        {
+            LogWarning("Failed to load the raw url cache: ", e.GetFullMessage());
+        } catch(...) {}
+        try
+        {
+            SharedSource::SetMaxSize(mainConfig.GetVariable("sharedSourceMaxSize").GetValue<uint32_t>());
+        } catch(...) {}
+        try
+        {
+            auto value = mainConfig.GetVariable("localPathToAudioCache").GetValue<std::string>();
+            const auto maxSize = mainConfig.GetVariable("audioCacheMaxSize").GetValue<unsigned long long>();
+
+            if(!value.empty() && maxSize > 0)
+                AudioCache::Load(path / resourcesPath / value, maxSize);
+        } catch(const OrchestraException& e)
+        {
+            LogWarning("Failed to load the audio cache: ", e.GetFullMessage());
+        } catch(...) {}
+        try
+        {
+            auto value = mainConfig.GetVariable("localPathToPlaybackTraces").GetValue<std::string>();
+
+            if(!value.empty())
+                PlaybackTracer::SetFilePath(path / resourcesPath / value);
+        } catch(...) {}
+        try
+        {
+            const auto workersCount = mainConfig.GetVariable("yt_dlpWorkersCount").GetValue<unsigned int>();
+            const auto interpreter = mainConfig.GetVariable("yt_dlpWorkerInterpreter").GetValue<std::string>();
+            const std::filesystem::path scriptPath = path / resourcesPath / mainConfig.GetVariable("localPathToYt_dlpWorkerScript").GetValue<std::string>();
+
+            if(workersCount > 0 && !interpreter.empty())
+                Yt_DlpWorkerPool::Launch(Logger::Format(interpreter, " \"", scriptPath.string(), '\"'), workersCount);
+        } catch(...) {}
+
+        std::optional<MetricsServer> metricsServer;
+
+        try
+        {
+            const auto metricsPort = mainConfig.GetVariable("metricsPort").GetValue<unsigned int>();
+
+            if(metricsPort > 0)
+            {
+                AddCachesMetricsCollector();
+                metricsServer.emplace(static_cast<uint16_t>(metricsPort));
+            }
+        } catch(const OrchestraException& e)
+        {
+            LogWarning("Failed to start the metrics server: ", e.GetFullMessage());
+        } catch(...) {}
 
         auto botToken = mainConfig.GetVariable("botToken").GetValue<std::string>();
 
         unsigned long long bossSnowflake = 0;
-        unsigned int sentPacketsSize = 20000;
+        unsigned int sentPacketsSize = 11520;
+        unsigned int decodeAheadBufferSize = 2000000;
         bool enableLogSentPackets = false;
+        bool useNativeEqualizer = false;
         std::string commandsPrefix;
         char paramsPrefix = '-';
         uint32_t maxDownloadFileSize = 0;
@@ -93,10 +189,18 @@ int main(int argc, char** argv)
             sentPacketsSize = mainConfig.GetVariable("sentPacketsSize").GetValue<unsigned int>();
         } catch(...) {}
         try
+        {
+            decodeAheadBufferSize = mainConfig.GetVariable("decodeAheadBufferSize").GetValue<unsigned int>();
+        } catch(...) {}
+        try
         {
             enableLogSentPackets = mainConfig.GetVariable("enableLoggingSentPackets").GetValue<bool>();
         } catch(...) {}
         try
+        {
+            useNativeEqualizer = mainConfig.GetVariable("useNativeEqualizer").GetValue<bool>();
+        } catch(...) {}
+        try
         {
             commandsPrefix = mainConfig.GetVariable("commandsPrefix").GetValue<std::string>();
         }
@@ -142,7 +246,9 @@ int main(int argc, char** argv)
             FullOrchestraDiscordBotInstanceProperties
             {
                 sentPacketsSize,
+                decodeAheadBufferSize,
                 enableLogSentPackets,
+                useNativeEqualizer,
 
                 OrchestraDiscordBotInstanceProperties
                 {